@@ -0,0 +1,529 @@
+#include "hpack.h"
+
+#include <algorithm>
+#include <array>
+
+using namespace Net;
+
+struct StaticEntry {
+    std::string_view name;
+    std::string_view value;
+};
+
+static constexpr StaticEntry STATIC_TABLE[HpackTable::STATIC_SIZE] = {
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""},
+};
+
+struct HuffmanCode {
+    uint32_t code;
+    uint8_t length;
+};
+
+// RFC 7541, Appendix B. `EOS` (256) is `0x3fffffff` of length 30.
+static constexpr HuffmanCode HUFFMAN_CODES[256] = {
+    {0x1ff8, 13}, {0x7fffd8, 23}, {0xfffffe2, 28}, {0xfffffe3, 28},
+    {0xfffffe4, 28}, {0xfffffe5, 28}, {0xfffffe6, 28}, {0xfffffe7, 28},
+    {0xfffffe8, 28}, {0xffffea, 24}, {0x3ffffffc, 30}, {0xfffffe9, 28},
+    {0xfffffea, 28}, {0x3ffffffd, 30}, {0xfffffeb, 28}, {0xfffffec, 28},
+    {0xfffffed, 28}, {0xfffffee, 28}, {0xfffffef, 28}, {0xffffff0, 28},
+    {0xffffff1, 28}, {0xffffff2, 28}, {0x3ffffffe, 30}, {0xffffff3, 28},
+    {0xffffff4, 28}, {0xffffff5, 28}, {0xffffff6, 28}, {0xffffff7, 28},
+    {0xffffff8, 28}, {0xffffff9, 28}, {0xffffffa, 28}, {0xffffffb, 28},
+    {0x14, 6}, {0x3f8, 10}, {0x3f9, 10}, {0xffa, 12},
+    {0x1ff9, 13}, {0x15, 6}, {0xf8, 8}, {0x7fa, 11},
+    {0x3fa, 10}, {0x3fb, 10}, {0xf9, 8}, {0x7fb, 11},
+    {0xfa, 8}, {0x16, 6}, {0x17, 6}, {0x18, 6},
+    {0x0, 5}, {0x1, 5}, {0x2, 5}, {0x19, 6},
+    {0x1a, 6}, {0x1b, 6}, {0x1c, 6}, {0x1d, 6},
+    {0x1e, 6}, {0x1f, 6}, {0x5c, 7}, {0xfb, 8},
+    {0x7ffc, 15}, {0x20, 6}, {0xffb, 12}, {0x3fc, 10},
+    {0x1ffa, 13}, {0x21, 6}, {0x5d, 7}, {0x5e, 7},
+    {0x5f, 7}, {0x60, 7}, {0x61, 7}, {0x62, 7},
+    {0x63, 7}, {0x64, 7}, {0x65, 7}, {0x66, 7},
+    {0x67, 7}, {0x68, 7}, {0x69, 7}, {0x6a, 7},
+    {0x6b, 7}, {0x6c, 7}, {0x6d, 7}, {0x6e, 7},
+    {0x6f, 7}, {0x70, 7}, {0x71, 7}, {0x72, 7},
+    {0xfc, 8}, {0x73, 7}, {0xfd, 8}, {0x1ffb, 13},
+    {0x7fff0, 19}, {0x1ffc, 13}, {0x3ffc, 14}, {0x22, 6},
+    {0x7ffd, 15}, {0x3, 5}, {0x23, 6}, {0x4, 5},
+    {0x24, 6}, {0x5, 5}, {0x25, 6}, {0x26, 6},
+    {0x27, 6}, {0x6, 5}, {0x74, 7}, {0x75, 7},
+    {0x28, 6}, {0x29, 6}, {0x2a, 6}, {0x7, 5},
+    {0x2b, 6}, {0x76, 7}, {0x2c, 6}, {0x8, 5},
+    {0x9, 5}, {0x2d, 6}, {0x77, 7}, {0x78, 7},
+    {0x79, 7}, {0x7a, 7}, {0x7b, 7}, {0x7ffe, 15},
+    {0x7fc, 11}, {0x3ffd, 14}, {0x1ffd, 13}, {0xffffffc, 28},
+    {0xfffe6, 20}, {0x3fffd2, 22}, {0xfffe7, 20}, {0xfffe8, 20},
+    {0x3fffd3, 22}, {0x3fffd4, 22}, {0x3fffd5, 22}, {0x7fffd9, 23},
+    {0x3fffd6, 22}, {0x7fffda, 23}, {0x7fffdb, 23}, {0x7fffdc, 23},
+    {0x7fffdd, 23}, {0x7fffde, 23}, {0xffffeb, 24}, {0x7fffdf, 23},
+    {0xffffec, 24}, {0xffffed, 24}, {0x3fffd7, 22}, {0x7fffe0, 23},
+    {0xffffee, 24}, {0x7fffe1, 23}, {0x7fffe2, 23}, {0x7fffe3, 23},
+    {0x7fffe4, 23}, {0x1fffdc, 21}, {0x3fffd8, 22}, {0x7fffe5, 23},
+    {0x3fffd9, 22}, {0x7fffe6, 23}, {0x7fffe7, 23}, {0xffffef, 24},
+    {0x3fffda, 22}, {0x1fffdd, 21}, {0xfffe9, 20}, {0x3fffdb, 22},
+    {0x3fffdc, 22}, {0x7fffe8, 23}, {0x7fffe9, 23}, {0x1fffde, 21},
+    {0x7fffea, 23}, {0x3fffdd, 22}, {0x3fffde, 22}, {0xfffff0, 24},
+    {0x1fffdf, 21}, {0x3fffdf, 22}, {0x7fffeb, 23}, {0x7fffec, 23},
+    {0x1fffe0, 21}, {0x1fffe1, 21}, {0x3fffe0, 22}, {0x1fffe2, 21},
+    {0x7fffed, 23}, {0x3fffe1, 22}, {0x7fffee, 23}, {0x7fffef, 23},
+    {0xfffea, 20}, {0x3fffe2, 22}, {0x3fffe3, 22}, {0x3fffe4, 22},
+    {0x7ffff0, 23}, {0x3fffe5, 22}, {0x3fffe6, 22}, {0x7ffff1, 23},
+    {0x3ffffe0, 26}, {0x3ffffe1, 26}, {0xfffeb, 20}, {0x7fff1, 19},
+    {0x3fffe7, 22}, {0x7ffff2, 23}, {0x3fffe8, 22}, {0x1ffffec, 25},
+    {0x3ffffe2, 26}, {0x3ffffe3, 26}, {0x3ffffe4, 26}, {0x7ffffde, 27},
+    {0x7ffffdf, 27}, {0x3ffffe5, 26}, {0xfffff1, 24}, {0x1ffffed, 25},
+    {0x7fff2, 19}, {0x1fffe3, 21}, {0x3ffffe6, 26}, {0x7ffffe0, 27},
+    {0x7ffffe1, 27}, {0x3ffffe7, 26}, {0x7ffffe2, 27}, {0xfffff2, 24},
+    {0x1fffe4, 21}, {0x1fffe5, 21}, {0x3ffffe8, 26}, {0x3ffffe9, 26},
+    {0xffffffd, 28}, {0x7ffffe3, 27}, {0x7ffffe4, 27}, {0x7ffffe5, 27},
+    {0xfffec, 20}, {0xfffff3, 24}, {0xfffed, 20}, {0x1fffe6, 21},
+    {0x3fffe9, 22}, {0x1fffe7, 21}, {0x1fffe8, 21}, {0x7ffff3, 23},
+    {0x3fffea, 22}, {0x3fffeb, 22}, {0x1ffffee, 25}, {0x1ffffef, 25},
+    {0xfffff4, 24}, {0xfffff5, 24}, {0x3ffffea, 26}, {0x7ffff4, 23},
+    {0x3ffffeb, 26}, {0x7ffffe6, 27}, {0x3ffffec, 26}, {0x3ffffed, 26},
+    {0x7ffffe7, 27}, {0x7ffffe8, 27}, {0x7ffffe9, 27}, {0x7ffffea, 27},
+    {0x7ffffeb, 27}, {0xffffffe, 28}, {0x7ffffec, 27}, {0x7ffffed, 27},
+    {0x7ffffee, 27}, {0x7ffffef, 27}, {0x7fffff0, 27}, {0x3ffffee, 26},
+};
+
+static constexpr uint8_t HUFFMAN_MIN_LENGTH = 5;
+static constexpr uint8_t HUFFMAN_MAX_LENGTH = 30;
+static constexpr uint16_t HUFFMAN_EOS = 256;
+
+/// Canonical Huffman code decoding tables: codes of the same length are consecutive,
+/// so symbol is found by the distance from the first code of that length.
+struct HuffmanDecodeTable {
+    uint32_t firstCode[HUFFMAN_MAX_LENGTH + 1] = {};
+    uint16_t count[HUFFMAN_MAX_LENGTH + 1] = {};
+    uint16_t offset[HUFFMAN_MAX_LENGTH + 1] = {};
+    std::array<uint16_t, 257> symbols = {};
+
+    HuffmanDecodeTable() {
+        std::array<uint16_t, 257> sorted;
+        for (uint16_t i = 0; i < sorted.size(); ++i) sorted[i] = i;
+
+        const auto getCode = [](const uint16_t symbol) -> HuffmanCode {
+            return (symbol == HUFFMAN_EOS) ? HuffmanCode{0x3fffffff, 30} : HUFFMAN_CODES[symbol];
+        };
+
+        std::sort(sorted.begin(), sorted.end(), [&getCode](const uint16_t left, const uint16_t right) {
+            const HuffmanCode l = getCode(left);
+            const HuffmanCode r = getCode(right);
+            return (l.length != r.length) ? l.length < r.length : l.code < r.code;
+        });
+
+        for (uint16_t i = 0; i < sorted.size(); ++i) {
+            const HuffmanCode code = getCode(sorted[i]);
+            if (count[code.length] == 0) {
+                firstCode[code.length] = code.code;
+                offset[code.length] = i;
+            }
+
+            ++count[code.length];
+            symbols[i] = sorted[i];
+        }
+    }
+};
+
+static const HuffmanDecodeTable& GetHuffmanDecodeTable() {
+    static const HuffmanDecodeTable table;
+    return table;
+}
+
+void HpackTable::Evict(const size_t requiredSize) {
+    while (!entries.empty() && size + requiredSize > maxSize) {
+        const HeaderField& oldest = entries.back();
+        size -= oldest.name.size() + oldest.value.size() + ENTRY_OVERHEAD;
+        entries.pop_back();
+    }
+}
+
+bool HpackTable::Get(const size_t index, std::string_view& outName, std::string_view& outValue) const {
+    if (index == 0) [[unlikely]] {
+        return false;
+    }
+    if (index <= STATIC_SIZE) {
+        outName = STATIC_TABLE[index - 1].name;
+        outValue = STATIC_TABLE[index - 1].value;
+        return true;
+    }
+
+    const size_t dynamicIndex = index - STATIC_SIZE - 1;
+    if (dynamicIndex >= entries.size()) [[unlikely]] {
+        return false;
+    }
+
+    outName = entries[dynamicIndex].name;
+    outValue = entries[dynamicIndex].value;
+    return true;
+}
+
+size_t HpackTable::Find(const std::string_view name, const std::string_view value, size_t& outNameIndex) const {
+    outNameIndex = 0;
+
+    for (size_t i = 0; i < STATIC_SIZE; ++i) {
+        if (STATIC_TABLE[i].name != name) continue;
+        if (STATIC_TABLE[i].value == value) return i + 1;
+        if (outNameIndex == 0) outNameIndex = i + 1;
+    }
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].name != name) continue;
+        if (entries[i].value == value) return STATIC_SIZE + i + 1;
+        if (outNameIndex == 0) outNameIndex = STATIC_SIZE + i + 1;
+    }
+
+    return 0;
+}
+
+void HpackTable::Add(const std::string_view name, const std::string_view value) {
+    const size_t entrySize = name.size() + value.size() + ENTRY_OVERHEAD;
+
+    Evict(entrySize);
+    // Entry larger than the whole table just empties it.
+    if (entrySize > maxSize) {
+        return;
+    }
+
+    entries.push_front({std::string(name), std::string(value)});
+    size += entrySize;
+}
+
+void HpackTable::SetMaxSize(const size_t newMaxSize) {
+    maxSize = newMaxSize;
+    Evict(0);
+}
+
+void Hpack::EncodeInteger(std::string& out, const uint8_t firstByte, const uint8_t prefixBits, uint64_t value) {
+    const uint64_t prefixMax = (1u << prefixBits) - 1;
+    if (value < prefixMax) {
+        out.push_back(static_cast<char>(firstByte | value));
+        return;
+    }
+
+    out.push_back(static_cast<char>(firstByte | prefixMax));
+    value -= prefixMax;
+
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+size_t Hpack::DecodeInteger(const uint8_t* data, const size_t size, const uint8_t prefixBits, uint64_t& outValue) {
+    if (size == 0) [[unlikely]] {
+        return 0;
+    }
+
+    const uint64_t prefixMax = (1u << prefixBits) - 1;
+    outValue = data[0] & prefixMax;
+    if (outValue < prefixMax) {
+        return 1;
+    }
+
+    uint8_t shift = 0;
+    for (size_t i = 1; i < size; ++i) {
+        // Values above 2^56 are never legitimate here.
+        if (shift > 56) [[unlikely]] {
+            return 0;
+        }
+
+        outValue += static_cast<uint64_t>(data[i] & 0x7f) << shift;
+        shift += 7;
+
+        if ((data[i] & 0x80) == 0) {
+            return i + 1;
+        }
+    }
+
+    return 0;
+}
+
+size_t Hpack::GetHuffmanSize(const std::string_view string) {
+    size_t bits = 0;
+    for (const char ch : string) {
+        bits += HUFFMAN_CODES[static_cast<uint8_t>(ch)].length;
+    }
+
+    return (bits + 7) / 8;
+}
+
+void Hpack::HuffmanEncode(std::string& out, const std::string_view string) {
+    uint64_t bits = 0;
+    uint8_t bitCount = 0;
+
+    for (const char ch : string) {
+        const HuffmanCode& code = HUFFMAN_CODES[static_cast<uint8_t>(ch)];
+        bits = (bits << code.length) | code.code;
+        bitCount += code.length;
+
+        while (bitCount >= 8) {
+            bitCount -= 8;
+            out.push_back(static_cast<char>(bits >> bitCount));
+        }
+    }
+
+    // Pad with the most significant bits of `EOS`.
+    if (bitCount > 0) {
+        out.push_back(static_cast<char>((bits << (8 - bitCount)) | (0xff >> bitCount)));
+    }
+}
+
+bool Hpack::HuffmanDecode(const uint8_t* data, const size_t size, std::string& outString) {
+    const HuffmanDecodeTable& table = GetHuffmanDecodeTable();
+
+    uint64_t bits = 0;
+    uint8_t bitCount = 0;
+
+    for (size_t i = 0; i < size; ++i) {
+        bits = (bits << 8) | data[i];
+        bitCount += 8;
+
+        while (bitCount >= HUFFMAN_MIN_LENGTH) {
+            bool isFound = false;
+
+            for (uint8_t length = HUFFMAN_MIN_LENGTH; length <= std::min(bitCount, HUFFMAN_MAX_LENGTH); ++length) {
+                const uint32_t code = static_cast<uint32_t>(bits >> (bitCount - length)) & ((1u << length) - 1);
+                if (table.count[length] == 0 || code < table.firstCode[length] ||
+                    code - table.firstCode[length] >= table.count[length]) {
+                    continue;
+                }
+
+                const uint16_t symbol = table.symbols[table.offset[length] + code - table.firstCode[length]];
+                if (symbol == HUFFMAN_EOS) [[unlikely]] {
+                    return false;
+                }
+
+                outString.push_back(static_cast<char>(symbol));
+                bitCount -= length;
+                bits &= (1ull << bitCount) - 1;
+                isFound = true;
+                break;
+            }
+
+            if (isFound == false) {
+                if (bitCount >= HUFFMAN_MAX_LENGTH) [[unlikely]] {
+                    return false;
+                }
+                break;
+            }
+        }
+    }
+
+    // Only up to 7 bits of `EOS` prefix (all ones) are allowed as padding.
+    return bitCount <= 7 && bits == (1ull << bitCount) - 1;
+}
+
+void Hpack::EncodeString(std::string& out, const std::string_view string) {
+    const size_t huffmanSize = GetHuffmanSize(string);
+    if (huffmanSize < string.size()) {
+        EncodeInteger(out, 0x80, 7, huffmanSize);
+        HuffmanEncode(out, string);
+    } else {
+        EncodeInteger(out, 0x00, 7, string.size());
+        out.append(string);
+    }
+}
+
+size_t Hpack::DecodeString(const uint8_t* data, const size_t size, std::string& outString) {
+    uint64_t length;
+    const size_t lengthSize = DecodeInteger(data, size, 7, length);
+    if (lengthSize == 0 || length > size - lengthSize) [[unlikely]] {
+        return 0;
+    }
+
+    outString.clear();
+    if (data[0] & 0x80) {
+        if (HuffmanDecode(data + lengthSize, length, outString) == false) [[unlikely]] {
+            return 0;
+        }
+    } else {
+        outString.assign(reinterpret_cast<const char*>(data + lengthSize), length);
+    }
+
+    return lengthSize + length;
+}
+
+// Values of these headers shouldn't be kept in tables, see RFC 7541 section 7.1.3.
+static bool IsSensitiveHeader(const std::string_view name) {
+    return name == "authorization" || name == "proxy-authorization" || name == "cookie" || name == "set-cookie";
+}
+
+void HpackEncoder::Encode(const std::vector<HeaderField>& headers, std::string& out) {
+    if (isSizeUpdatePending) {
+        Hpack::EncodeInteger(out, 0x20, 5, table.GetMaxSize());
+        isSizeUpdatePending = false;
+    }
+
+    for (const HeaderField& header : headers) {
+        size_t nameIndex;
+        const size_t index = table.Find(header.name, header.value, nameIndex);
+
+        if (index != 0) {
+            Hpack::EncodeInteger(out, 0x80, 7, index);
+            continue;
+        }
+
+        const bool isSensitive = IsSensitiveHeader(header.name);
+        if (isSensitive) {
+            // Literal never indexed.
+            Hpack::EncodeInteger(out, 0x10, 4, nameIndex);
+        } else {
+            // Literal with incremental indexing.
+            Hpack::EncodeInteger(out, 0x40, 6, nameIndex);
+        }
+
+        if (nameIndex == 0) {
+            Hpack::EncodeString(out, header.name);
+        }
+        Hpack::EncodeString(out, header.value);
+
+        if (isSensitive == false) {
+            table.Add(header.name, header.value);
+        }
+    }
+}
+
+void HpackEncoder::SetMaxTableSize(const size_t maxSize) {
+    const size_t newSize = std::min(maxSize, HpackTable::DEFAULT_MAX_SIZE);
+    if (newSize == table.GetMaxSize()) return;
+
+    table.SetMaxSize(newSize);
+    isSizeUpdatePending = true;
+}
+
+bool HpackDecoder::Decode(const uint8_t* data, const size_t size, std::vector<HeaderField>& outHeaders) {
+    size_t offset = 0;
+    while (offset < size) {
+        const uint8_t first = data[offset];
+        uint64_t index;
+
+        if (first & 0x80) {
+            // Indexed header field.
+            const size_t consumed = Hpack::DecodeInteger(data + offset, size - offset, 7, index);
+            std::string_view name, value;
+            if (consumed == 0 || table.Get(index, name, value) == false) [[unlikely]] {
+                return false;
+            }
+
+            outHeaders.push_back({std::string(name), std::string(value)});
+            offset += consumed;
+            continue;
+        }
+
+        if ((first & 0xe0) == 0x20) {
+            // Dynamic table size update.
+            const size_t consumed = Hpack::DecodeInteger(data + offset, size - offset, 5, index);
+            if (consumed == 0 || index > maxAllowedSize) [[unlikely]] {
+                return false;
+            }
+
+            table.SetMaxSize(index);
+            offset += consumed;
+            continue;
+        }
+
+        // Literal: with incremental indexing (6 bit prefix), without or never indexed (4 bit prefix).
+        const bool isIndexing = (first & 0xc0) == 0x40;
+        const size_t consumed = Hpack::DecodeInteger(data + offset, size - offset, isIndexing ? 6 : 4, index);
+        if (consumed == 0) [[unlikely]] {
+            return false;
+        }
+        offset += consumed;
+
+        HeaderField& field = outHeaders.emplace_back();
+        if (index != 0) {
+            std::string_view name, value;
+            if (table.Get(index, name, value) == false) [[unlikely]] {
+                return false;
+            }
+            field.name.assign(name);
+        } else {
+            const size_t nameSize = Hpack::DecodeString(data + offset, size - offset, field.name);
+            if (nameSize == 0) [[unlikely]] {
+                return false;
+            }
+            offset += nameSize;
+        }
+
+        const size_t valueSize = Hpack::DecodeString(data + offset, size - offset, field.value);
+        if (valueSize == 0) [[unlikely]] {
+            return false;
+        }
+        offset += valueSize;
+
+        if (isIndexing) {
+            table.Add(field.name, field.value);
+        }
+    }
+
+    return true;
+}
+
+void HpackDecoder::SetMaxTableSize(const size_t maxSize) {
+    maxAllowedSize = maxSize;
+    if (table.GetMaxSize() > maxSize) {
+        table.SetMaxSize(maxSize);
+    }
+}
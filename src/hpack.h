@@ -0,0 +1,95 @@
+#ifndef _HPACK_H
+#define _HPACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Net {
+    /// Single header of HTTP/2 header block, names are always lowercase.
+    struct HeaderField {
+        std::string name;
+        std::string value;
+    };
+
+    /// HPACK (RFC 7541) header table: static table followed by the dynamic one.
+    class HpackTable {
+    public:
+        static constexpr size_t STATIC_SIZE = 61;
+        static constexpr size_t DEFAULT_MAX_SIZE = 4096;
+        // Per-entry overhead defined by the RFC.
+        static constexpr size_t ENTRY_OVERHEAD = 32;
+
+    private:
+        std::deque<HeaderField> entries;
+        size_t size = 0;
+        size_t maxSize = DEFAULT_MAX_SIZE;
+
+        void Evict(const size_t requiredSize);
+
+    public:
+        /// Gets entry by 1-based HPACK index, returns `false` if the index is out of range.
+        /// Views are valid until the table is modified.
+        bool Get(const size_t index, std::string_view& outName, std::string_view& outValue) const;
+        /// Searches for the header, returns index of the full match or `0`.
+        /// - `outNameIndex`: index of the first entry with the same name or `0`.
+        size_t Find(const std::string_view name, const std::string_view value, size_t& outNameIndex) const;
+
+        void Add(const std::string_view name, const std::string_view value);
+        void SetMaxSize(const size_t newMaxSize);
+
+        inline size_t GetMaxSize() const { return maxSize; }
+        inline size_t GetSize() const { return size; }
+        inline size_t GetDynamicCount() const { return entries.size(); }
+    };
+
+    /// Primitive HPACK representations: prefixed integers and (Huffman coded) strings.
+    class Hpack {
+    public:
+        static void EncodeInteger(std::string& out, const uint8_t firstByte, const uint8_t prefixBits, uint64_t value);
+        /// Returns number of consumed bytes or `0` on malformed/incomplete input.
+        static size_t
+        DecodeInteger(const uint8_t* data, const size_t size, const uint8_t prefixBits, uint64_t& outValue);
+
+        /// Encodes string literal, Huffman coding is used if it's shorter.
+        static void EncodeString(std::string& out, const std::string_view string);
+        /// Returns number of consumed bytes or `0` on malformed/incomplete input.
+        static size_t DecodeString(const uint8_t* data, const size_t size, std::string& outString);
+
+        static size_t GetHuffmanSize(const std::string_view string);
+        static void HuffmanEncode(std::string& out, const std::string_view string);
+        static bool HuffmanDecode(const uint8_t* data, const size_t size, std::string& outString);
+    };
+
+    class HpackEncoder {
+    private:
+        HpackTable table;
+        // Size update must be signalled at the beginning of the next block.
+        bool isSizeUpdatePending = false;
+
+    public:
+        /// Appends encoded header block to `out`.
+        void Encode(const std::vector<HeaderField>& headers, std::string& out);
+        /// Applies `SETTINGS_HEADER_TABLE_SIZE` received from the peer.
+        void SetMaxTableSize(const size_t maxSize);
+    };
+
+    class HpackDecoder {
+    private:
+        HpackTable table;
+        // Upper limit the peer is allowed to set with a size update.
+        size_t maxAllowedSize = HpackTable::DEFAULT_MAX_SIZE;
+
+    public:
+        /// Decodes complete header block, appends fields to `outHeaders`.
+        /// Returns `false` on compression error, the connection must be closed in that case.
+        bool Decode(const uint8_t* data, const size_t size, std::vector<HeaderField>& outHeaders);
+        /// Applies our own `SETTINGS_HEADER_TABLE_SIZE`.
+        void SetMaxTableSize(const size_t maxSize);
+    };
+} // namespace Net
+
+#endif
@@ -0,0 +1,686 @@
+#include "http2Client.h"
+
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstring>
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+
+#include "utils.h"
+
+using namespace Net;
+
+static constexpr size_t READ_CHUNK_SIZE = 16384;
+// Protocol identifier list in ALPN wire format.
+static constexpr unsigned char ALPN_H2[] = {2, 'h', '2'};
+
+Status Http2Client::Connect(const char* host, const Address::port_t port, const bool useTls) {
+    LIBPOG_ASSERT(socket.IsOpen() == false, "Client is already connected");
+
+    const Address address = Address::FromDomain(host, port, Protocol::TCP);
+    if (address.IsValid() == false) [[unlikely]] {
+        return InvalidAddress;
+    }
+
+    if (socket.Open(address.GetFamily(), Protocol::TCP) == false || socket.Connect(address) == false) {
+        const Status status = socket.Fail();
+        socket.Close();
+        return (status == Success) ? Failed : status;
+    }
+
+    if (useTls && HandshakeTls(host) == false) {
+        isFailed = true;
+        Disconnect();
+        return Failed;
+    }
+
+    scheme = useTls ? "https" : "http";
+    authority = host;
+    if (port != (useTls ? 443 : 80)) {
+        authority += ':' + std::to_string(port);
+    }
+
+    // Connection preface, our settings and the larger connection window go in one write.
+    output.append(Http2Frame::PREFACE);
+    Http2Frame::AppendHeader(output, 12, Http2Frame::Type::Settings, 0, 0);
+    Http2Frame::AppendSetting(output, Http2Frame::Setting::EnablePush, 0);
+    Http2Frame::AppendSetting(output, Http2Frame::Setting::InitialWindowSize, STREAM_WINDOW_SIZE);
+    Http2Frame::AppendWindowUpdate(output, 0, CONNECTION_WINDOW_SIZE - Http2Frame::DEFAULT_WINDOW_SIZE);
+
+    if (Flush() == false) [[unlikely]] {
+        isFailed = true;
+        Disconnect();
+        return Failed;
+    }
+
+    isPrefaceSent = true;
+    return Success;
+}
+
+void Http2Client::Disconnect() {
+    if (socket.IsOpen() && isPrefaceSent && isFailed == false) {
+        Http2Frame::AppendGoAway(output, 0, Http2Frame::Error::NoError);
+        Flush();
+    }
+
+    ReleaseTls();
+    socket.Close();
+
+    streams.clear();
+    pending.clear();
+    input.clear();
+    output.clear();
+    headerBlock.clear();
+
+    encoder = HpackEncoder();
+    decoder = HpackDecoder();
+
+    isFailed = false;
+    isPrefaceSent = false;
+    nextStreamId = 1;
+    activeStreams = 0;
+    peerMaxConcurrentStreams = UINT32_MAX;
+    peerInitialWindowSize = Http2Frame::DEFAULT_WINDOW_SIZE;
+    peerMaxFrameSize = Http2Frame::DEFAULT_MAX_FRAME_SIZE;
+    goAwayLastStreamId = UINT32_MAX;
+    connectionSendWindow = Http2Frame::DEFAULT_WINDOW_SIZE;
+    connectionReceivedUnacked = 0;
+    continuationStreamId = 0;
+    inputOffset = 0;
+}
+
+bool Http2Client::HandshakeTls(const char* host) {
+    sslContext = SSL_CTX_new(TLS_client_method());
+    if (sslContext == nullptr) [[unlikely]] {
+        Utils::Error("Failed to create TLS context: ", ERR_reason_error_string(ERR_get_error()));
+        return false;
+    }
+
+    // HTTP/2 requires TLS 1.2 at least.
+    SSL_CTX_set_min_proto_version(sslContext, TLS1_2_VERSION);
+    SSL_CTX_set_alpn_protos(sslContext, ALPN_H2, sizeof(ALPN_H2));
+    if (isVerifyPeer) {
+        SSL_CTX_set_default_verify_paths(sslContext);
+        SSL_CTX_set_verify(sslContext, SSL_VERIFY_PEER, nullptr);
+    }
+
+    ssl = SSL_new(sslContext);
+    SSL_set_fd(ssl, static_cast<int>(socket.GetHandle()));
+    SSL_set_tlsext_host_name(ssl, host);
+    if (isVerifyPeer) {
+        SSL_set1_host(ssl, host);
+    }
+
+    if (SSL_connect(ssl) != 1) {
+        Utils::Error("TLS handshake failed: ", ERR_reason_error_string(ERR_get_error()));
+        return false;
+    }
+
+    const unsigned char* protocol = nullptr;
+    unsigned int protocolSize = 0;
+    SSL_get0_alpn_selected(ssl, &protocol, &protocolSize);
+    if (protocolSize != 2 || std::memcmp(protocol, "h2", 2) != 0) {
+        Utils::Error("Server didn't negotiate HTTP/2 with ALPN");
+        return false;
+    }
+
+    return true;
+}
+
+void Http2Client::ReleaseTls() {
+    if (ssl != nullptr) {
+        SSL_shutdown(ssl);
+        SSL_free(ssl);
+        ssl = nullptr;
+    }
+    if (sslContext != nullptr) {
+        SSL_CTX_free(sslContext);
+        sslContext = nullptr;
+    }
+}
+
+bool Http2Client::Write(const char* data, const size_t size) {
+    size_t sent = 0;
+    while (sent < size) {
+        const uint chunk = static_cast<uint>(std::min<size_t>(size - sent, INT_MAX));
+
+        int ret;
+        if (ssl != nullptr) {
+            ret = SSL_write(ssl, data + sent, chunk);
+        } else {
+            ret = static_cast<int>(socket.Send(data + sent, chunk));
+        }
+
+        if (ret <= 0) [[unlikely]] {
+            return false;
+        }
+        sent += ret;
+    }
+
+    return true;
+}
+
+bool Http2Client::Flush() {
+    if (output.empty()) return true;
+
+    const bool result = Write(output.data(), output.size());
+    output.clear();
+
+    return result;
+}
+
+bool Http2Client::ReadFrames() {
+    if (isFailed) [[unlikely]] {
+        return false;
+    }
+
+    input.erase(0, inputOffset);
+    inputOffset = 0;
+
+    const size_t oldSize = input.size();
+    input.resize(oldSize + READ_CHUNK_SIZE);
+
+    int received;
+    if (ssl != nullptr) {
+        received = SSL_read(ssl, input.data() + oldSize, READ_CHUNK_SIZE);
+    } else {
+        received = static_cast<int>(socket.Receive(input.data() + oldSize, READ_CHUNK_SIZE));
+    }
+
+    input.resize(oldSize + std::max(received, 0));
+    if (received <= 0) {
+        Utils::Warn("HTTP/2 connection closed");
+        FailConnection(Http2Frame::Error::ConnectError);
+        return false;
+    }
+
+    while (input.size() - inputOffset >= Http2Frame::HEADER_SIZE) {
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(input.data() + inputOffset);
+        const Http2Frame frame = Http2Frame::Parse(data);
+
+        // We never increase `SETTINGS_MAX_FRAME_SIZE`.
+        if (frame.length > Http2Frame::DEFAULT_MAX_FRAME_SIZE) [[unlikely]] {
+            FailConnection(Http2Frame::Error::FrameSizeError);
+            return false;
+        }
+        if (input.size() - inputOffset < Http2Frame::HEADER_SIZE + frame.length) {
+            break;
+        }
+
+        inputOffset += Http2Frame::HEADER_SIZE + frame.length;
+        if (ProcessFrame(frame, data + Http2Frame::HEADER_SIZE) == false) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Http2Client::ProcessFrame(const Http2Frame& frame, const uint8_t* payload) {
+    typedef Http2Frame::Type Type;
+
+    if (continuationStreamId != 0 && (frame.type != Type::Continuation || frame.streamId != continuationStreamId)) {
+        FailConnection(Http2Frame::Error::ProtocolError);
+        return false;
+    }
+
+    // Strip padding and priority fields, leaving the fragment itself.
+    const uint8_t* data = payload;
+    uint32_t size = frame.length;
+    if ((frame.type == Type::Data || frame.type == Type::Headers) && frame.HasFlag(Http2Frame::Padded)) {
+        if (size < 1 || data[0] >= size) [[unlikely]] {
+            FailConnection(Http2Frame::Error::ProtocolError);
+            return false;
+        }
+        size -= data[0] + 1;
+        data += 1;
+    }
+    if (frame.type == Type::Headers && frame.HasFlag(Http2Frame::Priority)) {
+        if (size < 5) [[unlikely]] {
+            FailConnection(Http2Frame::Error::ProtocolError);
+            return false;
+        }
+        size -= 5;
+        data += 5;
+    }
+
+    switch (frame.type) {
+        case Type::Data: {
+            if (frame.streamId == 0) [[unlikely]] {
+                FailConnection(Http2Frame::Error::ProtocolError);
+                return false;
+            }
+
+            // Padding is the part of flow control too.
+            connectionReceivedUnacked += frame.length;
+            if (connectionReceivedUnacked >= CONNECTION_WINDOW_SIZE / 2) {
+                Http2Frame::AppendWindowUpdate(output, 0, connectionReceivedUnacked);
+                connectionReceivedUnacked = 0;
+            }
+
+            const auto it = streams.find(frame.streamId);
+            if (it == streams.end() || it->second.isComplete) {
+                break;
+            }
+
+            Stream& stream = it->second;
+            stream.response.body.append(reinterpret_cast<const char*>(data), size);
+
+            if (frame.HasFlag(Http2Frame::EndStream)) {
+                CompleteStream(stream);
+                break;
+            }
+
+            stream.receivedUnacked += frame.length;
+            if (stream.receivedUnacked >= STREAM_WINDOW_SIZE / 2) {
+                Http2Frame::AppendWindowUpdate(output, frame.streamId, stream.receivedUnacked);
+                stream.receivedUnacked = 0;
+            }
+        } break;
+        case Type::Headers: {
+            headerBlock.assign(reinterpret_cast<const char*>(data), size);
+            if (frame.HasFlag(Http2Frame::EndHeaders)) {
+                return ProcessHeaderBlock(frame.streamId, frame.HasFlag(Http2Frame::EndStream));
+            }
+
+            continuationStreamId = frame.streamId;
+            isContinuationEndStream = frame.HasFlag(Http2Frame::EndStream);
+        } break;
+        case Type::Continuation: {
+            if (continuationStreamId == 0) [[unlikely]] {
+                FailConnection(Http2Frame::Error::ProtocolError);
+                return false;
+            }
+
+            headerBlock.append(reinterpret_cast<const char*>(data), size);
+            if (frame.HasFlag(Http2Frame::EndHeaders)) {
+                const uint32_t streamId = continuationStreamId;
+                continuationStreamId = 0;
+                return ProcessHeaderBlock(streamId, isContinuationEndStream);
+            }
+        } break;
+        case Type::RstStream: {
+            if (size != 4) [[unlikely]] {
+                FailConnection(Http2Frame::Error::FrameSizeError);
+                return false;
+            }
+
+            const auto it = streams.find(frame.streamId);
+            if (it != streams.end() && it->second.isComplete == false) {
+                it->second.response.isFailed = true;
+                it->second.response.error = static_cast<Http2Frame::Error>(Http2Frame::ReadUint32(data));
+                CompleteStream(it->second);
+            }
+        } break;
+        case Type::Settings:
+            return ProcessSettings(frame, data);
+        case Type::PushPromise:
+            // Server push is disabled in our settings.
+            FailConnection(Http2Frame::Error::ProtocolError);
+            return false;
+        case Type::Ping: {
+            if (size != 8 || frame.streamId != 0) [[unlikely]] {
+                FailConnection(Http2Frame::Error::ProtocolError);
+                return false;
+            }
+
+            if (frame.HasFlag(Http2Frame::Ack) == false) {
+                Http2Frame::AppendHeader(output, 8, Type::Ping, Http2Frame::Ack, 0);
+                output.append(reinterpret_cast<const char*>(data), 8);
+            }
+        } break;
+        case Type::GoAway: {
+            if (size < 8) [[unlikely]] {
+                FailConnection(Http2Frame::Error::FrameSizeError);
+                return false;
+            }
+
+            goAwayLastStreamId = Http2Frame::ReadUint32(data) & 0x7fffffff;
+            const auto error = static_cast<Http2Frame::Error>(Http2Frame::ReadUint32(data + 4));
+            if (error != Http2Frame::Error::NoError) {
+                Utils::Warn("HTTP/2 server sent GOAWAY with error code ", static_cast<uint32_t>(error));
+            }
+
+            // Streams above the last one were not processed and can be retried on a new connection.
+            pending.clear();
+            for (auto& [streamId, stream] : streams) {
+                if (streamId > goAwayLastStreamId && stream.isComplete == false) {
+                    stream.response.isFailed = true;
+                    stream.response.error = Http2Frame::Error::RefusedStream;
+                    CompleteStream(stream);
+                }
+            }
+        } break;
+        case Type::WindowUpdate: {
+            if (size != 4) [[unlikely]] {
+                FailConnection(Http2Frame::Error::FrameSizeError);
+                return false;
+            }
+
+            const uint32_t increment = Http2Frame::ReadUint32(data) & 0x7fffffff;
+            if (increment == 0) [[unlikely]] {
+                FailConnection(Http2Frame::Error::ProtocolError);
+                return false;
+            }
+
+            ProcessWindowUpdate(frame.streamId, increment);
+        } break;
+        default:
+            // `PRIORITY` and unknown frame types are ignored.
+            break;
+    }
+
+    return true;
+}
+
+bool Http2Client::ProcessSettings(const Http2Frame& frame, const uint8_t* payload) {
+    typedef Http2Frame::Setting Setting;
+
+    if (frame.streamId != 0 || (frame.HasFlag(Http2Frame::Ack) && frame.length != 0) || frame.length % 6 != 0)
+        [[unlikely]] {
+        FailConnection(Http2Frame::Error::ProtocolError);
+        return false;
+    }
+    if (frame.HasFlag(Http2Frame::Ack)) {
+        return true;
+    }
+
+    for (uint32_t offset = 0; offset < frame.length; offset += 6) {
+        const auto setting = static_cast<Setting>(Http2Frame::ReadUint16(payload + offset));
+        const uint32_t value = Http2Frame::ReadUint32(payload + offset + 2);
+
+        switch (setting) {
+            case Setting::HeaderTableSize:
+                encoder.SetMaxTableSize(value);
+                break;
+            case Setting::MaxConcurrentStreams:
+                peerMaxConcurrentStreams = value;
+                break;
+            case Setting::InitialWindowSize: {
+                if (value > Http2Frame::MAX_WINDOW_SIZE) [[unlikely]] {
+                    FailConnection(Http2Frame::Error::FlowControlError);
+                    return false;
+                }
+
+                // Change applies to windows of open streams retroactively, pending ones take the new value on opening.
+                const int64_t delta = static_cast<int64_t>(value) - peerInitialWindowSize;
+                for (auto& [streamId, stream] : streams) {
+                    if (stream.isOpen) stream.sendWindow += delta;
+                }
+                peerInitialWindowSize = value;
+            } break;
+            case Setting::MaxFrameSize:
+                if (value < Http2Frame::DEFAULT_MAX_FRAME_SIZE || value > 0xffffff) [[unlikely]] {
+                    FailConnection(Http2Frame::Error::ProtocolError);
+                    return false;
+                }
+                peerMaxFrameSize = value;
+                break;
+            default:
+                break;
+        }
+    }
+
+    Http2Frame::AppendHeader(output, 0, Http2Frame::Type::Settings, Http2Frame::Ack, 0);
+
+    OpenPending();
+    for (auto& [streamId, stream] : streams) {
+        if (stream.isOpen) SendData(streamId, stream);
+    }
+
+    return true;
+}
+
+bool Http2Client::ProcessHeaderBlock(const uint32_t streamId, const bool isEndStream) {
+    std::vector<HeaderField> fields;
+
+    // Block must be decoded even if the stream is gone to keep the HPACK state in sync.
+    if (decoder.Decode(reinterpret_cast<const uint8_t*>(headerBlock.data()), headerBlock.size(), fields) == false) {
+        FailConnection(Http2Frame::Error::CompressionError);
+        return false;
+    }
+
+    const auto it = streams.find(streamId);
+    if (it == streams.end() || it->second.isComplete) {
+        return true;
+    }
+
+    Http2Response& response = it->second.response;
+    const bool isTrailers = response.status != 0;
+
+    for (HeaderField& field : fields) {
+        if (field.name == ":status") {
+            const char* end = field.value.data() + field.value.size();
+            std::from_chars(field.value.data(), end, response.status);
+        } else if (field.name.empty() == false && field.name[0] != ':') {
+            response.headers.push_back(std::move(field));
+        }
+    }
+
+    // Informational (1xx) responses precede the final one.
+    if (isTrailers == false && response.status >= 100 && response.status < 200 && isEndStream == false) {
+        response.status = 0;
+        response.headers.clear();
+    }
+
+    if (isEndStream) {
+        CompleteStream(it->second);
+    }
+
+    return true;
+}
+
+void Http2Client::ProcessWindowUpdate(const uint32_t streamId, const uint32_t increment) {
+    if (streamId == 0) {
+        connectionSendWindow += increment;
+        for (auto& [id, stream] : streams) {
+            SendData(id, stream);
+        }
+        return;
+    }
+
+    const auto it = streams.find(streamId);
+    if (it == streams.end()) {
+        return;
+    }
+
+    it->second.sendWindow += increment;
+    SendData(streamId, it->second);
+}
+
+void Http2Client::OpenPending() {
+    std::string block;
+
+    while (pending.empty() == false && activeStreams < peerMaxConcurrentStreams) {
+        const PendingRequest request = std::move(pending.front());
+        pending.pop_front();
+
+        Stream& stream = streams[request.streamId];
+        stream.sendWindow = peerInitialWindowSize;
+        stream.isOpen = true;
+        ++activeStreams;
+
+        block.clear();
+        encoder.Encode(request.headers, block);
+
+        // Header block larger than the frame continues in `CONTINUATION` frames.
+        size_t offset = 0;
+        bool isFirst = true;
+        do {
+            const size_t fragment = std::min<size_t>(block.size() - offset, peerMaxFrameSize);
+            const bool isLast = offset + fragment == block.size();
+
+            uint8_t flags = isLast ? Http2Frame::EndHeaders : 0;
+            if (isFirst && stream.body.empty()) {
+                flags |= Http2Frame::EndStream;
+            }
+
+            Http2Frame::AppendHeader(
+                output, fragment, isFirst ? Http2Frame::Type::Headers : Http2Frame::Type::Continuation, flags,
+                request.streamId
+            );
+            output.append(block, offset, fragment);
+
+            offset += fragment;
+            isFirst = false;
+        } while (offset < block.size());
+
+        SendData(request.streamId, stream);
+    }
+}
+
+void Http2Client::SendData(const uint32_t streamId, Stream& stream) {
+    while (stream.bodyOffset < stream.body.size()) {
+        // `DATA` never goes before `HEADERS` of the stream.
+        const int64_t window = std::min(stream.sendWindow, connectionSendWindow);
+        if (window <= 0 || stream.isComplete || stream.isOpen == false) {
+            return;
+        }
+
+        const size_t chunk =
+            std::min<size_t>({stream.body.size() - stream.bodyOffset, static_cast<size_t>(window), peerMaxFrameSize});
+        const bool isLast = stream.bodyOffset + chunk == stream.body.size();
+
+        Http2Frame::AppendHeader(output, chunk, Http2Frame::Type::Data, isLast ? Http2Frame::EndStream : 0, streamId);
+        output.append(stream.body, stream.bodyOffset, chunk);
+
+        stream.bodyOffset += chunk;
+        stream.sendWindow -= chunk;
+        connectionSendWindow -= chunk;
+    }
+
+    if (stream.body.empty() == false) {
+        stream.body.clear();
+        stream.body.shrink_to_fit();
+        stream.bodyOffset = 0;
+    }
+}
+
+void Http2Client::CompleteStream(Stream& stream) {
+    if (stream.isComplete) return;
+
+    stream.isComplete = true;
+    stream.body.clear();
+
+    if (stream.isOpen) {
+        stream.isOpen = false;
+        --activeStreams;
+    }
+
+    OpenPending();
+}
+
+void Http2Client::FailConnection(const Http2Frame::Error error) {
+    if (isFailed) return;
+
+    if (error != Http2Frame::Error::ConnectError) {
+        Utils::Error("HTTP/2 connection error: ", static_cast<uint32_t>(error));
+        Http2Frame::AppendGoAway(output, 0, error);
+        Flush();
+    }
+
+    isFailed = true;
+    pending.clear();
+
+    for (auto& [streamId, stream] : streams) {
+        if (stream.isComplete) continue;
+
+        stream.response.isFailed = true;
+        stream.response.error = error;
+        stream.isOpen = false;
+        stream.isComplete = true;
+    }
+    activeStreams = 0;
+}
+
+uint32_t Http2Client::Submit(
+    const std::string_view method,
+    const std::string_view path,
+    const std::vector<HeaderField>& headers,
+    const std::string_view body
+) {
+    if (IsConnected() == false || nextStreamId > goAwayLastStreamId || nextStreamId > Http2Frame::MAX_WINDOW_SIZE)
+        [[unlikely]] {
+        return 0;
+    }
+
+    const uint32_t streamId = nextStreamId;
+    nextStreamId += 2;
+
+    PendingRequest& request = pending.emplace_back();
+    request.streamId = streamId;
+    request.headers.reserve(headers.size() + 4);
+    request.headers.push_back({":method", std::string(method)});
+    request.headers.push_back({":scheme", scheme});
+    request.headers.push_back({":authority", authority});
+    request.headers.push_back({":path", std::string(path)});
+    request.headers.insert(request.headers.end(), headers.begin(), headers.end());
+
+    Stream& stream = streams[streamId];
+    stream.response.streamId = streamId;
+    stream.body.assign(body);
+
+    // Frames are only buffered here, so many submits are coalesced into one write.
+    OpenPending();
+    return streamId;
+}
+
+bool Http2Client::Wait(const uint32_t streamId, Http2Response& outResponse) {
+    const auto it = streams.find(streamId);
+    if (it == streams.end()) {
+        return false;
+    }
+
+    Stream& stream = it->second;
+    while (stream.isComplete == false) {
+        if (Flush() == false) {
+            FailConnection(Http2Frame::Error::ConnectError);
+            break;
+        }
+        ReadFrames();
+    }
+
+    outResponse = std::move(stream.response);
+    streams.erase(streamId);
+
+    return true;
+}
+
+void Http2Client::WaitAll(std::vector<Http2Response>& outResponses) {
+    while (streams.empty() == false) {
+        for (auto it = streams.begin(); it != streams.end();) {
+            if (it->second.isComplete) {
+                outResponses.push_back(std::move(it->second.response));
+                it = streams.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if (streams.empty()) break;
+
+        if (Flush() == false) {
+            FailConnection(Http2Frame::Error::ConnectError);
+            continue;
+        }
+        ReadFrames();
+    }
+}
+
+Http2Response Http2Client::Request(
+    const std::string_view method,
+    const std::string_view path,
+    const std::vector<HeaderField>& headers,
+    const std::string_view body
+) {
+    Http2Response response;
+
+    const uint32_t streamId = Submit(method, path, headers, body);
+    if (streamId == 0 || Wait(streamId, response) == false) {
+        response.isFailed = true;
+    }
+
+    return response;
+}
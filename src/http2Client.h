@@ -0,0 +1,154 @@
+#ifndef _HTTP2CLIENT_H
+#define _HTTP2CLIENT_H
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "hpack.h"
+#include "http2Frame.h"
+#include "socket.h"
+
+typedef struct ssl_st SSL;
+typedef struct ssl_ctx_st SSL_CTX;
+
+namespace Net {
+    struct Http2Response {
+        uint32_t streamId = 0;
+        uint16_t status = 0;
+        std::vector<HeaderField> headers;
+        std::string body;
+
+        /// Set if the stream was reset or the connection failed before the response was complete.
+        bool isFailed = false;
+        Http2Frame::Error error = Http2Frame::Error::NoError;
+    };
+
+    /// HTTP/2 client, runs many concurrent requests (streams) over a single connection.
+    /// Works over cleartext TCP with prior knowledge (h2c) or over TLS negotiated with ALPN (h2).
+    ///
+    /// Requests are queued with `Submit()` and completed by `Wait()`/`WaitAll()`, which read
+    /// and process incoming frames on the calling thread.
+    class Http2Client {
+    public:
+        // Receive windows advertised to the server.
+        static constexpr uint32_t STREAM_WINDOW_SIZE = 1 << 20;
+        static constexpr uint32_t CONNECTION_WINDOW_SIZE = 1 << 24;
+
+    private:
+        struct Stream {
+            Http2Response response;
+            // Request body part that wasn't sent yet because of flow control.
+            std::string body;
+            size_t bodyOffset = 0;
+            int64_t sendWindow = 0;
+            uint32_t receivedUnacked = 0;
+            // Stream is counted as active from sending `HEADERS` till completion.
+            bool isOpen = false;
+            bool isComplete = false;
+        };
+
+        struct PendingRequest {
+            uint32_t streamId;
+            std::vector<HeaderField> headers;
+        };
+
+        Socket socket;
+        SSL_CTX* sslContext = nullptr;
+        SSL* ssl = nullptr;
+        bool isVerifyPeer = true;
+        bool isFailed = false;
+        // `GOAWAY` is only valid once the connection preface went out.
+        bool isPrefaceSent = false;
+
+        std::string authority;
+        std::string scheme;
+
+        HpackEncoder encoder;
+        HpackDecoder decoder;
+
+        std::unordered_map<uint32_t, Stream> streams;
+        std::deque<PendingRequest> pending;
+        uint32_t nextStreamId = 1;
+        uint32_t activeStreams = 0;
+
+        // Peer settings.
+        uint32_t peerMaxConcurrentStreams = UINT32_MAX;
+        uint32_t peerInitialWindowSize = Http2Frame::DEFAULT_WINDOW_SIZE;
+        uint32_t peerMaxFrameSize = Http2Frame::DEFAULT_MAX_FRAME_SIZE;
+        uint32_t goAwayLastStreamId = UINT32_MAX;
+
+        int64_t connectionSendWindow = Http2Frame::DEFAULT_WINDOW_SIZE;
+        uint32_t connectionReceivedUnacked = 0;
+
+        // Header block split into `CONTINUATION` frames.
+        uint32_t continuationStreamId = 0;
+        bool isContinuationEndStream = false;
+        std::string headerBlock;
+
+        std::string input;
+        size_t inputOffset = 0;
+        std::string output;
+
+        bool HandshakeTls(const char* host);
+        void ReleaseTls();
+
+        bool Write(const char* data, const size_t size);
+        bool Flush();
+        bool ReadFrames();
+
+        bool ProcessFrame(const Http2Frame& frame, const uint8_t* payload);
+        bool ProcessSettings(const Http2Frame& frame, const uint8_t* payload);
+        bool ProcessHeaderBlock(const uint32_t streamId, const bool isEndStream);
+        void ProcessWindowUpdate(const uint32_t streamId, const uint32_t increment);
+
+        void OpenPending();
+        void SendData(const uint32_t streamId, Stream& stream);
+        void CompleteStream(Stream& stream);
+        void FailConnection(const Http2Frame::Error error);
+
+    public:
+        Http2Client() = default;
+        ~Http2Client() { Disconnect(); }
+
+        Http2Client(const Http2Client&) = delete;
+
+        /// Connects and performs HTTP/2 connection preface.
+        /// - `useTls`: `false` means cleartext h2c with prior knowledge, `true` - TLS with "h2" ALPN.
+        Status Connect(const char* host, const Address::port_t port, const bool useTls = false);
+        void Disconnect();
+
+        /// Disables server certificate verification, for local testing only.
+        inline void SetVerifyPeer(const bool verify) { isVerifyPeer = verify; }
+
+        /// Queues the request, it's sent as soon as the server allows one more concurrent stream.
+        /// Header names must be lowercase. Returns stream id, `0` if the connection can't take new streams.
+        uint32_t Submit(
+            const std::string_view method,
+            const std::string_view path,
+            const std::vector<HeaderField>& headers = {},
+            const std::string_view body = {}
+        );
+
+        /// Processes incoming frames until the stream is complete.
+        /// Returns `false` if there is no such stream, `outResponse.isFailed` is set on failures.
+        bool Wait(const uint32_t streamId, Http2Response& outResponse);
+        /// Processes incoming frames until all submitted streams are complete,
+        /// responses are appended in the order of completion.
+        void WaitAll(std::vector<Http2Response>& outResponses);
+
+        /// `Submit()` and `Wait()` in one call.
+        Http2Response Request(
+            const std::string_view method,
+            const std::string_view path,
+            const std::vector<HeaderField>& headers = {},
+            const std::string_view body = {}
+        );
+
+        inline bool IsConnected() const { return socket.IsConnected() && !isFailed; }
+        inline size_t GetActiveStreams() const { return activeStreams; }
+    };
+} // namespace Net
+
+#endif
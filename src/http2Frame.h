@@ -0,0 +1,136 @@
+#ifndef _HTTP2_FRAME_H
+#define _HTTP2_FRAME_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace Net {
+    /// HTTP/2 (RFC 9113) frame header and protocol constants.
+    struct Http2Frame {
+        enum class Type : uint8_t {
+            Data = 0x0,
+            Headers = 0x1,
+            Priority = 0x2,
+            RstStream = 0x3,
+            Settings = 0x4,
+            PushPromise = 0x5,
+            Ping = 0x6,
+            GoAway = 0x7,
+            WindowUpdate = 0x8,
+            Continuation = 0x9,
+        };
+        enum Flags : uint8_t {
+            EndStream = 0x1,
+            Ack = 0x1,
+            EndHeaders = 0x4,
+            Padded = 0x8,
+            Priority = 0x20,
+        };
+        enum class Setting : uint16_t {
+            HeaderTableSize = 0x1,
+            EnablePush = 0x2,
+            MaxConcurrentStreams = 0x3,
+            InitialWindowSize = 0x4,
+            MaxFrameSize = 0x5,
+            MaxHeaderListSize = 0x6,
+        };
+        enum class Error : uint32_t {
+            NoError = 0x0,
+            ProtocolError = 0x1,
+            InternalError = 0x2,
+            FlowControlError = 0x3,
+            SettingsTimeout = 0x4,
+            StreamClosed = 0x5,
+            FrameSizeError = 0x6,
+            RefusedStream = 0x7,
+            Cancel = 0x8,
+            CompressionError = 0x9,
+            ConnectError = 0xa,
+            EnhanceYourCalm = 0xb,
+            InadequateSecurity = 0xc,
+            Http11Required = 0xd,
+        };
+
+        static constexpr size_t HEADER_SIZE = 9;
+        static constexpr uint32_t DEFAULT_MAX_FRAME_SIZE = 16384;
+        static constexpr uint32_t DEFAULT_WINDOW_SIZE = 65535;
+        static constexpr uint32_t MAX_WINDOW_SIZE = 0x7fffffff;
+        static constexpr std::string_view PREFACE = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+
+        uint32_t length;
+        Type type;
+        uint8_t flags;
+        uint32_t streamId;
+
+        inline bool HasFlag(const uint8_t flag) const { return (flags & flag) != 0; }
+
+        static inline uint32_t ReadUint32(const uint8_t* data) {
+            return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+                   (static_cast<uint32_t>(data[2]) << 8) | data[3];
+        }
+        static inline uint16_t ReadUint16(const uint8_t* data) {
+            return static_cast<uint16_t>((data[0] << 8) | data[1]);
+        }
+
+        static inline void AppendUint32(std::string& out, const uint32_t value) {
+            out.push_back(static_cast<char>(value >> 24));
+            out.push_back(static_cast<char>(value >> 16));
+            out.push_back(static_cast<char>(value >> 8));
+            out.push_back(static_cast<char>(value));
+        }
+        static inline void AppendUint16(std::string& out, const uint16_t value) {
+            out.push_back(static_cast<char>(value >> 8));
+            out.push_back(static_cast<char>(value));
+        }
+
+        /// Parses `HEADER_SIZE` bytes of the frame header.
+        static inline Http2Frame Parse(const uint8_t* data) {
+            Http2Frame frame;
+            frame.length = (static_cast<uint32_t>(data[0]) << 16) | (static_cast<uint32_t>(data[1]) << 8) | data[2];
+            frame.type = static_cast<Type>(data[3]);
+            frame.flags = data[4];
+            frame.streamId = ReadUint32(data + 5) & 0x7fffffff;
+            return frame;
+        }
+
+        /// Appends frame header, payload of `length` bytes must follow.
+        static inline void AppendHeader(
+            std::string& out,
+            const uint32_t length,
+            const Type type,
+            const uint8_t flags,
+            const uint32_t streamId
+        ) {
+            out.push_back(static_cast<char>(length >> 16));
+            out.push_back(static_cast<char>(length >> 8));
+            out.push_back(static_cast<char>(length));
+            out.push_back(static_cast<char>(type));
+            out.push_back(static_cast<char>(flags));
+            AppendUint32(out, streamId & 0x7fffffff);
+        }
+
+        static inline void AppendSetting(std::string& out, const Setting setting, const uint32_t value) {
+            AppendUint16(out, static_cast<uint16_t>(setting));
+            AppendUint32(out, value);
+        }
+
+        static inline void AppendWindowUpdate(std::string& out, const uint32_t streamId, const uint32_t increment) {
+            AppendHeader(out, 4, Type::WindowUpdate, 0, streamId);
+            AppendUint32(out, increment);
+        }
+
+        static inline void AppendRstStream(std::string& out, const uint32_t streamId, const Error error) {
+            AppendHeader(out, 4, Type::RstStream, 0, streamId);
+            AppendUint32(out, static_cast<uint32_t>(error));
+        }
+
+        static inline void AppendGoAway(std::string& out, const uint32_t lastStreamId, const Error error) {
+            AppendHeader(out, 8, Type::GoAway, 0, 0);
+            AppendUint32(out, lastStreamId);
+            AppendUint32(out, static_cast<uint32_t>(error));
+        }
+    };
+} // namespace Net
+
+#endif
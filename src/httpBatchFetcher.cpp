@@ -0,0 +1,546 @@
+#include "httpBatchFetcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+
+#include "stringUtils.h"
+#include "utils.h"
+
+using namespace Net;
+
+typedef std::chrono::steady_clock Clock;
+
+static constexpr int POLL_TIMEOUT_MS = 100;
+static constexpr uint READ_CHUNK_SIZE = 16384;
+// Declared length is only reserved up to this, the rest of the body grows as it arrives.
+static constexpr size_t MAX_BODY_RESERVE = 1024 * 1024;
+
+struct HttpBatchFetcher::Host {
+    /// Value of the `Host` header.
+    std::string name;
+    Address address;
+
+    std::deque<size_t> pending;
+    std::vector<Connection*> idle;
+    uint openCount = 0;
+};
+
+struct HttpBatchFetcher::Connection {
+    enum class Phase : uint8_t { Connecting, Writing, Reading, Idle };
+    /// Part of the response the parser is waiting for.
+    enum class Stage : uint8_t { Head, Length, Chunked, UntilClose };
+
+    Socket socket;
+    Host& host;
+    Phase phase = Phase::Connecting;
+    bool isClosed = false;
+    uint responsesCount = 0;
+
+    // Current request.
+    size_t index = 0;
+    std::string output;
+    size_t written = 0;
+    std::string input;
+    HttpResponse response;
+    Stage stage = Stage::Head;
+    size_t remaining = 0;
+    bool isReceived = false;
+    Clock::time_point startedAt;
+    Clock::time_point deadline;
+
+    explicit Connection(Host& host) : host(host) {}
+};
+
+// Defined here, where `Host` and `Connection` are complete.
+HttpBatchFetcher::HttpBatchFetcher() = default;
+HttpBatchFetcher::HttpBatchFetcher(const Options& options) : options(options) {}
+HttpBatchFetcher::~HttpBatchFetcher() = default;
+
+bool HttpBatchFetcher::ParseUrl(const std::string_view url, Request& outRequest) {
+    static constexpr std::string_view SCHEME = "http://";
+    if (url.substr(0, SCHEME.size()) != SCHEME) [[unlikely]] {
+        return false;
+    }
+
+    const std::string_view rest = url.substr(SCHEME.size());
+    const size_t pathBegin = rest.find('/');
+    const std::string_view authority = rest.substr(0, pathBegin);
+    outRequest.uri = (pathBegin == std::string_view::npos) ? "/" : std::string(rest.substr(pathBegin));
+
+    // `[::1]:8080` style for IPv6 literals.
+    size_t portSeparator = authority.rfind(':');
+    if (authority.empty() == false && authority.front() == '[') {
+        const size_t bracket = authority.find(']');
+        if (bracket == std::string_view::npos) [[unlikely]] {
+            return false;
+        }
+        outRequest.host = std::string(authority.substr(1, bracket - 1));
+        const bool hasPort = bracket + 1 < authority.size() && authority[bracket + 1] == ':';
+        portSeparator = hasPort ? bracket + 1 : std::string_view::npos;
+    } else {
+        outRequest.host = std::string(authority.substr(0, portSeparator));
+    }
+
+    outRequest.port = 80;
+    if (portSeparator != std::string_view::npos) {
+        const std::string_view portText = authority.substr(portSeparator + 1);
+        uint64_t port = 0;
+        const bool isValid = StringUtils::ParseUnsigned(portText, port) && port <= UINT16_MAX;
+        if (isValid == false) [[unlikely]] {
+            return false;
+        }
+        outRequest.port = static_cast<Address::port_t>(port);
+    }
+
+    return outRequest.host.empty() == false && outRequest.port != 0;
+}
+
+size_t HttpBatchFetcher::Add(Request request) {
+    LIBPOG_ASSERT(handler == nullptr, "Requests can't be added while running");
+
+    requests.push_back(std::move(request));
+    return requests.size() - 1;
+}
+
+void HttpBatchFetcher::Run(const Handler& handler) {
+    this->handler = &handler;
+    completedCount = 0;
+    attempts.assign(requests.size(), 0);
+
+    Resolve();
+
+    std::vector<Poller::Event> events;
+    while (isStopped == false && completedCount < requests.size()) {
+        Schedule();
+
+        poller.Wait(events, POLL_TIMEOUT_MS);
+        for (const Poller::Event& event : events) {
+            Connection& connection = *static_cast<Connection*>(event.userData);
+            if (connection.isClosed) continue;
+
+            // Errors and hang ups surface from the calls themselves.
+            const bool isWriting = connection.phase == Connection::Phase::Connecting ||
+                                   connection.phase == Connection::Phase::Writing;
+            if (isWriting && (event.events & (Poller::Writable | Poller::Closed))) {
+                OnWritable(connection);
+            } else if (isWriting == false && (event.events & (Poller::Readable | Poller::Closed))) {
+                OnReadable(connection);
+            }
+        }
+
+        const Clock::time_point now = Clock::now();
+        for (const std::unique_ptr<Connection>& connection : connections) {
+            const bool isBusy = connection->isClosed == false && connection->phase != Connection::Phase::Idle;
+            if (isBusy && now >= connection->deadline) {
+                Complete(*connection, Timeout);
+            }
+        }
+
+        connections.erase(
+            std::remove_if(
+                connections.begin(), connections.end(),
+                [](const std::unique_ptr<Connection>& connection) { return connection->isClosed; }
+            ),
+            connections.end()
+        );
+    }
+
+    for (const std::unique_ptr<Connection>& connection : connections) {
+        if (connection->isClosed == false) Close(*connection);
+    }
+    connections.clear();
+    hosts.clear();
+    requests.clear();
+    attempts.clear();
+    nextHost = 0;
+    this->handler = nullptr;
+    isStopped = false;
+}
+
+void HttpBatchFetcher::Resolve() {
+    std::unordered_map<std::string, Host*> hostsByKey;
+
+    for (size_t index = 0; index < requests.size(); ++index) {
+        const Request& request = requests[index];
+        const std::string key = StringUtils::ToLower(request.host) + ":" + std::to_string(request.port);
+
+        auto it = hostsByKey.find(key);
+        if (it == hostsByKey.end()) {
+            const Address address = Address::FromDomain(request.host.c_str(), request.port);
+            Host* host = nullptr;
+            if (address.IsValid()) {
+                hosts.push_back(std::make_unique<Host>());
+                host = hosts.back().get();
+                host->address = address;
+
+                const bool isIPv6 = request.host.find(':') != std::string::npos;
+                host->name = isIPv6 ? "[" + request.host + "]" : request.host;
+                if (request.port != 80) {
+                    host->name += ":" + std::to_string(request.port);
+                }
+            }
+            it = hostsByKey.emplace(key, host).first;
+        }
+
+        if (it->second == nullptr) [[unlikely]] {
+            Deliver(index, InvalidAddress, {}, 0);
+            continue;
+        }
+        it->second->pending.push_back(index);
+    }
+}
+
+void HttpBatchFetcher::Schedule() {
+    if (hosts.empty()) {
+        return;
+    }
+
+    // Every pass gives each waiting host at most one connection, the first host changes every time.
+    bool isProgress = true;
+    while (isProgress && isStopped == false) {
+        isProgress = false;
+
+        for (size_t i = 0; i < hosts.size(); ++i) {
+            Host& host = *hosts[(nextHost + i) % hosts.size()];
+            if (host.pending.empty()) continue;
+
+            Connection* connection = nullptr;
+            if (host.idle.empty() == false) {
+                connection = host.idle.back();
+                host.idle.pop_back();
+            } else {
+                if (host.openCount >= options.maxPerHost) continue;
+                if (openCount >= options.maxConnections && CloseIdleConnection(host) == false) continue;
+
+                Status status = Success;
+                connection = Open(host, status);
+                if (connection == nullptr) [[unlikely]] {
+                    const size_t index = host.pending.front();
+                    host.pending.pop_front();
+                    Deliver(index, status, {}, 0);
+                    isProgress = true;
+                    continue;
+                }
+            }
+
+            const size_t index = host.pending.front();
+            host.pending.pop_front();
+            Assign(*connection, index);
+            isProgress = true;
+        }
+    }
+
+    nextHost = (nextHost + 1) % hosts.size();
+}
+
+HttpBatchFetcher::Connection* HttpBatchFetcher::Open(Host& host, Status& outStatus) {
+    std::unique_ptr<Connection> connection = std::make_unique<Connection>(host);
+    Socket& socket = connection->socket;
+
+    if (socket.Open(host.address.GetFamily(), Protocol::TCP) == false || socket.SetNonBlocking() == false ||
+        socket.Connect(host.address) == false) [[unlikely]] {
+        outStatus = socket.GetStatus() != Success ? socket.GetStatus() : Failed;
+        return nullptr;
+    }
+
+    // Requests are written at once, Nagle would only delay them.
+    socket.Set<SocketOption::NoDelay>(true);
+
+    // Loopback connections may be established right away.
+    connection->phase =
+        (socket.Fail() == InProgress) ? Connection::Phase::Connecting : Connection::Phase::Writing;
+    poller.Add(socket.GetHandle(), Poller::Writable, connection.get());
+
+    ++host.openCount;
+    ++openCount;
+    connections.push_back(std::move(connection));
+    return connections.back().get();
+}
+
+bool HttpBatchFetcher::CloseIdleConnection(const Host& requester) {
+    // Connections are taken from hosts without work or from those having more of them than the requester,
+    // so busy hosts converge to equal shares instead of reconnecting all the time.
+    for (size_t i = 0; i < hosts.size(); ++i) {
+        Host& host = *hosts[(nextHost + i) % hosts.size()];
+        if (&host == &requester || host.idle.empty()) continue;
+
+        if (host.pending.empty() || host.openCount > requester.openCount + 1) {
+            Close(*host.idle.front());
+            return true;
+        }
+    }
+    return false;
+}
+
+void HttpBatchFetcher::Assign(Connection& connection, const size_t index) {
+    const Request& request = requests[index];
+
+    connection.index = index;
+    connection.written = 0;
+    connection.response = HttpResponse();
+    connection.stage = Connection::Stage::Head;
+    connection.isReceived = false;
+    connection.startedAt = Clock::now();
+    connection.deadline = connection.startedAt + std::chrono::milliseconds(options.timeoutMs);
+
+    std::string& output = connection.output;
+    output.clear();
+    output.append(request.method).append(" ").append(request.uri).append(" HTTP/1.1\r\n");
+    output.append("Host: ").append(connection.host.name).append("\r\n");
+    for (const auto& [name, value] : request.headers) {
+        output.append(name).append(": ").append(value).append("\r\n");
+    }
+    const std::string_view method = request.method;
+    if (request.body.empty() == false || method == "POST" || method == "PUT" || method == "PATCH") {
+        output.append("Content-Length: ").append(std::to_string(request.body.size())).append("\r\n");
+    }
+    if (options.keepAlive == false) {
+        output.append("Connection: close\r\n");
+    }
+    output.append("\r\n").append(request.body);
+
+    if (connection.phase == Connection::Phase::Idle) {
+        connection.phase = Connection::Phase::Writing;
+        poller.Modify(connection.socket.GetHandle(), Poller::Writable);
+    }
+}
+
+void HttpBatchFetcher::OnWritable(Connection& connection) {
+    Socket& socket = connection.socket;
+
+    if (connection.phase == Connection::Phase::Connecting) {
+        int error = 0;
+        if (socket.Get<SocketOption::Error>(error) == false || error != 0) [[unlikely]] {
+            Complete(connection, error != 0 ? static_cast<Status>(error) : socket.Fail());
+            return;
+        }
+        connection.phase = Connection::Phase::Writing;
+    }
+
+    while (connection.written < connection.output.size()) {
+        const size_t size = connection.output.size() - connection.written;
+        const uint ret = socket.Send(connection.output.data() + connection.written, static_cast<uint>(size));
+        if (ret == 0) {
+            const Status status = socket.Fail();
+            if (status == TryAgain) return;
+            Complete(connection, status != Success ? status : ConnectionReset);
+            return;
+        }
+        connection.written += ret;
+    }
+
+    connection.phase = Connection::Phase::Reading;
+    poller.Modify(socket.GetHandle(), Poller::Readable);
+}
+
+void HttpBatchFetcher::OnReadable(Connection& connection) {
+    Socket& socket = connection.socket;
+    std::string& input = connection.input;
+
+    bool isClosed = false;
+    while (true) {
+        const size_t oldSize = input.size();
+        input.resize(oldSize + READ_CHUNK_SIZE);
+        const uint ret = socket.Receive(input.data() + oldSize, READ_CHUNK_SIZE);
+        input.resize(oldSize + ret);
+
+        if (ret == 0) {
+            const Status status = socket.Fail();
+            if (status == TryAgain) break;
+            if (status != Success) [[unlikely]] {
+                if (connection.phase == Connection::Phase::Idle) {
+                    Close(connection);
+                } else {
+                    Complete(connection, status);
+                }
+                return;
+            }
+            isClosed = true;
+            break;
+        }
+        connection.isReceived = true;
+    }
+
+    // Idle connection is either closed by the server or got something nobody asked for.
+    if (connection.phase == Connection::Phase::Idle) {
+        if (isClosed || input.empty() == false) {
+            Close(connection);
+        }
+        return;
+    }
+
+    const Status status = Parse(connection, isClosed);
+    if (status == TryAgain) {
+        if (isClosed) [[unlikely]] {
+            Complete(connection, ConnectionReset);
+        }
+        return;
+    }
+    Complete(connection, status);
+}
+
+Status HttpBatchFetcher::Parse(Connection& connection, const bool isClosed) {
+    HttpResponse& response = connection.response;
+    std::string& input = connection.input;
+
+    while (true) {
+        switch (connection.stage) {
+            case Connection::Stage::Head: {
+                const size_t headEnd = input.find("\r\n\r\n");
+                if (headEnd == std::string::npos) {
+                    return TryAgain;
+                }
+                if (response.ParseHead(std::string_view(input.data(), headEnd + 2)) == false) [[unlikely]] {
+                    return Failed;
+                }
+                input.erase(0, headEnd + 4);
+
+                // Interim responses (`100 Continue`) precede the real one.
+                const uint16_t status = response.status;
+                if (status >= 100 && status < 200 && status != 101) {
+                    continue;
+                }
+
+                if (requests[connection.index].method == "HEAD" || status < 200 || status == 204 || status == 304) {
+                    return Success;
+                }
+
+                const std::string_view contentLength = response.GetHeader(HttpHeaderId::ContentLength);
+                if (StringUtils::EqualsIgnoreCase(response.GetHeader(HttpHeaderId::TransferEncoding), "chunked")) {
+                    connection.stage = Connection::Stage::Chunked;
+                } else if (contentLength.empty() == false) {
+                    uint64_t length;
+                    if (StringUtils::ParseUnsigned(contentLength, length) == false) [[unlikely]] {
+                        return Failed;
+                    }
+                    connection.stage = Connection::Stage::Length;
+                    connection.remaining = static_cast<size_t>(length);
+                    response.body.reserve(std::min(connection.remaining, MAX_BODY_RESERVE));
+                } else {
+                    // No length: the body lasts until the server closes the connection.
+                    connection.stage = Connection::Stage::UntilClose;
+                    response.keepAlive = false;
+                }
+                break;
+            }
+
+            case Connection::Stage::Length: {
+                const size_t size = std::min(connection.remaining, input.size());
+                response.body.append(input, 0, size);
+                input.erase(0, size);
+                connection.remaining -= size;
+                return (connection.remaining == 0) ? Success : TryAgain;
+            }
+
+            case Connection::Stage::Chunked: {
+                const size_t lineEnd = input.find("\r\n");
+                if (lineEnd == std::string::npos) {
+                    return TryAgain;
+                }
+
+                uint64_t chunkSize;
+                const std::string_view chunkLine(input.data(), lineEnd);
+                if (HttpResponse::ParseChunkSize(chunkLine, chunkSize) == false) [[unlikely]] {
+                    return Failed;
+                }
+                if (chunkSize == 0) {
+                    // Trailers, if any, end with an empty line.
+                    const size_t trailersEnd = input.find("\r\n\r\n", lineEnd);
+                    if (trailersEnd == std::string::npos) {
+                        return TryAgain;
+                    }
+                    input.erase(0, trailersEnd + 4);
+                    return Success;
+                }
+
+                // Written so a huge size can't overflow.
+                const size_t chunkBegin = lineEnd + 2;
+                if (input.size() - chunkBegin < 2 || input.size() - chunkBegin - 2 < chunkSize) {
+                    return TryAgain;
+                }
+                response.body.append(input, chunkBegin, static_cast<size_t>(chunkSize));
+                input.erase(0, chunkBegin + static_cast<size_t>(chunkSize) + 2);
+                break;
+            }
+
+            case Connection::Stage::UntilClose:
+                response.body.append(input);
+                input.clear();
+                return isClosed ? Success : TryAgain;
+        }
+    }
+}
+
+void HttpBatchFetcher::Complete(Connection& connection, const Status status) {
+    const size_t index = connection.index;
+    const uint64_t elapsedUs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - connection.startedAt).count()
+    );
+
+    if (status != Success) {
+        // Server may close idle keep-alive connection any time, then an idempotent request is repeated once
+        // on a new one. Others may have been processed already.
+        const bool isRetried = connection.responsesCount > 0 && connection.isReceived == false &&
+                               status != Timeout && attempts[index] == 0 &&
+                               HttpClient::IsIdempotent(requests[index].method);
+        Host& host = connection.host;
+        Close(connection);
+
+        if (isRetried) {
+            ++attempts[index];
+            host.pending.push_front(index);
+            return;
+        }
+        Deliver(index, status, std::move(connection.response), elapsedUs);
+        return;
+    }
+
+    ++connection.responsesCount;
+    const bool keepAlive = connection.response.keepAlive;
+    Deliver(index, Success, std::move(connection.response), elapsedUs);
+
+    // Leftovers would belong to nothing, such connection isn't reused.
+    if (options.keepAlive && keepAlive && connection.input.empty() && isStopped == false) {
+        connection.phase = Connection::Phase::Idle;
+        connection.host.idle.push_back(&connection);
+        poller.Modify(connection.socket.GetHandle(), Poller::Readable);
+    } else {
+        Close(connection);
+    }
+}
+
+void HttpBatchFetcher::Deliver(
+    const size_t index,
+    const Status status,
+    HttpResponse&& response,
+    const uint64_t elapsedUs
+) {
+    Result result;
+    result.index = index;
+    result.status = status;
+    result.response = std::move(response);
+    result.elapsedUs = elapsedUs;
+
+    ++completedCount;
+    (*handler)(requests[index], result);
+}
+
+void HttpBatchFetcher::Close(Connection& connection) {
+    if (connection.isClosed) {
+        return;
+    }
+
+    poller.Remove(connection.socket.GetHandle());
+    connection.socket.Close();
+    connection.isClosed = true;
+
+    Host& host = connection.host;
+    const auto it = std::find(host.idle.begin(), host.idle.end(), &connection);
+    if (it != host.idle.end()) {
+        host.idle.erase(it);
+    }
+    --host.openCount;
+    --openCount;
+}
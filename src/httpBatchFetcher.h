@@ -0,0 +1,128 @@
+#ifndef _HTTPBATCHFETCHER_H
+#define _HTTPBATCHFETCHER_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "httpClient.h"
+#include "poller.h"
+#include "socket.h"
+
+namespace Net {
+    /// Fetches a list of HTTP/1.1 requests concurrently from a single thread.
+    ///
+    /// Requests are multiplexed over non-blocking keep-alive connections driven by `Poller`: at most
+    /// `maxConnections` sockets are open at once and at most `maxPerHost` of them to the same host.
+    /// Free slots are handed out to hosts in turns (round-robin), a long list for one host doesn't starve
+    /// the others. Once the global limit is reached, idle connections of hosts without work or with more than
+    /// their share are closed to make room.
+    ///
+    /// Results are passed to the handler as each request completes, in completion order.
+    class HttpBatchFetcher {
+    public:
+        struct Request {
+            /// Domain name or IP address, resolved once per host (blocking) when `Run()` starts.
+            std::string host;
+            Address::port_t port = 80;
+            std::string method = "GET";
+            std::string uri = "/";
+            /// Additional headers, `Host`, `Content-Length` and `Connection` are set automatically.
+            std::vector<std::pair<std::string, std::string>> headers;
+            std::string body;
+        };
+
+        struct Result {
+            /// Position of the request, as returned by `Add()`.
+            size_t index = 0;
+            /// `Success` once the whole response is read, otherwise the failure of resolving, connecting,
+            /// sending or reading, `Timeout` if it didn't complete in time.
+            Status status = Success;
+            HttpResponse response;
+            /// Time from getting a connection to the end of the response.
+            uint64_t elapsedUs = 0;
+        };
+
+        /// Called on the thread of `Run()`, the result may be moved from.
+        typedef std::function<void(const Request& request, Result& result)> Handler;
+
+        struct Options {
+            /// Open sockets limit over all hosts.
+            uint maxConnections = 64;
+            /// Open sockets limit per host (`host:port`).
+            uint maxPerHost = 6;
+            /// Limit of a single request from the moment it gets a connection, including connecting.
+            uint timeoutMs = 30000;
+            /// Reuses connections for further requests of the same host.
+            bool keepAlive = true;
+        };
+
+    private:
+        struct Host;
+        struct Connection;
+
+        Options options;
+        std::vector<Request> requests;
+        // Set by `Stop()` and cleared once the run exits, so a stop requested before the run starts isn't lost.
+        std::atomic<bool> isStopped = false;
+
+        // State of `Run()`.
+        Poller poller;
+        std::vector<std::unique_ptr<Host>> hosts;
+        std::vector<std::unique_ptr<Connection>> connections;
+        std::vector<uint8_t> attempts;
+        size_t nextHost = 0;
+        uint openCount = 0;
+        size_t completedCount = 0;
+        const Handler* handler = nullptr;
+
+        void Resolve();
+        void Schedule();
+        Connection* Open(Host& host, Status& outStatus);
+        bool CloseIdleConnection(const Host& requester);
+        void Assign(Connection& connection, const size_t index);
+
+        void OnWritable(Connection& connection);
+        void OnReadable(Connection& connection);
+        /// Parses what has arrived so far, returns `TryAgain` until the response is complete.
+        Status Parse(Connection& connection, const bool isClosed);
+
+        void Complete(Connection& connection, const Status status);
+        void Deliver(const size_t index, const Status status, HttpResponse&& response, const uint64_t elapsedUs);
+        void Close(Connection& connection);
+
+    public:
+        HttpBatchFetcher();
+        explicit HttpBatchFetcher(const Options& options);
+
+        HttpBatchFetcher(const HttpBatchFetcher&) = delete;
+        ~HttpBatchFetcher();
+
+        /// Splits `http://host[:port][/path]` into `outRequest`, IPv6 addresses go in brackets.
+        /// Returns `false` for other schemes or malformed URLs.
+        static bool ParseUrl(const std::string_view url, Request& outRequest);
+
+        /// Queues the request, returns its index within the batch.
+        size_t Add(Request request);
+        inline size_t Add(const std::string_view host, const Address::port_t port, const std::string_view uri) {
+            Request request;
+            request.host = host;
+            request.port = port;
+            request.uri = uri;
+            return Add(std::move(request));
+        }
+
+        /// Performs all queued requests and returns once every one of them is reported or `Stop()` is called,
+        /// unfinished requests aren't reported then. The queue is empty afterwards.
+        void Run(const Handler& handler);
+        /// Asks `Run()` to exit, can be called from any thread, also before `Run()` starts.
+        inline void Stop() { isStopped = true; }
+
+        inline size_t GetPendingCount() const { return requests.size(); }
+    };
+} // namespace Net
+
+#endif
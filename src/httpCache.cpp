@@ -0,0 +1,723 @@
+#include "httpCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "stringUtils.h"
+#include "utils.h"
+
+using namespace Net;
+
+// Heuristic freshness is capped, so a years old `Last-Modified` doesn't make an entry fresh for months.
+static constexpr int64_t MAX_HEURISTIC_LIFETIME = 24 * 60 * 60;
+
+static constexpr char FILE_MAGIC[4] = {'P', 'O', 'G', 'C'};
+static constexpr uint16_t FILE_VERSION = 1;
+static constexpr std::string_view FILE_EXTENSION = ".entry";
+
+namespace {
+#pragma pack(push, 1)
+    struct FileHeader {
+        char magic[4];
+        uint16_t version;
+        uint16_t status;
+        int64_t storedAt;
+        uint32_t keySize;
+        uint32_t reasonSize;
+        uint32_t headersSize;
+        uint32_t varySize;
+        uint64_t bodySize;
+    };
+#pragma pack(pop)
+
+    /// Read-only view of the whole file, mapped where possible.
+    class MappedFile {
+    private:
+#ifndef _WIN32
+        void* address = MAP_FAILED;
+#else
+        std::string content;
+#endif
+        size_t size = 0;
+
+    public:
+        explicit MappedFile(const std::string& path) {
+#ifndef _WIN32
+            const int handle = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (handle < 0) return;
+
+            struct stat status;
+            if (fstat(handle, &status) == 0 && status.st_size > 0) {
+                size = static_cast<size_t>(status.st_size);
+                address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, handle, 0);
+                if (address == MAP_FAILED) size = 0;
+            }
+            close(handle);
+#else
+            std::ifstream file(path, std::ios::binary);
+            content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            size = content.size();
+#endif
+        }
+
+        ~MappedFile() {
+#ifndef _WIN32
+            if (address != MAP_FAILED) munmap(address, size);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+
+        inline std::string_view GetData() const {
+#ifndef _WIN32
+            return size ? std::string_view(static_cast<const char*>(address), size) : std::string_view();
+#else
+            return content;
+#endif
+        }
+    };
+} // namespace
+
+static std::string_view TrimView(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+    return value;
+}
+
+/// Calls `callback` for every trimmed non-empty element of comma separated list.
+template<typename Callback>
+static void ForEachListElement(std::string_view list, Callback&& callback) {
+    while (list.empty() == false) {
+        const size_t comma = list.find(',');
+        const std::string_view element = TrimView(list.substr(0, comma));
+        if (element.empty() == false) callback(element);
+
+        if (comma == std::string_view::npos) break;
+        list.remove_prefix(comma + 1);
+    }
+}
+
+HttpCache::CacheControl HttpCache::CacheControl::Parse(const std::string_view value) {
+    CacheControl control;
+    ForEachListElement(value, [&control](const std::string_view directive) {
+        const size_t equals = directive.find('=');
+        const std::string_view name = TrimView(directive.substr(0, equals));
+
+        if (StringUtils::EqualsIgnoreCase(name, "no-store")) {
+            control.noStore = true;
+        } else if (StringUtils::EqualsIgnoreCase(name, "no-cache")) {
+            control.noCache = true;
+        } else if (StringUtils::EqualsIgnoreCase(name, "max-age") && equals != std::string_view::npos) {
+            std::string_view argument = TrimView(directive.substr(equals + 1));
+            if (argument.size() >= 2 && argument.front() == '"') argument = argument.substr(1, argument.size() - 2);
+
+            int64_t maxAge = 0;
+            for (const char digit : argument) {
+                if (digit < '0' || digit > '9') return;
+                maxAge = std::min<int64_t>(maxAge * 10 + (digit - '0'), INT32_MAX);
+            }
+            control.maxAge = maxAge;
+        }
+    });
+    return control;
+}
+
+// Multiple `Cache-Control` lines are one comma separated list.
+static HttpCache::CacheControl ParseResponseCacheControl(const HttpHeaders& headers) {
+    HttpCache::CacheControl control;
+    if (headers.Contains(HttpHeaderId::CacheControl) == false) {
+        return control;
+    }
+
+    for (const HttpHeaders::Field header : headers) {
+        if (header.id != HttpHeaderId::CacheControl) continue;
+
+        const HttpCache::CacheControl line = HttpCache::CacheControl::Parse(header.value);
+        control.noStore |= line.noStore;
+        control.noCache |= line.noCache;
+        if (line.maxAge >= 0) {
+            control.maxAge = (control.maxAge >= 0) ? std::min(control.maxAge, line.maxAge) : line.maxAge;
+        }
+    }
+    return control;
+}
+
+static HttpCache::CacheControl FindRequestCacheControl(const std::vector<HttpClient::Header>& headers) {
+    for (const HttpClient::Header& header : headers) {
+        if (StringUtils::EqualsIgnoreCase(header.name, "cache-control")) {
+            return HttpCache::CacheControl::Parse(header.value);
+        }
+    }
+    return {};
+}
+
+static std::string_view FindRequestHeader(const std::vector<HttpClient::Header>& headers, const std::string_view name) {
+    for (const HttpClient::Header& header : headers) {
+        if (StringUtils::EqualsIgnoreCase(header.name, name)) {
+            return header.value;
+        }
+    }
+    return {};
+}
+
+static int64_t ParseSeconds(const std::string_view value) {
+    if (value.empty()) return -1;
+
+    int64_t seconds = 0;
+    for (const char digit : value) {
+        if (digit < '0' || digit > '9') return -1;
+        seconds = std::min<int64_t>(seconds * 10 + (digit - '0'), INT32_MAX);
+    }
+    return seconds;
+}
+
+// Statuses cacheable by default (RFC 9110, section 15.1) minus those we never see from GET.
+static bool IsStorableStatus(const uint16_t status) {
+    switch (status) {
+        case 200:
+        case 203:
+        case 204:
+        case 300:
+        case 301:
+        case 308:
+        case 404:
+        case 410:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static uint64_t HashKey(const std::string_view key) {
+    // FNV-1a, file names only need to be stable between runs.
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : key) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Days since 1970-01-01 of the proleptic gregorian date.
+static int64_t GetDaysFromCivil(int64_t year, const uint month, const uint day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const uint yearOfEra = static_cast<uint>(year - era * 400);
+    const uint dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const uint dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+}
+
+static constexpr std::string_view MONTHS[] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+static constexpr std::string_view WEEKDAYS[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+
+int64_t HttpCache::Entry::GetFreshnessLifetime() const {
+    const CacheControl control = ParseResponseCacheControl(headers);
+    if (control.noCache) {
+        return 0;
+    }
+    if (control.maxAge >= 0) {
+        return control.maxAge;
+    }
+
+    const int64_t date = ParseDate(GetHeader(HttpHeaderId::Date));
+    const int64_t base = (date >= 0) ? date : storedAt;
+
+    const std::string_view expires = GetHeader(HttpHeaderId::Expires);
+    if (expires.empty() == false) {
+        // Invalid dates like `0` mean "already expired".
+        const int64_t expiresTime = ParseDate(expires);
+        return std::max<int64_t>(0, expiresTime - base);
+    }
+
+    const int64_t lastModified = ParseDate(GetHeader(HttpHeaderId::LastModified));
+    if (lastModified >= 0 && lastModified < base) {
+        return std::min((base - lastModified) / 10, MAX_HEURISTIC_LIFETIME);
+    }
+
+    return 0;
+}
+
+bool HttpCache::Entry::IsFresh(const int64_t now) const {
+    return now - storedAt < GetFreshnessLifetime();
+}
+
+size_t HttpCache::Entry::GetSize() const {
+    size_t size = sizeof(Entry) + reason.size() + body.size() + headers.GetMemorySize();
+    for (const auto& [name, value] : vary) {
+        size += name.size() + value.size() + 64;
+    }
+    return size;
+}
+
+HttpCache::HttpCache() : HttpCache(Options()) {}
+
+HttpCache::HttpCache(const Options& options) : options(options) {
+    if (this->options.directory.empty() == false) {
+        ScanDirectory();
+    }
+}
+
+std::string HttpCache::MakeKey(const std::string_view host, const std::string_view uri) {
+    std::string key;
+    key.reserve(host.size() + uri.size());
+    key.append(host).append(uri);
+    return key;
+}
+
+int64_t HttpCache::GetTime() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+int64_t HttpCache::ParseDate(const std::string_view date) {
+    // `Sun, 06 Nov 1994 08:49:37 GMT`
+    if (date.size() != 29 || date[3] != ',' || date.substr(26) != "GMT") {
+        return -1;
+    }
+
+    const auto number = [date](const size_t offset, const size_t size) -> int {
+        int value = 0;
+        for (size_t i = offset; i < offset + size; ++i) {
+            if (date[i] < '0' || date[i] > '9') return -1;
+            value = value * 10 + (date[i] - '0');
+        }
+        return value;
+    };
+
+    const auto monthIt = std::find(std::begin(MONTHS), std::end(MONTHS), date.substr(8, 3));
+    const int day = number(5, 2);
+    const int year = number(12, 4);
+    const int hours = number(17, 2);
+    const int minutes = number(20, 2);
+    const int seconds = number(23, 2);
+    if (monthIt == std::end(MONTHS) || day < 1 || day > 31 || year < 0 || hours < 0 || hours > 23 || minutes < 0 ||
+        minutes > 59 || seconds < 0 || seconds > 60) {
+        return -1;
+    }
+
+    const uint month = static_cast<uint>(monthIt - std::begin(MONTHS)) + 1;
+    return GetDaysFromCivil(year, month, static_cast<uint>(day)) * 86400 + hours * 3600 + minutes * 60 + seconds;
+}
+
+std::string HttpCache::FormatDate(const int64_t time) {
+    const int64_t days = (time >= 0 ? time : time - 86399) / 86400;
+    const int64_t secondsOfDay = time - days * 86400;
+
+    // Inverse of `GetDaysFromCivil()`.
+    const int64_t shifted = days + 719468;
+    const int64_t era = (shifted >= 0 ? shifted : shifted - 146096) / 146097;
+    const uint dayOfEra = static_cast<uint>(shifted - era * 146097);
+    const uint yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const uint dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const uint monthIndex = (5 * dayOfYear + 2) / 153;
+    const uint day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    const uint month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    const int64_t year = static_cast<int64_t>(yearOfEra) + era * 400 + (month <= 2);
+
+    char text[64];
+    std::snprintf(text, sizeof(text), "%s, %02u %s %04lld %02lld:%02lld:%02lld GMT",
+                  WEEKDAYS[((days % 7) + 11) % 7].data(), day, MONTHS[month - 1].data(),
+                  static_cast<long long>(year), static_cast<long long>(secondsOfDay / 3600),
+                  static_cast<long long>(secondsOfDay / 60 % 60), static_cast<long long>(secondsOfDay % 60));
+    return text;
+}
+
+void HttpCache::InsertToMemory(const std::string_view key, std::shared_ptr<const Entry> entry) {
+    RemoveFromMemory(key);
+
+    const size_t size = entry->GetSize() + key.size();
+    // Still reachable through the disk tier if there is one.
+    if (size > options.memoryLimit) {
+        return;
+    }
+
+    memoryLru.push_front({std::string(key), std::move(entry), size});
+    memoryIndex.emplace(memoryLru.front().key, memoryLru.begin());
+    memorySize += size;
+
+    while (memorySize > options.memoryLimit) {
+        const MemoryNode& node = memoryLru.back();
+        memorySize -= node.size;
+        memoryIndex.erase(node.key);
+        memoryLru.pop_back();
+        ++stats.evictions;
+    }
+}
+
+void HttpCache::RemoveFromMemory(const std::string_view key) {
+    const auto it = memoryIndex.find(key);
+    if (it == memoryIndex.end()) {
+        return;
+    }
+
+    const auto node = it->second;
+    memorySize -= node->size;
+    memoryIndex.erase(it);
+    memoryLru.erase(node);
+}
+
+std::string HttpCache::GetFilePath(const uint64_t hash) const {
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+    return options.directory + "/" + name + std::string(FILE_EXTENSION);
+}
+
+void HttpCache::ScanDirectory() {
+    namespace fs = std::filesystem;
+
+    std::error_code error;
+    fs::create_directories(options.directory, error);
+    if (error) [[unlikely]] {
+        Utils::Error("Failed to create cache directory: ", error.message());
+        options.directory.clear();
+        return;
+    }
+
+    // Entries of the previous runs, the least recently written are evicted first.
+    std::vector<std::pair<fs::file_time_type, DiskNode>> files;
+    for (const fs::directory_entry& file : fs::directory_iterator(options.directory, error)) {
+        const fs::path& path = file.path();
+        if (path.extension() != FILE_EXTENSION || path.stem().string().size() != 16) continue;
+
+        const uint64_t hash = std::strtoull(path.stem().string().c_str(), nullptr, 16);
+        files.push_back({file.last_write_time(error), {hash, static_cast<size_t>(file.file_size(error))}});
+    }
+
+    std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (const auto& [time, node] : files) {
+        diskLru.push_front(node);
+        diskIndex[node.hash] = diskLru.begin();
+        diskSize += node.size;
+    }
+
+    while (diskSize > options.diskLimit && diskLru.empty() == false) {
+        RemoveFromDisk(diskLru.back().hash);
+    }
+}
+
+std::string
+HttpCache::WriteTemporaryFile(const std::string_view key, const Entry& entry, size_t& outSize) {
+    std::string headers;
+    for (const HttpHeaders::Field header : entry.headers) {
+        headers.append(header.name).append(": ").append(header.value).append("\n");
+    }
+    std::string vary;
+    for (const auto& [name, value] : entry.vary) {
+        vary.append(name).append(": ").append(value).append("\n");
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.status = entry.status;
+    header.storedAt = entry.storedAt;
+    header.keySize = static_cast<uint32_t>(key.size());
+    header.reasonSize = static_cast<uint32_t>(entry.reason.size());
+    header.headersSize = static_cast<uint32_t>(headers.size());
+    header.varySize = static_cast<uint32_t>(vary.size());
+    header.bodySize = entry.body.size();
+
+    outSize = sizeof(header) + key.size() + entry.reason.size() + headers.size() + vary.size() + entry.body.size();
+    if (outSize > options.diskLimit) {
+        return {};
+    }
+
+    // Written aside and renamed by `CommitToDisk()`, readers never see a partial entry.
+    const std::string temporaryPath = GetFilePath(HashKey(key)) + "." + std::to_string(++writesCount) + ".tmp";
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(key.data(), key.size());
+    file.write(entry.reason.data(), entry.reason.size());
+    file.write(headers.data(), headers.size());
+    file.write(vary.data(), vary.size());
+    file.write(entry.body.data(), entry.body.size());
+    file.close();
+    if (file.fail()) [[unlikely]] {
+        Utils::Error("Failed to write cache entry: ", temporaryPath);
+        std::remove(temporaryPath.c_str());
+        return {};
+    }
+
+    return temporaryPath;
+}
+
+void HttpCache::CommitToDisk(const uint64_t hash, const std::string& temporaryPath, const size_t size) {
+    RemoveFromDisk(hash);
+    if (temporaryPath.empty()) {
+        return;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, GetFilePath(hash), error);
+    if (error) [[unlikely]] {
+        Utils::Error("Failed to write cache entry: ", error.message());
+        std::remove(temporaryPath.c_str());
+        return;
+    }
+
+    diskLru.push_front({hash, size});
+    diskIndex[hash] = diskLru.begin();
+    diskSize += size;
+
+    while (diskSize > options.diskLimit) {
+        RemoveFromDisk(diskLru.back().hash);
+        ++stats.evictions;
+    }
+}
+
+std::shared_ptr<const HttpCache::Entry> HttpCache::ReadFromDisk(const std::string_view key) {
+    const uint64_t hash = HashKey(key);
+    const auto it = diskIndex.find(hash);
+    if (it == diskIndex.end()) {
+        return nullptr;
+    }
+
+    const MappedFile file(GetFilePath(hash));
+    std::string_view data = file.GetData();
+
+    FileHeader header;
+    if (data.size() < sizeof(header)) [[unlikely]] {
+        RemoveFromDisk(hash);
+        return nullptr;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    data.remove_prefix(sizeof(header));
+
+    const uint64_t payloadSize = static_cast<uint64_t>(header.keySize) + header.reasonSize + header.headersSize +
+                                 header.varySize + header.bodySize;
+    if (std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || header.version != FILE_VERSION ||
+        payloadSize != data.size()) [[unlikely]] {
+        RemoveFromDisk(hash);
+        return nullptr;
+    }
+
+    // Another key with the same hash, it's going to be overwritten by the caller.
+    if (data.substr(0, header.keySize) != key) [[unlikely]] {
+        return nullptr;
+    }
+    data.remove_prefix(header.keySize);
+
+    auto entry = std::make_shared<Entry>();
+    entry->status = header.status;
+    entry->storedAt = header.storedAt;
+    entry->reason.assign(data.substr(0, header.reasonSize));
+    data.remove_prefix(header.reasonSize);
+
+    const auto parseLines = [](std::string_view lines, auto&& callback) {
+        while (lines.empty() == false) {
+            const size_t end = lines.find('\n');
+            const std::string_view line = lines.substr(0, end);
+            const size_t colon = line.find(": ");
+            if (colon != std::string_view::npos) callback(line.substr(0, colon), line.substr(colon + 2));
+
+            if (end == std::string_view::npos) break;
+            lines.remove_prefix(end + 1);
+        }
+    };
+
+    entry->headers.Parse(data.substr(0, header.headersSize));
+    data.remove_prefix(header.headersSize);
+
+    parseLines(data.substr(0, header.varySize), [&entry](const std::string_view name, const std::string_view value) {
+        entry->vary.emplace_back(name, value);
+    });
+    data.remove_prefix(header.varySize);
+
+    entry->body.assign(data.substr(0, header.bodySize));
+
+    diskLru.splice(diskLru.begin(), diskLru, it->second);
+    return entry;
+}
+
+void HttpCache::RemoveFromDisk(const uint64_t hash) {
+    const auto it = diskIndex.find(hash);
+    if (it == diskIndex.end()) {
+        return;
+    }
+
+    std::remove(GetFilePath(hash).c_str());
+    diskSize -= it->second->size;
+    diskLru.erase(it->second);
+    diskIndex.erase(it);
+}
+
+std::shared_ptr<const HttpCache::Entry>
+HttpCache::Find(const std::string_view key, const std::vector<HttpClient::Header>& requestHeaders) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::shared_ptr<const Entry> entry;
+
+    const auto it = memoryIndex.find(key);
+    if (it != memoryIndex.end()) {
+        memoryLru.splice(memoryLru.begin(), memoryLru, it->second);
+        entry = it->second->entry;
+        ++stats.memoryHits;
+    } else if (options.directory.empty() == false && (entry = ReadFromDisk(key)) != nullptr) {
+        InsertToMemory(key, entry);
+        ++stats.diskHits;
+    } else {
+        ++stats.misses;
+        return nullptr;
+    }
+
+    // Selecting headers of the stored request must match the new one.
+    for (const auto& [name, value] : entry->vary) {
+        if (FindRequestHeader(requestHeaders, name) != value) {
+            return nullptr;
+        }
+    }
+
+    return entry;
+}
+
+bool HttpCache::Store(
+    const std::string_view key,
+    const HttpResponse& response,
+    const std::vector<HttpClient::Header>& requestHeaders
+) {
+    const CacheControl control = ParseResponseCacheControl(response.headers);
+    const std::string_view varyHeader = response.GetHeader(HttpHeaderId::Vary);
+
+    bool isStorable = IsStorableStatus(response.status) && control.noStore == false &&
+                      FindRequestCacheControl(requestHeaders).noStore == false && TrimView(varyHeader) != "*";
+
+    auto entry = std::make_shared<Entry>();
+    if (isStorable) {
+        entry->status = response.status;
+        entry->reason = response.reason;
+        entry->headers = response.headers;
+        entry->body = response.body;
+
+        const int64_t age = ParseSeconds(response.GetHeader(HttpHeaderId::Age));
+        entry->storedAt = GetTime() - std::max<int64_t>(age, 0);
+
+        ForEachListElement(varyHeader, [&](const std::string_view name) {
+            entry->vary.emplace_back(StringUtils::ToLower(name), FindRequestHeader(requestHeaders, name));
+        });
+
+        // Neither fresh nor revalidatable, keeping it would only waste space.
+        isStorable = entry->GetFreshnessLifetime() > 0 || entry->GetHeader(HttpHeaderId::ETag).empty() == false ||
+                     entry->GetHeader(HttpHeaderId::LastModified).empty() == false;
+    }
+
+    // The file is written before locking, only the rename and the index update block other users.
+    std::string temporaryPath;
+    size_t fileSize = 0;
+    if (isStorable && options.directory.empty() == false) {
+        temporaryPath = WriteTemporaryFile(key, *entry, fileSize);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (isStorable == false) {
+        RemoveFromMemory(key);
+        if (options.directory.empty() == false) RemoveFromDisk(HashKey(key));
+        return false;
+    }
+
+    if (options.directory.empty() == false) CommitToDisk(HashKey(key), temporaryPath, fileSize);
+    InsertToMemory(key, std::move(entry));
+    ++stats.stores;
+    return true;
+}
+
+std::shared_ptr<const HttpCache::Entry>
+HttpCache::Refresh(const std::string_view key, const HttpResponse& notModified) {
+    std::shared_ptr<const Entry> oldEntry;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        const auto it = memoryIndex.find(key);
+        if (it != memoryIndex.end()) {
+            oldEntry = it->second->entry;
+        } else if (options.directory.empty() == false) {
+            oldEntry = ReadFromDisk(key);
+        }
+    }
+    if (oldEntry == nullptr) {
+        return nullptr;
+    }
+
+    // Entries are shared with readers, so the update goes into a copy.
+    auto entry = std::make_shared<Entry>(*oldEntry);
+
+    // Framing headers describe the 304 itself, the rest replaces stored fields of the same name.
+    const auto isFraming = [](const HttpHeaderId id) {
+        return id == HttpHeaderId::ContentLength || id == HttpHeaderId::TransferEncoding ||
+               id == HttpHeaderId::Connection || id == HttpHeaderId::KeepAlive;
+    };
+    HttpHeaders headers;
+    for (const HttpHeaders::Field header : oldEntry->headers) {
+        if (isFraming(header.id) || notModified.headers.Contains(header.name) == false) {
+            headers.Add(header.name, header.value);
+        }
+    }
+    for (const HttpHeaders::Field header : notModified.headers) {
+        if (isFraming(header.id) == false) {
+            headers.Add(header.name, header.value);
+        }
+    }
+    entry->headers = std::move(headers);
+
+    const int64_t age = ParseSeconds(notModified.GetHeader(HttpHeaderId::Age));
+    entry->storedAt = GetTime() - std::max<int64_t>(age, 0);
+
+    std::string temporaryPath;
+    size_t fileSize = 0;
+    if (options.directory.empty() == false) {
+        temporaryPath = WriteTemporaryFile(key, *entry, fileSize);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (options.directory.empty() == false) CommitToDisk(HashKey(key), temporaryPath, fileSize);
+    InsertToMemory(key, entry);
+    ++stats.revalidations;
+    return entry;
+}
+
+void HttpCache::Remove(const std::string_view key) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    RemoveFromMemory(key);
+    if (options.directory.empty() == false) RemoveFromDisk(HashKey(key));
+}
+
+void HttpCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    memoryIndex.clear();
+    memoryLru.clear();
+    memorySize = 0;
+
+    while (diskLru.empty() == false) {
+        RemoveFromDisk(diskLru.back().hash);
+    }
+}
+
+HttpCache::Stats HttpCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+size_t HttpCache::GetMemorySize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return memorySize;
+}
+
+size_t HttpCache::GetEntriesCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return memoryLru.size();
+}
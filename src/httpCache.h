@@ -0,0 +1,154 @@
+#ifndef _HTTPCACHE_H
+#define _HTTPCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "httpClient.h"
+
+namespace Net {
+    /// Private (single user) HTTP cache for `HttpClient::Request()`, see `HttpClient::SetCache()`.
+    /// Responses to `GET` are stored by host and URI according to `Cache-Control`, `Expires` and `Vary`.
+    /// Fresh entries are served without touching the network, stale ones are revalidated with
+    /// `If-None-Match`/`If-Modified-Since` and refreshed in place by `304 Not Modified`.
+    ///
+    /// Entries live in a memory LRU bounded by `Options::memoryLimit`. With `Options::directory` set,
+    /// every stored entry is also written to its own file there and memory misses are read back
+    /// through `mmap`, the directory is bounded by `Options::diskLimit` and survives restarts.
+    ///
+    /// Thread-safe, one cache can be shared by many clients.
+    class HttpCache {
+    public:
+        struct Options {
+            size_t memoryLimit = 32 * 1024 * 1024;
+            /// Empty disables the disk tier.
+            std::string directory;
+            size_t diskLimit = 256 * 1024 * 1024;
+        };
+
+        /// Directives of `Cache-Control` the cache acts on, of either request or response.
+        struct CacheControl {
+            bool noStore = false;
+            bool noCache = false;
+            int64_t maxAge = -1;
+
+            static CacheControl Parse(const std::string_view value);
+        };
+
+        struct Entry {
+            uint16_t status = 0;
+            std::string reason;
+            HttpHeaders headers;
+            std::string body;
+
+            /// Unix seconds the response was generated at, `Age` already subtracted.
+            int64_t storedAt = 0;
+            /// Lowercased names and values as sent of the request headers listed in `Vary`.
+            std::vector<std::pair<std::string, std::string>> vary;
+
+            inline std::string_view GetHeader(const std::string_view name) const { return headers.Get(name); }
+            inline std::string_view GetHeader(const HttpHeaderId id) const { return headers.Get(id); }
+            /// Seconds the entry stays fresh after `storedAt`.
+            int64_t GetFreshnessLifetime() const;
+            bool IsFresh(const int64_t now) const;
+
+            size_t GetSize() const;
+        };
+
+        struct Stats {
+            uint64_t memoryHits = 0;
+            uint64_t diskHits = 0;
+            uint64_t misses = 0;
+            uint64_t stores = 0;
+            uint64_t revalidations = 0;
+            uint64_t evictions = 0;
+        };
+
+    private:
+        struct MemoryNode {
+            std::string key;
+            std::shared_ptr<const Entry> entry;
+            size_t size;
+        };
+
+        struct DiskNode {
+            uint64_t hash;
+            size_t size;
+        };
+
+        Options options;
+        mutable std::mutex mutex;
+
+        // Front is the most recently used.
+        std::list<MemoryNode> memoryLru;
+        std::unordered_map<std::string_view, std::list<MemoryNode>::iterator> memoryIndex;
+        size_t memorySize = 0;
+
+        std::list<DiskNode> diskLru;
+        std::unordered_map<uint64_t, std::list<DiskNode>::iterator> diskIndex;
+        size_t diskSize = 0;
+        // Makes temporary file names unique, entries are written outside of `mutex`.
+        std::atomic<uint64_t> writesCount = 0;
+
+        Stats stats;
+
+        void InsertToMemory(const std::string_view key, std::shared_ptr<const Entry> entry);
+        void RemoveFromMemory(const std::string_view key);
+
+        void ScanDirectory();
+        std::string GetFilePath(const uint64_t hash) const;
+        /// Serializes the entry into a new temporary file without locking.
+        /// Returns its path, empty if it wasn't written or doesn't fit `Options::diskLimit`.
+        std::string WriteTemporaryFile(const std::string_view key, const Entry& entry, size_t& outSize);
+        /// Puts the written file in place of the entry's one, an empty path only removes that.
+        /// Must be called with `mutex` locked.
+        void CommitToDisk(const uint64_t hash, const std::string& temporaryPath, const size_t size);
+        std::shared_ptr<const Entry> ReadFromDisk(const std::string_view key);
+        void RemoveFromDisk(const uint64_t hash);
+
+    public:
+        HttpCache();
+        explicit HttpCache(const Options& options);
+
+        HttpCache(const HttpCache&) = delete;
+
+        static std::string MakeKey(const std::string_view host, const std::string_view uri);
+        /// Returns current time in unix seconds, the clock all entry times are measured with.
+        static int64_t GetTime();
+        /// Parses IMF-fixdate (`Sun, 06 Nov 1994 08:49:37 GMT`), returns `-1` if invalid.
+        static int64_t ParseDate(const std::string_view date);
+        static std::string FormatDate(const int64_t time);
+
+        /// Returns the entry if its `Vary` headers match `requestHeaders`, `nullptr` otherwise.
+        std::shared_ptr<const Entry>
+        Find(const std::string_view key, const std::vector<HttpClient::Header>& requestHeaders = {});
+
+        /// Stores the response if it's cacheable, drops the old entry of the key otherwise.
+        /// Returns `true` if the response was stored.
+        bool Store(
+            const std::string_view key,
+            const HttpResponse& response,
+            const std::vector<HttpClient::Header>& requestHeaders = {}
+        );
+
+        /// Updates the entry with the headers of `304 Not Modified` and makes it fresh again.
+        /// Returns the updated entry, `nullptr` if there is no entry for the key.
+        std::shared_ptr<const Entry> Refresh(const std::string_view key, const HttpResponse& notModified);
+
+        void Remove(const std::string_view key);
+        /// Removes all entries from memory and disk.
+        void Clear();
+
+        Stats GetStats() const;
+        size_t GetMemorySize() const;
+        size_t GetEntriesCount() const;
+    };
+} // namespace Net
+
+#endif
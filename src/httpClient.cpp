@@ -1,8 +1,10 @@
 #include "httpClient.h"
 
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 
+#include "httpCache.h"
 #include "stringUtils.h"
 
 #if _MSC_VER && !__INTEL_COMPILER
@@ -11,39 +13,525 @@
 
 using namespace Net;
 
+static constexpr size_t READ_CHUNK_SIZE = 16384;
+
 Status HttpClient::Connect(const char* hostAddressStr) {
+    return Connect(hostAddressStr, HTTP_PORT);
+}
+
+Status HttpClient::Connect(const char* hostAddressStr, const Address::port_t port) {
     this->hostAddress = StringUtils::ToLower(StringUtils::Trim(hostAddressStr));
 
-    const Address hostIpAddress = Address::FromDomain(hostAddress.c_str(), HTTP_PORT);
+    const Address hostIpAddress = Address::FromDomain(hostAddress.c_str(), port);
     if (hostIpAddress.IsValid() == false) [[unlikely]] {
         return InvalidAddress;
     }
 
+    if (port != HTTP_PORT) {
+        hostAddress += ":" + std::to_string(port);
+    }
+
+    remoteAddress = hostIpAddress;
+    if (Reconnect() == false) [[unlikely]] {
+        const Status status = socket.GetStatus();
+        socket.Close();
+        return status;
+    }
+
     return Success;
 }
 
+bool HttpClient::Reconnect() {
+    socket.Close();
+    input.clear();
+    responsesCount = 0;
+
+    if (socket.Open(remoteAddress.GetFamily(), Protocol::TCP) == false ||
+        socket.Connect(remoteAddress) == false) [[unlikely]] {
+        return false;
+    }
+
+    // Requests are written at once, Nagle would only delay them.
+    socket.Set<SocketOption::NoDelay>(true);
+    return true;
+}
+
 std::string
 HttpClient::SendHttpRequest(const std::string_view method, const std::string_view uri, const std::string_view version) {
     response.clear();
     request.clear();
     request = CreateRequest(method.data(), uri.data(), version.data());
 
-    socket.Send(request);
+    socket.Send(request.data(), request.size());
     do {
-        buffer.size = socket.Receive(buffer, buffer.MAX_SIZE - 1);
+        buffer.size = socket.Receive(buffer, buffer.MAX_SIZE);
         if (socket.GetStatus() != Success) {
             return response;
         }
-        response.assign(buffer);
+        response.append(buffer, buffer.size);
     } while (buffer.size > 0);
 
     return response;
 }
 
+bool HttpResponse::ParseHead(const std::string_view head) {
+    // Status line: `HTTP/x.y SP code SP reason`.
+    const size_t lineEnd = head.find("\r\n");
+    const std::string_view statusLine = head.substr(0, lineEnd);
+    if (statusLine.size() < 12 || statusLine.substr(0, 5) != "HTTP/" || statusLine[8] != ' ') [[unlikely]] {
+        return false;
+    }
+
+    uint64_t code;
+    if (StringUtils::ParseUnsigned(statusLine.substr(9, 3), code) == false ||
+        (statusLine.size() > 12 && statusLine[12] != ' ')) [[unlikely]] {
+        return false;
+    }
+    status = static_cast<uint16_t>(code);
+    reason.assign(statusLine.substr(std::min<size_t>(13, statusLine.size())));
+    keepAlive = statusLine.substr(5, 3) != "1.0";
+
+    if (lineEnd == std::string_view::npos) {
+        headers.Clear();
+    } else {
+        headers.Parse(head.substr(lineEnd + 2));
+    }
+
+    const std::string_view connection = headers.Get(HttpHeaderId::Connection);
+    if (StringUtils::EqualsIgnoreCase(connection, "close")) {
+        keepAlive = false;
+    } else if (StringUtils::EqualsIgnoreCase(connection, "keep-alive")) {
+        keepAlive = true;
+    }
+    return true;
+}
+
+bool HttpResponse::ParseChunkSize(std::string_view line, uint64_t& outSize) {
+    line = line.substr(0, line.find(';'));
+    while (line.empty() == false && (line.back() == ' ' || line.back() == '\t')) line.remove_suffix(1);
+
+    return StringUtils::ParseUnsigned(line, outSize, 16);
+}
+
+bool HttpClient::IsIdempotent(const std::string_view method) {
+    return method == "GET" || method == "HEAD" || method == "PUT" || method == "DELETE" || method == "OPTIONS" ||
+           method == "TRACE";
+}
+
+Status HttpClient::Request(
+    const std::string_view method,
+    const std::string_view uri,
+    HttpResponse& outResponse,
+    const std::string_view body,
+    const std::vector<Header>& headers
+) {
+    outResponse.isFromCache = false;
+    if (cache == nullptr) {
+        return Exchange(method, uri, outResponse, body, headers);
+    }
+
+    if (method == "GET") {
+        return CachedGet(uri, outResponse, headers);
+    }
+
+    const Status status = Exchange(method, uri, outResponse, body, headers);
+    // Stored response is outdated once the resource is changed (RFC 9111, section 4.4).
+    const bool isSafe = method == "HEAD" || method == "OPTIONS" || method == "TRACE";
+    if (status == Success && isSafe == false && outResponse.status < 400) {
+        cache->Remove(HttpCache::MakeKey(hostAddress, uri));
+    }
+    return status;
+}
+
+Status HttpClient::RequestInto(
+    const std::string_view method,
+    const std::string_view uri,
+    char* destination,
+    const size_t capacity,
+    size_t& outReceived,
+    HttpResponse& outResponse,
+    const std::vector<Header>& headers,
+    const ReceiveHandler& onReceived
+) {
+    BodyTarget target;
+    target.data = destination;
+    target.capacity = capacity;
+    target.onReceived = onReceived ? &onReceived : nullptr;
+
+    outResponse.isFromCache = false;
+    const Status status = Exchange(method, uri, outResponse, {}, headers, &target);
+    outReceived = target.received;
+    if (status != Success || outResponse.status < 200 || outResponse.status >= 300 || outResponse.body.empty()) {
+        return status;
+    }
+
+    // Framings without the length known upfront end up in the body first.
+    if (outResponse.body.size() > capacity) [[unlikely]] {
+        return Failed;
+    }
+    std::memcpy(destination, outResponse.body.data(), outResponse.body.size());
+    target.Store(outResponse.body.size());
+    outReceived = target.received;
+    outResponse.body.clear();
+    return Success;
+}
+
+void HttpClient::BodyTarget::Store(const size_t size) {
+    received += size;
+    if (onReceived != nullptr) {
+        (*onReceived)(size);
+    }
+}
+
+Status
+HttpClient::CachedGet(const std::string_view uri, HttpResponse& outResponse, const std::vector<Header>& headers) {
+    HttpCache::CacheControl control;
+    for (const Header& header : headers) {
+        if (StringUtils::EqualsIgnoreCase(header.name, "cache-control")) {
+            control = HttpCache::CacheControl::Parse(header.value);
+        }
+    }
+
+    if (control.noStore) {
+        return Exchange("GET", uri, outResponse, {}, headers);
+    }
+
+    const std::string key = HttpCache::MakeKey(hostAddress, uri);
+    std::shared_ptr<const HttpCache::Entry> entry = cache->Find(key, headers);
+
+    const auto fillFromEntry = [&outResponse](const HttpCache::Entry& entry) {
+        outResponse.status = entry.status;
+        outResponse.reason = entry.reason;
+        outResponse.headers = entry.headers;
+        outResponse.body = entry.body;
+        outResponse.isFromCache = true;
+    };
+
+    const bool isRevalidationForced = control.noCache || control.maxAge == 0;
+    if (entry != nullptr && isRevalidationForced == false && entry->IsFresh(HttpCache::GetTime())) {
+        fillFromEntry(*entry);
+        outResponse.keepAlive = true;
+        return Success;
+    }
+
+    // Stale or forced: ask the server whether the stored body is still good.
+    std::vector<Header> conditionalHeaders = headers;
+    if (entry != nullptr) {
+        const std::string_view etag = entry->GetHeader(HttpHeaderId::ETag);
+        const std::string_view lastModified = entry->GetHeader(HttpHeaderId::LastModified);
+        if (etag.empty() == false) conditionalHeaders.push_back({"If-None-Match", etag});
+        if (lastModified.empty() == false) conditionalHeaders.push_back({"If-Modified-Since", lastModified});
+    }
+
+    const Status status = Exchange("GET", uri, outResponse, {}, conditionalHeaders);
+    if (status != Success) {
+        return status;
+    }
+
+    if (entry != nullptr && outResponse.status == 304) {
+        entry = cache->Refresh(key, outResponse);
+        if (entry != nullptr) {
+            fillFromEntry(*entry);
+            return Success;
+        }
+
+        // Entry was removed or evicted meanwhile (the cache may be shared), the 304 has no body to give.
+        const Status retryStatus = Exchange("GET", uri, outResponse, {}, headers);
+        if (retryStatus != Success) [[unlikely]] {
+            return retryStatus;
+        }
+    }
+
+    cache->Store(key, outResponse, headers);
+    return Success;
+}
+
+Status HttpClient::Exchange(
+    const std::string_view method,
+    const std::string_view uri,
+    HttpResponse& outResponse,
+    const std::string_view body,
+    const std::vector<Header>& headers,
+    BodyTarget* target
+) {
+    request.clear();
+    request.append(method).append(" ").append(uri).append(" HTTP/1.1\r\n");
+    request.append("Host: ").append(hostAddress).append("\r\n");
+    for (const Header& header : headers) {
+        request.append(header.name).append(": ").append(header.value).append("\r\n");
+    }
+    if (body.empty() == false || method == "POST" || method == "PUT" || method == "PATCH") {
+        request.append("Content-Length: ").append(std::to_string(body.size())).append("\r\n");
+    }
+    request.append("\r\n");
+
+    const bool isHead = method == "HEAD";
+    const IoBuffer buffers[2] = {MakeIoBuffer(request.data(), request.size()), MakeIoBuffer(body.data(), body.size())};
+    const size_t totalSize = request.size() + body.size();
+
+    // Server may close idle keep-alive connection any time, then an idempotent request is repeated once on a new one.
+    // Others may have been processed already, the caller decides.
+    const bool isIdempotent = IsIdempotent(method);
+    for (uint attempt = 0; attempt < 2; ++attempt) {
+        if (socket.IsConnected() == false && Reconnect() == false) [[unlikely]] {
+            const Status status = socket.GetStatus();
+            socket.Close();
+            return status;
+        }
+
+        const bool isReused = responsesCount > 0;
+
+        size_t sent = socket.SendGather(buffers, body.empty() ? 1 : 2);
+        while (sent > 0 && sent < totalSize) {
+            const uint ret = (sent < request.size())
+                                 ? socket.Send(request.data() + sent, request.size() - sent)
+                                 : socket.Send(body.data() + sent - request.size(), totalSize - sent);
+            if (ret == 0) break;
+            sent += ret;
+        }
+
+        bool isReceived = false;
+        const Status status =
+            (sent == totalSize) ? ReadResponse(isHead, outResponse, isReceived, target) : ConnectionReset;
+        if (status == Success) {
+            ++responsesCount;
+            if (outResponse.keepAlive == false) {
+                socket.Close();
+            }
+            return Success;
+        }
+
+        socket.Close();
+        if (isReused == false || isReceived || isIdempotent == false) {
+            return status;
+        }
+    }
+
+    return ConnectionReset;
+}
+
+bool HttpClient::ReadMore() {
+    const size_t oldSize = input.size();
+    input.resize(oldSize + READ_CHUNK_SIZE);
+
+    const uint received = socket.Receive(input.data() + oldSize, READ_CHUNK_SIZE);
+    input.resize(oldSize + received);
+
+    return received > 0;
+}
+
+Status
+HttpClient::ReadResponse(const bool isHead, HttpResponse& outResponse, bool& outIsReceived, BodyTarget* target) {
+    outIsReceived = input.empty() == false;
+
+    size_t headEnd;
+    while (true) {
+        while ((headEnd = input.find("\r\n\r\n")) == std::string::npos) {
+            if (ReadMore() == false) [[unlikely]] {
+                return ConnectionReset;
+            }
+            outIsReceived = true;
+        }
+
+        if (outResponse.ParseHead(std::string_view(input.data(), headEnd + 2)) == false) [[unlikely]] {
+            return Failed;
+        }
+        outResponse.body.clear();
+
+        input.erase(0, headEnd + 4);
+
+        // Interim responses (`100 Continue`) precede the real one.
+        if (outResponse.status < 100 || outResponse.status >= 200 || outResponse.status == 101) {
+            break;
+        }
+    }
+
+    const uint16_t status = outResponse.status;
+    if (isHead || status < 200 || status == 204 || status == 304) {
+        return Success;
+    }
+
+    std::string& body = outResponse.body;
+
+    if (StringUtils::EqualsIgnoreCase(outResponse.GetHeader(HttpHeaderId::TransferEncoding), "chunked")) {
+        while (true) {
+            size_t lineEnd;
+            while ((lineEnd = input.find("\r\n")) == std::string::npos) {
+                if (ReadMore() == false) [[unlikely]] return ConnectionReset;
+            }
+
+            uint64_t chunkSize;
+            const std::string_view chunkLine(input.data(), lineEnd);
+            if (HttpResponse::ParseChunkSize(chunkLine, chunkSize) == false) [[unlikely]] {
+                return Failed;
+            }
+            if (chunkSize == 0) {
+                // Trailers, if any, end with an empty line.
+                size_t trailersEnd;
+                while ((trailersEnd = input.find("\r\n\r\n", lineEnd)) == std::string::npos) {
+                    if (ReadMore() == false) [[unlikely]] return ConnectionReset;
+                }
+                input.erase(0, trailersEnd + 4);
+                return Success;
+            }
+
+            // Chunk and its CRLF are buffered whole, written so a huge size can't overflow.
+            const size_t chunkBegin = lineEnd + 2;
+            while (input.size() - chunkBegin < 2 || input.size() - chunkBegin - 2 < chunkSize) {
+                if (ReadMore() == false) [[unlikely]] return ConnectionReset;
+            }
+
+            body.append(input, chunkBegin, static_cast<size_t>(chunkSize));
+            input.erase(0, chunkBegin + static_cast<size_t>(chunkSize) + 2);
+        }
+    }
+
+    const std::string_view contentLength = outResponse.GetHeader(HttpHeaderId::ContentLength);
+    if (contentLength.empty() == false) {
+        uint64_t size;
+        if (StringUtils::ParseUnsigned(contentLength, size) == false) [[unlikely]] {
+            return Failed;
+        }
+
+        if (target != nullptr && status < 300) {
+            if (size > target->capacity) [[unlikely]] {
+                return Failed;
+            }
+
+            const size_t buffered = std::min(size, input.size());
+            std::memcpy(target->data, input.data(), buffered);
+            input.erase(0, buffered);
+            if (buffered > 0) target->Store(buffered);
+
+            while (target->received < size) {
+                const size_t left = std::min<size_t>(size - target->received, UINT32_MAX);
+                const uint ret = socket.Receive(target->data + target->received, static_cast<uint>(left));
+                if (ret == 0) [[unlikely]] {
+                    return ConnectionReset;
+                }
+                target->Store(ret);
+            }
+            return Success;
+        }
+
+        const size_t buffered = static_cast<size_t>(std::min<uint64_t>(size, input.size()));
+        body.assign(input, 0, buffered);
+        input.erase(0, buffered);
+
+        // The rest goes straight into the body. It grows with the data received, never by the declared
+        // length alone, so a bogus `Content-Length` costs no more memory than the data actually sent.
+        for (size_t received = buffered; received < size;) {
+            if (received == body.size()) {
+                const uint64_t growth = std::max<uint64_t>(received, READ_CHUNK_SIZE);
+                body.resize(received + static_cast<size_t>(std::min(size - received, growth)));
+            }
+
+            const size_t left = std::min<size_t>(body.size() - received, UINT32_MAX);
+            const uint ret = socket.Receive(body.data() + received, static_cast<uint>(left));
+            if (ret == 0) [[unlikely]] {
+                body.resize(received);
+                return ConnectionReset;
+            }
+            received += ret;
+        }
+        return Success;
+    }
+
+    // No length: the body lasts until the server closes the connection.
+    body.swap(input);
+    input.clear();
+    while (true) {
+        const size_t oldSize = body.size();
+        body.resize(oldSize + READ_CHUNK_SIZE);
+
+        const uint ret = socket.Receive(body.data() + oldSize, READ_CHUNK_SIZE);
+        body.resize(oldSize + ret);
+        if (ret == 0) break;
+    }
+    outResponse.keepAlive = false;
+    return Success;
+}
+
 std::string HttpClient::CreateRequest(std::string method, const std::string_view uri, const std::string_view version) {
     return request = ((method = StringUtils::ToUpper(StringUtils::Trim(method))) == "GET")
-                         ? method + " " + StringUtils::Trim(uri) + "/ HTTP/" + StringUtils::Trim(version) + "\r\n" +
+                         ? method + " " + StringUtils::Trim(uri) + " HTTP/" + StringUtils::Trim(version) + "\r\n" +
                                "Host:" + hostAddress + "\r\n" + "Connection: close\r\n\r\n"
-                         : method + " " + StringUtils::Trim(uri) + "/ HTTP/" + StringUtils::Trim(version) + "\r\n" +
+                         : method + " " + StringUtils::Trim(uri) + " HTTP/" + StringUtils::Trim(version) + "\r\n" +
                                "Host:" + hostAddress + "\r\nConnection: close\r\n" + "Content-Type: text/html\r\n\r\n";
-}
\ No newline at end of file
+}
+
+Status HttpClient::UpgradeToWebSocket(
+    const std::string_view uri,
+    WebSocket& outWebSocket,
+    const WebSocket::Options& options
+) {
+    const std::string key = WebSocket::MakeKey();
+    const bool isDeflateOffered = options.usePerMessageDeflate && WebSocket::IsDeflateSupported();
+
+    request.clear();
+    request.append("GET ").append(StringUtils::Trim(uri)).append(" HTTP/1.1\r\n");
+    request.append("Host: ").append(hostAddress).append("\r\n");
+    request.append("Upgrade: websocket\r\nConnection: Upgrade\r\n");
+    request.append("Sec-WebSocket-Key: ").append(key).append("\r\n");
+    request.append("Sec-WebSocket-Version: 13\r\n");
+    if (isDeflateOffered) {
+        request.append("Sec-WebSocket-Extensions: ").append(WebSocket::DEFLATE_EXTENSION);
+        request.append("; client_max_window_bits\r\n");
+    }
+    request.append("\r\n");
+
+    if (socket.Send(request.data(), request.size()) != request.size()) [[unlikely]] {
+        return socket.GetStatus();
+    }
+
+    // Frames may follow the response immediately, so everything after the head is kept.
+    response.clear();
+    size_t headEnd = std::string::npos;
+    while ((headEnd = response.find("\r\n\r\n")) == std::string::npos) {
+        buffer.size = socket.Receive(buffer, buffer.MAX_SIZE);
+        if (buffer.size == 0) [[unlikely]] {
+            return socket.GetStatus() != Success ? socket.GetStatus() : ConnectionReset;
+        }
+        response.append(buffer, buffer.size);
+    }
+
+    const std::string_view head(response.data(), headEnd + 2);
+    if (head.substr(0, 13) != "HTTP/1.1 101 ") [[unlikely]] {
+        return ConnectionRefused;
+    }
+
+    bool isAccepted = false;
+    WebSocket::Deflate deflate;
+    for (size_t lineBegin = head.find("\r\n") + 2; lineBegin < head.size();) {
+        const size_t lineEnd = head.find("\r\n", lineBegin);
+        const std::string_view line = head.substr(lineBegin, lineEnd - lineBegin);
+        lineBegin = lineEnd + 2;
+
+        const size_t colon = line.find(':');
+        if (colon == std::string_view::npos) continue;
+
+        const std::string_view name = line.substr(0, colon);
+        std::string_view value = line.substr(colon + 1);
+        while (!value.empty() && value.front() == ' ') value.remove_prefix(1);
+
+        if (StringUtils::EqualsIgnoreCase(name, "Sec-WebSocket-Accept")) {
+            isAccepted = value == WebSocket::MakeAcceptKey(key);
+        } else if (StringUtils::EqualsIgnoreCase(name, "Sec-WebSocket-Extensions")) {
+            // Server can't enable extension which wasn't offered.
+            if (isDeflateOffered == false || WebSocket::ParseDeflate(value, deflate) == false) [[unlikely]] {
+                return ConnectionRefused;
+            }
+        }
+    }
+
+    if (isAccepted == false) [[unlikely]] {
+        return ConnectionRefused;
+    }
+
+    outWebSocket = WebSocket(
+        std::move(socket), WebSocket::Role::Client, std::string_view(response).substr(headEnd + 4), deflate, options
+    );
+    response.clear();
+
+    return Success;
+}
@@ -1,24 +1,94 @@
 #ifndef _HTTPCLIENT_H
 #define _HTTPCLIENT_H
 
+#include <functional>
 #include <string>
+#include <vector>
 
 #include "dataBuffer.h"
+#include "httpHeaders.h"
 #include "socket.h"
+#include "webSocket.h"
 
 namespace Net {
+    /// Response read by `HttpClient::Request()`.
+    struct HttpResponse {
+        uint16_t status = 0;
+        std::string reason;
+        HttpHeaders headers;
+        std::string body;
+        bool keepAlive = true;
+        /// Served by `HttpCache`, either fresh or revalidated with `304 Not Modified`.
+        bool isFromCache = false;
+
+        /// Returns the first value of the header, empty if there is none. Case-insensitive.
+        inline std::string_view GetHeader(const std::string_view name) const { return headers.Get(name); }
+        inline std::string_view GetHeader(const HttpHeaderId id) const { return headers.Get(id); }
+
+        /// Parses the status line and headers, `head` ends with the last header line (without the empty one).
+        /// `keepAlive` follows the version and `Connection` header. Returns `false` if the status line is malformed.
+        bool ParseHead(const std::string_view head);
+        /// Parses the size of `chunked` body chunk from its line (without CRLF), extensions are ignored.
+        /// Returns `false` if it's not a hex number.
+        static bool ParseChunkSize(const std::string_view line, uint64_t& outSize);
+    };
+
+    class HttpCache;
+
     class HttpClient {
+    public:
+        struct Header {
+            std::string_view name;
+            std::string_view value;
+        };
+
+        /// Called with the size of every piece of the body stored by `RequestInto()`.
+        typedef std::function<void(const size_t size)> ReceiveHandler;
+
     private:
+        /// Caller memory the body of `RequestInto()` goes to.
+        struct BodyTarget {
+            char* data = nullptr;
+            size_t capacity = 0;
+            size_t received = 0;
+            const ReceiveHandler* onReceived = nullptr;
+
+            void Store(const size_t size);
+        };
+
         Socket socket;
+        Address remoteAddress;
 
         std::string hostAddress;
         std::string request;
         std::string response;
 
+        // Received bytes not consumed by the previous response.
+        std::string input;
+        uint responsesCount = 0;
+
+        HttpCache* cache = nullptr;
+
         DataBuffer buffer = {};
 
         void Proccess();
 
+        bool Reconnect();
+        bool ReadMore();
+        /// Reads and parses the response to the sent request.
+        /// `outIsReceived` tells if any byte arrived, a reused connection may be closed by server meanwhile.
+        Status ReadResponse(const bool isHead, HttpResponse& outResponse, bool& outIsReceived, BodyTarget* target);
+        /// Performs the request on the connection, bypassing the cache.
+        Status Exchange(
+            const std::string_view method,
+            const std::string_view uri,
+            HttpResponse& outResponse,
+            const std::string_view body,
+            const std::vector<Header>& headers,
+            BodyTarget* target = nullptr
+        );
+        Status CachedGet(const std::string_view uri, HttpResponse& outResponse, const std::vector<Header>& headers);
+
     protected:
         std::string CreateRequest(std::string method, const std::string_view uri, const std::string_view version);
 
@@ -30,12 +100,63 @@ namespace Net {
         virtual ~HttpClient() { HttpClient::Disconnect(); }
 
         Status Connect(const char* hostAddressString);
-        inline void Disconnect() { socket.Close(); };
+        Status Connect(const char* hostAddressString, const Address::port_t port);
+        inline void Disconnect() {
+            socket.Close();
+            input.clear();
+        };
 
         std::string
         SendHttpRequest(const std::string_view method, const std::string_view uri, const std::string_view version);
 
+        /// Tells if repeating the request has the same effect as sending it once (RFC 9110, section 9.2.2).
+        /// Only such requests are resent when a reused connection dies before the response.
+        static bool IsIdempotent(const std::string_view method);
+
+        /// Sends HTTP/1.1 request and reads the whole response (`Content-Length`, chunked or until close).
+        /// The connection is kept alive between requests and reopened if the server has closed it.
+        /// - `headers`: additional request headers, `Host` and `Content-Length` are set automatically.
+        ///
+        /// With the cache set, `GET` responses go through it and successful unsafe methods invalidate the URI.
+        Status Request(
+            const std::string_view method,
+            const std::string_view uri,
+            HttpResponse& outResponse,
+            const std::string_view body = {},
+            const std::vector<Header>& headers = {}
+        );
+
+        /// Same as `Request()` but a successful (2xx) body is stored into `destination` instead of `outResponse.body`,
+        /// e.g. into a memory-mapped file. `Content-Length` bodies are received there directly without a copy,
+        /// chunked ones are copied once complete. Fails if the body doesn't fit into `capacity`.
+        /// - `outReceived`: bytes stored, valid on failure too, so an interrupted range can be resumed.
+        /// - `onReceived`: progress, called as the pieces arrive.
+        ///
+        /// The cache isn't used.
+        Status RequestInto(
+            const std::string_view method,
+            const std::string_view uri,
+            char* destination,
+            const size_t capacity,
+            size_t& outReceived,
+            HttpResponse& outResponse,
+            const std::vector<Header>& headers = {},
+            const ReceiveHandler& onReceived = {}
+        );
+
+        /// Performs WebSocket opening handshake for `uri` on the connected socket and hands the socket
+        /// over to `outWebSocket`, the client has to be connected again before the next request.
+        Status UpgradeToWebSocket(
+            const std::string_view uri,
+            WebSocket& outWebSocket,
+            const WebSocket::Options& options = {}
+        );
+
+        /// Uses `cache` for `Request()`, `nullptr` disables caching. The cache must outlive the client.
+        inline void SetCache(HttpCache* cache) { this->cache = cache; }
+
         inline Socket::State GetState() { return socket.GetState(); }
+        inline bool IsConnected() const { return socket.IsConnected(); }
     };
 } // namespace Net
 
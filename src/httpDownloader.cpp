@@ -0,0 +1,415 @@
+#include "httpDownloader.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "httpClient.h"
+#include "stringUtils.h"
+
+using namespace Net;
+
+namespace {
+    /// Output of the known size, preallocated and mapped for writing (kept in memory and written at once on windows).
+    class OutputFile {
+    private:
+        std::string path;
+        size_t size = 0;
+#ifndef _WIN32
+        int handle = -1;
+        void* address = MAP_FAILED;
+#else
+        std::vector<char> content;
+#endif
+
+    public:
+        OutputFile() = default;
+        ~OutputFile() { Close(); }
+
+        OutputFile(const OutputFile&) = delete;
+
+        Status Open(const std::string& filePath, const size_t fileSize) {
+            path = filePath;
+            size = fileSize;
+#ifndef _WIN32
+            handle = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (handle < 0) [[unlikely]] {
+                return static_cast<Status>(errno);
+            }
+            if (size == 0) {
+                return Success;
+            }
+
+            // Blocks are reserved upfront, running out of space while writing the mapping would be `SIGBUS`.
+#ifdef __linux__
+            const int error = posix_fallocate(handle, 0, static_cast<off_t>(size));
+            if (error != 0 && error != EOPNOTSUPP && error != EINVAL) [[unlikely]] {
+                return static_cast<Status>(error);
+            }
+#endif
+            if (ftruncate(handle, static_cast<off_t>(size)) != 0) [[unlikely]] {
+                return static_cast<Status>(errno);
+            }
+
+            address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, handle, 0);
+            if (address == MAP_FAILED) [[unlikely]] {
+                return static_cast<Status>(errno);
+            }
+#else
+            content.resize(size);
+#endif
+            return Success;
+        }
+
+        inline char* GetData() {
+#ifndef _WIN32
+            return (address != MAP_FAILED) ? static_cast<char*>(address) : nullptr;
+#else
+            return content.data();
+#endif
+        }
+
+        /// Flushes and closes the file, returns `false` if it couldn't be written.
+        bool Close() {
+            bool isWritten = true;
+#ifndef _WIN32
+            if (address != MAP_FAILED) {
+                munmap(address, size);
+                address = MAP_FAILED;
+            }
+            if (handle >= 0) {
+                isWritten = close(handle) == 0;
+                handle = -1;
+            }
+#else
+            if (path.empty() == false) {
+                std::ofstream file(path, std::ios::binary | std::ios::trunc);
+                file.write(content.data(), static_cast<std::streamsize>(content.size()));
+                isWritten = file.good();
+                content.clear();
+            }
+#endif
+            path.clear();
+            return isWritten;
+        }
+    };
+} // namespace
+
+/// State shared by the workers of a single `Download()`.
+class HttpDownloader::Transfer {
+private:
+    struct Segment {
+        uint64_t begin = 0;
+        uint64_t end = 0;
+        /// Bytes already written from `begin`, a retry asks only for the rest.
+        uint64_t received = 0;
+        uint attempts = 0;
+    };
+
+    const HttpDownloader& downloader;
+    const std::string host;
+    const Address::port_t port;
+    const std::string uri;
+    const std::string etag;
+    const bool isRanged;
+    const uint64_t totalSize;
+    char* data;
+
+    std::vector<Segment> segments;
+    std::deque<size_t> queue;
+    uint segmentsDone = 0;
+
+    std::atomic<uint64_t> received = 0;
+    std::atomic<uint> retries = 0;
+
+    Status Fetch(HttpClient& client, bool& isConnected, Segment& segment);
+
+public:
+    std::mutex mutex;
+    std::condition_variable changed;
+    Status status = Success;
+
+    Transfer(
+        const HttpDownloader& downloader,
+        const std::string_view host,
+        const Address::port_t port,
+        const std::string_view uri,
+        const std::string_view etag,
+        const bool isRanged,
+        char* data,
+        const uint64_t size
+    )
+        : downloader(downloader), host(host), port(port), uri(uri), etag(etag), isRanged(isRanged), totalSize(size),
+          data(data) {
+        const uint64_t segmentSize = isRanged ? std::max<uint64_t>(downloader.options.segmentSize, 1) : size;
+        for (uint64_t begin = 0; begin < size; begin += segmentSize) {
+            Segment segment;
+            segment.begin = begin;
+            segment.end = std::min(begin + segmentSize, size);
+            queue.push_back(segments.size());
+            segments.push_back(segment);
+        }
+    }
+
+    inline size_t GetSegmentsCount() const { return segments.size(); }
+
+    /// Must be called with `mutex` locked.
+    inline bool IsFinished() const {
+        return segmentsDone == segments.size() || status != Success || downloader.isStopped;
+    }
+
+    /// Must be called with `mutex` locked.
+    Progress GetProgress() const {
+        Progress progress;
+        progress.received = received;
+        progress.total = segments.empty() ? 0 : segments.back().end;
+        progress.segmentsDone = segmentsDone;
+        progress.segmentsCount = static_cast<uint>(segments.size());
+        progress.retries = retries;
+        return progress;
+    }
+
+    /// Takes segments from the queue until all are done or the transfer fails.
+    void Work();
+};
+
+void HttpDownloader::Transfer::Work() {
+    static constexpr auto WAIT_INTERVAL = std::chrono::milliseconds(100);
+
+    HttpClient client;
+    bool isConnected = false;
+
+    while (true) {
+        size_t index;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            // Segments in flight elsewhere may still come back for a retry.
+            while (queue.empty() && IsFinished() == false) {
+                changed.wait_for(lock, WAIT_INTERVAL);
+            }
+            if (IsFinished()) {
+                return;
+            }
+            index = queue.front();
+            queue.pop_front();
+        }
+
+        Segment& segment = segments[index];
+        if (segment.attempts > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(downloader.options.retryDelayMs * segment.attempts));
+        }
+
+        const Status result = Fetch(client, isConnected, segment);
+        {
+            const std::lock_guard<std::mutex> lock(mutex);
+            if (result == Success) {
+                ++segmentsDone;
+            } else if (++segment.attempts > downloader.options.maxRetries) {
+                if (status == Success) status = result;
+            } else {
+                ++retries;
+                queue.push_back(index);
+            }
+        }
+        changed.notify_all();
+    }
+}
+
+Status HttpDownloader::Transfer::Fetch(HttpClient& client, bool& isConnected, Segment& segment) {
+    // Once connected the client reopens the connection by itself.
+    if (isConnected == false) {
+        const Status status = client.Connect(host.c_str(), port);
+        if (status != Success) [[unlikely]] {
+            return status;
+        }
+        isConnected = true;
+    }
+
+    // Whole body comes again without ranges.
+    if (isRanged == false && segment.received > 0) {
+        received -= segment.received;
+        segment.received = 0;
+    }
+
+    const uint64_t offset = segment.begin + segment.received;
+    const std::string range = "bytes=" + std::to_string(offset) + "-" + std::to_string(segment.end - 1);
+
+    std::vector<HttpClient::Header> headers;
+    if (isRanged) {
+        headers.push_back({"Range", range});
+        // Changed resource is sent whole with `200` instead of mixing two versions.
+        if (etag.empty() == false) headers.push_back({"If-Range", etag});
+    }
+
+    size_t stored = 0;
+    HttpResponse response;
+    const Status status = client.RequestInto(
+        "GET", uri, data + offset, static_cast<size_t>(segment.end - offset), stored, response, headers,
+        [this](const size_t size) { received += size; }
+    );
+    segment.received += stored;
+    if (status != Success) [[unlikely]] {
+        return status;
+    }
+
+    if (response.status != (isRanged ? 206 : 200)) [[unlikely]] {
+        return Failed;
+    }
+    if (isRanged) {
+        // `Content-Range: bytes first-last/size`, the size guards against a changed resource when there is no
+        // entity tag for `If-Range`.
+        const std::string_view contentRange = response.GetHeader(HttpHeaderId::ContentRange);
+        const size_t dash = contentRange.find('-');
+        const size_t slash = contentRange.find('/');
+        if (contentRange.substr(0, 6) != "bytes " || dash == std::string_view::npos || slash < dash) [[unlikely]] {
+            return Failed;
+        }
+
+        uint64_t first;
+        uint64_t last;
+        uint64_t size;
+        const bool isParsed = StringUtils::ParseUnsigned(contentRange.substr(6, dash - 6), first) &&
+                              StringUtils::ParseUnsigned(contentRange.substr(dash + 1, slash - dash - 1), last) &&
+                              StringUtils::ParseUnsigned(contentRange.substr(slash + 1), size);
+        if (isParsed == false || first != offset || last != segment.end - 1 || size != totalSize) [[unlikely]] {
+            return Failed;
+        }
+    }
+
+    return (segment.received == segment.end - segment.begin) ? Success : ConnectionReset;
+}
+
+Status HttpDownloader::Download(
+    const std::string_view host,
+    const Address::port_t port,
+    const std::string_view uri,
+    const std::string& path
+) {
+    const std::string hostString(host);
+
+    HttpClient probe;
+    HttpResponse head;
+    Status status = probe.Connect(hostString.c_str(), port);
+    if (status == Success) {
+        status = probe.Request("HEAD", uri, head);
+    }
+    if (status == Success && head.status != 200) [[unlikely]] {
+        status = Failed;
+    }
+
+    uint64_t size = 0;
+    const std::string_view contentLength = head.GetHeader(HttpHeaderId::ContentLength);
+    if (status == Success && contentLength.empty() == false &&
+        StringUtils::ParseUnsigned(contentLength, size) == false) [[unlikely]] {
+        status = Failed;
+    }
+
+    // Unknown size can't be preallocated, the body is taken in one go then.
+    if (status == Success && contentLength.empty()) {
+        HttpResponse response;
+        status = probe.Request("GET", uri, response);
+        if (status == Success && response.status != 200) [[unlikely]] {
+            status = Failed;
+        }
+
+        if (status == Success) {
+            OutputFile file;
+            status = file.Open(path, response.body.size());
+            if (status == Success && response.body.empty() == false) {
+                std::memcpy(file.GetData(), response.body.data(), response.body.size());
+            }
+            if (file.Close() == false && status == Success) [[unlikely]] {
+                status = Failed;
+            }
+            if (status != Success) [[unlikely]] {
+                std::remove(path.c_str());
+            }
+        }
+
+        if (progressHandler && status == Success) {
+            Progress progress;
+            progress.received = progress.total = response.body.size();
+            progress.segmentsDone = progress.segmentsCount = 1;
+            progressHandler(progress);
+        }
+    }
+    probe.Disconnect();
+
+    if (status != Success || contentLength.empty()) {
+        isStopped = false;
+        return status;
+    }
+
+    const bool isRanged = StringUtils::EqualsIgnoreCase(head.GetHeader(HttpHeaderId::AcceptRanges), "bytes");
+
+    OutputFile file;
+    status = file.Open(path, static_cast<size_t>(size));
+    if (status != Success) [[unlikely]] {
+        file.Close();
+        std::remove(path.c_str());
+        isStopped = false;
+        return status;
+    }
+
+    Transfer transfer(*this, host, port, uri, head.GetHeader(HttpHeaderId::ETag), isRanged, file.GetData(), size);
+
+    const size_t workersCount = std::min<size_t>(std::max(options.connections, 1u), transfer.GetSegmentsCount());
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < workersCount; ++i) {
+        workers.emplace_back([&transfer]() { transfer.Work(); });
+    }
+
+    // Progress is reported from here, handlers never run on the workers.
+    Progress progress;
+    {
+        std::unique_lock<std::mutex> lock(transfer.mutex);
+        const auto interval = std::chrono::milliseconds(options.progressIntervalMs);
+        while (transfer.changed.wait_for(lock, interval, [&transfer]() { return transfer.IsFinished(); }) == false) {
+            progress = transfer.GetProgress();
+            if (progressHandler) {
+                lock.unlock();
+                progressHandler(progress);
+                lock.lock();
+            }
+        }
+    }
+
+    transfer.changed.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    progress = transfer.GetProgress();
+    status = transfer.status;
+    if (status == Success && progress.segmentsDone != progress.segmentsCount) {
+        // Stopped.
+        status = Failed;
+    }
+    if (progressHandler) {
+        progressHandler(progress);
+    }
+
+    if (file.Close() == false && status == Success) [[unlikely]] {
+        status = Failed;
+    }
+    if (status != Success) {
+        std::remove(path.c_str());
+    }
+
+    isStopped = false;
+    return status;
+}
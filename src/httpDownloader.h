@@ -0,0 +1,78 @@
+#ifndef _HTTPDOWNLOADER_H
+#define _HTTPDOWNLOADER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "socket.h"
+
+namespace Net {
+    /// Downloads a single large resource over several connections at once.
+    ///
+    /// `HEAD` tells the size and whether the server accepts byte ranges. The content is then split into
+    /// segments which `connections` threads fetch with `Range` requests, each into its own `HttpClient`.
+    /// Bodies are received straight into the output file, preallocated and memory-mapped, at their offsets.
+    /// A failed segment is retried on its own, from the first byte it's missing, up to `maxRetries` times.
+    ///
+    /// Servers without range support (or without `Content-Length`) are downloaded with a single plain `GET`.
+    class HttpDownloader {
+    public:
+        struct Options {
+            /// Connections (and threads) fetching segments concurrently.
+            uint connections = 4;
+            /// Range size, smaller segments spread better over uneven connections.
+            uint64_t segmentSize = 8 * 1024 * 1024;
+            /// Attempts per segment after the first one.
+            uint maxRetries = 3;
+            /// Wait before the retry, multiplied by the attempt number.
+            uint retryDelayMs = 100;
+            /// Interval of the progress handler calls.
+            uint progressIntervalMs = 200;
+        };
+
+        struct Progress {
+            uint64_t received = 0;
+            /// Content size, `0` if unknown.
+            uint64_t total = 0;
+            uint segmentsDone = 0;
+            uint segmentsCount = 0;
+            /// Retried segments so far.
+            uint retries = 0;
+        };
+
+        /// Called on the thread of `Download()` every `progressIntervalMs` and once at the end.
+        typedef std::function<void(const Progress& progress)> ProgressHandler;
+
+    private:
+        class Transfer;
+
+        Options options;
+        ProgressHandler progressHandler;
+        // Set by `Stop()` and cleared once the download exits, so a stop requested before it starts isn't lost.
+        std::atomic<bool> isStopped = false;
+
+    public:
+        HttpDownloader() = default;
+        explicit HttpDownloader(const Options& options) : options(options) {}
+
+        HttpDownloader(const HttpDownloader&) = delete;
+
+        inline void SetProgressHandler(ProgressHandler handler) { progressHandler = std::move(handler); }
+
+        /// Downloads `uri` from `host:port` into the file at `path`, replacing it. Partial file is removed on failure.
+        /// Returns `Success` once every byte is written, otherwise the status of the segment out of retries,
+        /// `Failed` for unexpected responses or if `Stop()` was called (segments in flight are finished first).
+        Status Download(
+            const std::string_view host,
+            const Address::port_t port,
+            const std::string_view uri,
+            const std::string& path
+        );
+        /// Asks `Download()` to give up, can be called from any thread, also before `Download()` starts.
+        inline void Stop() { isStopped = true; }
+    };
+} // namespace Net
+
+#endif
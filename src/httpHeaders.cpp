@@ -0,0 +1,97 @@
+#include "httpHeaders.h"
+
+using namespace Net;
+
+// Sanity checks of the generated table, evaluated by the compiler.
+static_assert(HttpHeaders::GetId("content-length") == HttpHeaderId::ContentLength);
+static_assert(HttpHeaders::GetId("TRANSFER-ENCODING") == HttpHeaderId::TransferEncoding);
+static_assert(HttpHeaders::GetId("X-Content-Length") == HttpHeaderId::Unknown);
+
+static inline bool IsWhitespace(const char c) {
+    return c == ' ' || c == '\t';
+}
+
+void HttpHeaders::Parse(const std::string_view lines) {
+    buffer.assign(lines);
+    spans.clear();
+    firstIndices.fill(NOT_FOUND);
+
+    for (size_t lineBegin = 0; lineBegin < buffer.size();) {
+        size_t next = buffer.find('\n', lineBegin);
+        if (next == std::string::npos) next = buffer.size();
+
+        const size_t lineEnd = (next > lineBegin && buffer[next - 1] == '\r') ? next - 1 : next;
+        Index(lineBegin, lineEnd);
+        lineBegin = next + 1;
+    }
+}
+
+void HttpHeaders::Add(const std::string_view name, const std::string_view value) {
+    const size_t lineBegin = buffer.size();
+    buffer.append(name).append(": ").append(value);
+    const size_t lineEnd = buffer.size();
+    buffer.append("\r\n");
+
+    Index(lineBegin, lineEnd);
+}
+
+void HttpHeaders::Clear() {
+    buffer.clear();
+    spans.clear();
+    firstIndices.fill(NOT_FOUND);
+}
+
+void HttpHeaders::Index(const size_t lineBegin, const size_t lineEnd) {
+    const std::string_view line(buffer.data() + lineBegin, lineEnd - lineBegin);
+    const size_t colon = line.find(':');
+    if (colon == std::string_view::npos || colon == 0 || colon > UINT16_MAX) [[unlikely]] {
+        return;
+    }
+
+    size_t valueBegin = colon + 1;
+    size_t valueEnd = line.size();
+    while (valueBegin < valueEnd && IsWhitespace(line[valueBegin])) ++valueBegin;
+    while (valueEnd > valueBegin && IsWhitespace(line[valueEnd - 1])) --valueEnd;
+
+    Span span;
+    span.nameOffset = static_cast<uint32_t>(lineBegin);
+    span.nameSize = static_cast<uint16_t>(colon);
+    span.valueOffset = static_cast<uint32_t>(lineBegin + valueBegin);
+    span.valueSize = static_cast<uint32_t>(valueEnd - valueBegin);
+    span.id = GetId(line.substr(0, colon));
+
+    if (span.id != HttpHeaderId::Unknown && spans.size() < NOT_FOUND) {
+        uint16_t& first = firstIndices[static_cast<size_t>(span.id)];
+        if (first == NOT_FOUND) first = static_cast<uint16_t>(spans.size());
+    }
+    spans.push_back(span);
+}
+
+std::string_view HttpHeaders::Get(const std::string_view name) const {
+    const HttpHeaderId id = GetId(name);
+    if (id != HttpHeaderId::Unknown) {
+        return Get(id);
+    }
+
+    for (const Span& span : spans) {
+        const Field field = ToField(span);
+        if (Detail::EqualsIgnoreCase(field.name, name)) {
+            return field.value;
+        }
+    }
+    return {};
+}
+
+bool HttpHeaders::Contains(const std::string_view name) const {
+    const HttpHeaderId id = GetId(name);
+    if (id != HttpHeaderId::Unknown) {
+        return Contains(id);
+    }
+
+    for (const Span& span : spans) {
+        if (Detail::EqualsIgnoreCase(ToField(span).name, name)) {
+            return true;
+        }
+    }
+    return false;
+}
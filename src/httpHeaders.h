@@ -0,0 +1,222 @@
+#ifndef _HTTPHEADERS_H
+#define _HTTPHEADERS_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Net {
+    /// Header names `HttpHeaders` indexes, looking them up takes no string comparisons beyond one.
+    enum class HttpHeaderId : uint8_t {
+        AcceptRanges,
+        Age,
+        CacheControl,
+        Connection,
+        ContentEncoding,
+        ContentLength,
+        ContentRange,
+        ContentType,
+        Date,
+        ETag,
+        Expires,
+        KeepAlive,
+        LastModified,
+        Location,
+        Pragma,
+        SecWebSocketAccept,
+        SecWebSocketExtensions,
+        Server,
+        SetCookie,
+        TransferEncoding,
+        Upgrade,
+        Vary,
+        Count,
+        Unknown = Count,
+    };
+
+    namespace Detail {
+        /// Canonical spelling, in the order of `HttpHeaderId`.
+        inline constexpr std::string_view HTTP_HEADER_NAMES[] = {
+            "Accept-Ranges",
+            "Age",
+            "Cache-Control",
+            "Connection",
+            "Content-Encoding",
+            "Content-Length",
+            "Content-Range",
+            "Content-Type",
+            "Date",
+            "ETag",
+            "Expires",
+            "Keep-Alive",
+            "Last-Modified",
+            "Location",
+            "Pragma",
+            "Sec-WebSocket-Accept",
+            "Sec-WebSocket-Extensions",
+            "Server",
+            "Set-Cookie",
+            "Transfer-Encoding",
+            "Upgrade",
+            "Vary",
+        };
+        static_assert(std::size(HTTP_HEADER_NAMES) == static_cast<size_t>(HttpHeaderId::Count));
+
+        inline constexpr uint32_t HTTP_HEADER_TABLE_SIZE = 256;
+
+        /// ASCII lowercase, header names are tokens so nothing else needs care.
+        constexpr char ToLowerAscii(const char c) {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        constexpr bool EqualsIgnoreCase(const std::string_view left, const std::string_view right) {
+            if (left.size() != right.size()) return false;
+            for (size_t i = 0; i < left.size(); ++i) {
+                if (ToLowerAscii(left[i]) != ToLowerAscii(right[i])) return false;
+            }
+            return true;
+        }
+
+        /// Seeded FNV-1a of the lowercased name, folded into the table.
+        constexpr uint32_t HashHeaderName(const std::string_view name, const uint32_t seed) {
+            uint32_t hash = 2166136261u ^ seed;
+            for (const char c : name) {
+                hash = (hash ^ static_cast<uint8_t>(ToLowerAscii(c))) * 16777619u;
+            }
+            return (hash ^ (hash >> 16)) % HTTP_HEADER_TABLE_SIZE;
+        }
+
+        /// First seed hashing all known names into distinct slots.
+        constexpr uint32_t FindHttpHeaderSeed() {
+            for (uint32_t seed = 0;; ++seed) {
+                bool isUsed[HTTP_HEADER_TABLE_SIZE] = {};
+                bool isPerfect = true;
+                for (const std::string_view name : HTTP_HEADER_NAMES) {
+                    const uint32_t slot = HashHeaderName(name, seed);
+                    if (isUsed[slot]) {
+                        isPerfect = false;
+                        break;
+                    }
+                    isUsed[slot] = true;
+                }
+                if (isPerfect) return seed;
+            }
+        }
+
+        inline constexpr uint32_t HTTP_HEADER_SEED = FindHttpHeaderSeed();
+
+        /// Slot to `HttpHeaderId`, `Unknown` for free slots.
+        constexpr std::array<HttpHeaderId, HTTP_HEADER_TABLE_SIZE> BuildHttpHeaderTable() {
+            std::array<HttpHeaderId, HTTP_HEADER_TABLE_SIZE> table = {};
+            for (HttpHeaderId& id : table) id = HttpHeaderId::Unknown;
+            for (size_t i = 0; i < std::size(HTTP_HEADER_NAMES); ++i) {
+                table[HashHeaderName(HTTP_HEADER_NAMES[i], HTTP_HEADER_SEED)] = static_cast<HttpHeaderId>(i);
+            }
+            return table;
+        }
+
+        inline constexpr std::array<HttpHeaderId, HTTP_HEADER_TABLE_SIZE> HTTP_HEADER_TABLE = BuildHttpHeaderTable();
+    } // namespace Detail
+
+    /// Header fields of a parsed message.
+    ///
+    /// The header block is copied once into an own buffer and fields are kept as offsets into it, so
+    /// nothing is lowercased or allocated per field and copies stay valid. Names keep their original case,
+    /// all lookups are case-insensitive. Names from `HttpHeaderId` resolve through a perfect hash built
+    /// at compile time and their first occurrence is indexed, such lookups are O(1).
+    class HttpHeaders {
+    public:
+        struct Field {
+            std::string_view name;
+            std::string_view value;
+            HttpHeaderId id;
+        };
+
+        /// Maps the name to its `HttpHeaderId` ignoring case, `Unknown` if it isn't one of them.
+        static constexpr HttpHeaderId GetId(const std::string_view name) {
+            const HttpHeaderId id = Detail::HTTP_HEADER_TABLE[Detail::HashHeaderName(name, Detail::HTTP_HEADER_SEED)];
+            if (id == HttpHeaderId::Unknown) return id;
+
+            const bool isMatch = Detail::EqualsIgnoreCase(name, Detail::HTTP_HEADER_NAMES[static_cast<size_t>(id)]);
+            return isMatch ? id : HttpHeaderId::Unknown;
+        }
+        static constexpr std::string_view GetName(const HttpHeaderId id) {
+            return Detail::HTTP_HEADER_NAMES[static_cast<size_t>(id)];
+        }
+
+    private:
+        struct Span {
+            uint32_t nameOffset;
+            uint32_t valueOffset;
+            uint16_t nameSize;
+            HttpHeaderId id;
+            uint32_t valueSize;
+        };
+
+        static constexpr uint16_t NOT_FOUND = 0xffff;
+
+        std::string buffer;
+        std::vector<Span> spans;
+        /// Position of the first field with the id in `spans`.
+        std::array<uint16_t, static_cast<size_t>(HttpHeaderId::Count)> firstIndices;
+
+        void Index(const size_t lineBegin, const size_t lineEnd);
+        inline Field ToField(const Span& span) const {
+            return {
+                std::string_view(buffer.data() + span.nameOffset, span.nameSize),
+                std::string_view(buffer.data() + span.valueOffset, span.valueSize),
+                span.id
+            };
+        }
+
+    public:
+        class Iterator {
+        private:
+            const HttpHeaders* headers;
+            size_t index;
+
+        public:
+            Iterator(const HttpHeaders* headers, const size_t index) : headers(headers), index(index) {}
+
+            inline Field operator*() const { return headers->ToField(headers->spans[index]); }
+            inline Iterator& operator++() {
+                ++index;
+                return *this;
+            }
+            inline bool operator!=(const Iterator& other) const { return index != other.index; }
+        };
+
+        HttpHeaders() { firstIndices.fill(NOT_FOUND); }
+
+        /// Replaces the content with `name: value` lines separated by CRLF (or LF), malformed lines are skipped.
+        void Parse(const std::string_view lines);
+        /// Appends the field, it's indexed as well.
+        void Add(const std::string_view name, const std::string_view value);
+        void Clear();
+
+        /// First value of the header, empty if there is none.
+        inline std::string_view Get(const HttpHeaderId id) const {
+            const uint16_t index = firstIndices[static_cast<size_t>(id)];
+            return (index == NOT_FOUND) ? std::string_view() : ToField(spans[index]).value;
+        }
+        /// First value of the header, empty if there is none. Unknown names are searched linearly.
+        std::string_view Get(const std::string_view name) const;
+
+        inline bool Contains(const HttpHeaderId id) const {
+            return firstIndices[static_cast<size_t>(id)] != NOT_FOUND;
+        }
+        bool Contains(const std::string_view name) const;
+
+        inline size_t GetSize() const { return spans.size(); }
+        inline bool IsEmpty() const { return spans.empty(); }
+        /// Bytes held, for memory accounting.
+        inline size_t GetMemorySize() const { return buffer.capacity() + spans.capacity() * sizeof(Span); }
+
+        inline Iterator begin() const { return Iterator(this, 0); }
+        inline Iterator end() const { return Iterator(this, spans.size()); }
+    };
+} // namespace Net
+
+#endif
@@ -0,0 +1,678 @@
+#include "httpServer.h"
+
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "dataBuffer.h"
+#include "poller.h"
+#include "stringUtils.h"
+#include "utils.h"
+
+using namespace Net;
+
+static constexpr int POLL_TIMEOUT_MS = 100;
+static constexpr uint MAX_GATHER_BUFFERS = 64;
+
+static constexpr std::string_view CRLF = "\r\n";
+static constexpr std::string_view HEADERS_END = "\r\n\r\n";
+
+static std::string_view TrimSpaces(std::string_view string) {
+    while (!string.empty() && (string.front() == ' ' || string.front() == '\t')) string.remove_prefix(1);
+    while (!string.empty() && (string.back() == ' ' || string.back() == '\t')) string.remove_suffix(1);
+
+    return string;
+}
+
+std::string_view HttpRequest::GetHeader(const std::string_view name) const {
+    for (uint8_t i = 0; i < headersCount; ++i) {
+        if (StringUtils::EqualsIgnoreCase(headers[i].name, name)) return headers[i].value;
+    }
+
+    return {};
+}
+
+void HttpResponseWriter::Reset() {
+    statusCode = 200;
+    headers.clear();
+    body = {};
+    ownedBody.clear();
+    close = false;
+    webSocketHandler = nullptr;
+}
+
+void HttpResponseWriter::AddHeader(const std::string_view name, const std::string_view value) {
+    headers.append(name).append(": ").append(value).append(CRLF);
+}
+
+bool HttpResponseWriter::AcceptWebSocket(
+    const HttpRequest& request,
+    WebSocketHandler handler,
+    const WebSocket::Options& options
+) {
+    const std::string_view key = request.GetHeader("Sec-WebSocket-Key");
+    const std::string_view version = request.GetHeader("Sec-WebSocket-Version");
+
+    if (request.method != "GET" || key.empty() ||
+        StringUtils::EqualsIgnoreCase(request.GetHeader("Upgrade"), "websocket") == false) [[unlikely]] {
+        SetStatus(400);
+        return false;
+    }
+    if (version != "13") [[unlikely]] {
+        SetStatus(400);
+        AddHeader("Sec-WebSocket-Version", "13");
+        return false;
+    }
+
+    SetStatus(101);
+    AddHeader("Upgrade", "websocket");
+    AddHeader("Connection", "Upgrade");
+    AddHeader("Sec-WebSocket-Accept", WebSocket::MakeAcceptKey(key));
+
+    webSocketDeflate = WebSocket::Deflate();
+    if (options.usePerMessageDeflate && WebSocket::IsDeflateSupported() &&
+        WebSocket::ParseDeflate(request.GetHeader("Sec-WebSocket-Extensions"), webSocketDeflate)) {
+        AddHeader("Sec-WebSocket-Extensions", WebSocket::FormatDeflate(webSocketDeflate));
+    }
+
+    webSocketHandler = std::move(handler);
+    webSocketOptions = options;
+    return true;
+}
+
+const char* HttpServer::GetReasonPhrase(const uint16_t statusCode) {
+    switch (statusCode) {
+        case 100:
+            return "Continue";
+        case 101:
+            return "Switching Protocols";
+        case 200:
+            return "OK";
+        case 201:
+            return "Created";
+        case 204:
+            return "No Content";
+        case 206:
+            return "Partial Content";
+        case 301:
+            return "Moved Permanently";
+        case 302:
+            return "Found";
+        case 304:
+            return "Not Modified";
+        case 400:
+            return "Bad Request";
+        case 403:
+            return "Forbidden";
+        case 404:
+            return "Not Found";
+        case 405:
+            return "Method Not Allowed";
+        case 413:
+            return "Payload Too Large";
+        case 431:
+            return "Request Header Fields Too Large";
+        case 500:
+            return "Internal Server Error";
+        case 501:
+            return "Not Implemented";
+        case 503:
+            return "Service Unavailable";
+        default:
+            break;
+    }
+    return "Unknown";
+}
+
+int HttpServer::ParseRequest(const char* data, const size_t size, HttpRequest& outRequest) {
+    const std::string_view input(data, size);
+
+    const size_t headersEnd = input.find(HEADERS_END);
+    if (headersEnd == std::string_view::npos) {
+        return 0;
+    }
+
+    // Request line: `METHOD SP target SP HTTP/x.y`.
+    const size_t lineEnd = input.find(CRLF);
+    const std::string_view requestLine = input.substr(0, lineEnd);
+
+    const size_t methodEnd = requestLine.find(' ');
+    const size_t targetEnd = requestLine.rfind(' ');
+    if (methodEnd == std::string_view::npos || methodEnd == 0 || targetEnd <= methodEnd + 1) [[unlikely]] {
+        return -1;
+    }
+
+    outRequest.method = requestLine.substr(0, methodEnd);
+    outRequest.target = requestLine.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+    outRequest.version = requestLine.substr(targetEnd + 1);
+    if (outRequest.version.substr(0, 5) != "HTTP/") [[unlikely]] {
+        return -1;
+    }
+
+    const size_t queryBegin = outRequest.target.find('?');
+    outRequest.path = outRequest.target.substr(0, queryBegin);
+    outRequest.query =
+        (queryBegin == std::string_view::npos) ? std::string_view() : outRequest.target.substr(queryBegin + 1);
+
+    const bool isHttp10 = outRequest.version == "HTTP/1.0";
+    outRequest.keepAlive = !isHttp10;
+    outRequest.headersCount = 0;
+
+    size_t contentLength = 0;
+    size_t lineBegin = lineEnd + CRLF.size();
+
+    while (lineBegin < headersEnd + CRLF.size()) {
+        const size_t end = input.find(CRLF, lineBegin);
+        const std::string_view line = input.substr(lineBegin, end - lineBegin);
+        lineBegin = end + CRLF.size();
+
+        const size_t colon = line.find(':');
+        if (colon == std::string_view::npos || colon == 0) [[unlikely]] {
+            return -1;
+        }
+        if (outRequest.headersCount == HttpRequest::MAX_HEADERS) [[unlikely]] {
+            return -1;
+        }
+
+        HttpRequest::Header& header = outRequest.headers[outRequest.headersCount++];
+        header.name = line.substr(0, colon);
+        header.value = TrimSpaces(line.substr(colon + 1));
+
+        if (StringUtils::EqualsIgnoreCase(header.name, "Content-Length")) {
+            const char* valueEnd = header.value.data() + header.value.size();
+            if (std::from_chars(header.value.data(), valueEnd, contentLength).ptr != valueEnd) [[unlikely]] {
+                return -1;
+            }
+        } else if (StringUtils::EqualsIgnoreCase(header.name, "Connection")) {
+            if (StringUtils::EqualsIgnoreCase(header.value, "close")) {
+                outRequest.keepAlive = false;
+            } else if (StringUtils::EqualsIgnoreCase(header.value, "keep-alive")) {
+                outRequest.keepAlive = true;
+            }
+        } else if (StringUtils::EqualsIgnoreCase(header.name, "Transfer-Encoding")) {
+            // Chunked request bodies are not supported.
+            return -1;
+        }
+    }
+
+    const size_t bodyBegin = headersEnd + HEADERS_END.size();
+    if (size - bodyBegin < contentLength) {
+        return 0;
+    }
+
+    outRequest.body = input.substr(bodyBegin, contentLength);
+    return static_cast<int>(bodyBegin + contentLength);
+}
+
+void HttpServer::Route(const std::string_view method, const std::string_view path, Handler handler) {
+    auto it = routes.find(path);
+    if (it == routes.end()) {
+        // Keys are views, so keep paths in the storage that never moves them.
+        const std::string_view key = routePaths.emplace_back(path);
+        it = routes.emplace(key, std::vector<RouteEntry>()).first;
+    }
+
+    it->second.push_back({std::string(method), std::move(handler)});
+}
+
+void HttpServer::Dispatch(const HttpRequest& request, HttpResponseWriter& writer) const {
+    const auto it = routes.find(request.path);
+    if (it != routes.end()) {
+        for (const RouteEntry& route : it->second) {
+            if (route.method == request.method) {
+                route.handler(request, writer);
+                return;
+            }
+        }
+
+        if (!fallback) {
+            writer.SetStatus(405);
+            return;
+        }
+    }
+
+    if (fallback) {
+        fallback(request, writer);
+    } else {
+        writer.SetStatus(404);
+    }
+}
+
+Address::port_t HttpServer::Listen(const Address& address) {
+    if (listener.Open(address.GetFamily(), Protocol::TCP) == false) [[unlikely]] {
+        return Address::INVALID_PORT;
+    }
+
+    listener.Set<SocketOption::ReuseAddress>(true);
+#ifdef __linux__
+    // Workers of `Run()` bind their own listeners to the same address.
+    listener.Set<SocketOption::ReusePort>(true);
+#endif
+
+    const Address::port_t port = listener.Listen(address);
+    if (port == Address::INVALID_PORT) [[unlikely]] {
+        listener.Close();
+        return port;
+    }
+
+    listenAddress = address;
+    listenAddress.SetPort(port);
+
+    // Accepting may happen from several workers, nobody should block on it.
+    listener.SetNonBlocking();
+    running = true;
+
+    return port;
+}
+
+/// Single event loop, owns connections accepted by it.
+class HttpServer::Worker {
+private:
+    struct Connection {
+        Socket socket;
+        DataBuffer input;
+        // Bytes that were not sent at once, no more requests are read until it's flushed.
+        std::string pending;
+        bool closing = false;
+
+        // Set once the WebSocket handshake is accepted, the connection is handed over after `101` is sent.
+        HttpResponseWriter::WebSocketHandler webSocketHandler;
+        WebSocket::Deflate webSocketDeflate;
+        WebSocket::Options webSocketOptions;
+    };
+
+    struct Segment {
+        size_t headOffset;
+        size_t headSize;
+        std::string_view body;
+    };
+
+    HttpServer& server;
+    Socket& listener;
+    /// Set when the listener is shared with other workers.
+    std::mutex* acceptMutex;
+    Poller poller;
+    std::unordered_map<Socket::Handle, std::unique_ptr<Connection>> connections;
+
+    // Per-batch storage of pipelined responses, reused between batches.
+    HttpRequest request;
+    HttpResponseWriter writer;
+    std::string heads;
+    std::vector<Segment> segments;
+    std::deque<std::string> ownedBodies;
+    std::vector<IoBuffer> ioBuffers;
+
+    void AcceptAll();
+    void CloseConnection(Connection& connection);
+    /// Removes the connection from the loop and runs its WebSocket handler on a separate thread.
+    void UpgradeConnection(Connection& connection);
+
+    void OnReadable(Connection& connection);
+    void OnWritable(Connection& connection);
+
+    void AppendResponse(const bool keepAlive);
+    void AppendError(const uint16_t statusCode);
+    /// Sends responses accumulated for the connection, returns `false` if the connection was closed.
+    bool Flush(Connection& connection);
+
+public:
+    Worker(HttpServer& server, Socket& listener, std::mutex* acceptMutex)
+        : server(server), listener(listener), acceptMutex(acceptMutex) {}
+
+    void Run();
+};
+
+void HttpServer::Worker::Run() {
+    poller.Add(listener.GetHandle(), Poller::Readable);
+
+    std::vector<Poller::Event> events;
+    while (server.running) {
+        poller.Wait(events, POLL_TIMEOUT_MS);
+
+        for (const Poller::Event& event : events) {
+            if (event.handle == listener.GetHandle()) {
+                AcceptAll();
+                continue;
+            }
+
+            Connection& connection = *static_cast<Connection*>(event.userData);
+            if (event.events & Poller::Writable) {
+                OnWritable(connection);
+            } else if (event.events & (Poller::Readable | Poller::Closed)) {
+                OnReadable(connection);
+            }
+        }
+    }
+
+    poller.Remove(listener.GetHandle());
+    for (auto& [handle, connection] : connections) {
+        poller.Remove(handle);
+    }
+    connections.clear();
+}
+
+void HttpServer::Worker::AcceptAll() {
+    while (true) {
+        Socket socket;
+        if (acceptMutex != nullptr) {
+            // `Accept()` updates the status of the listener, so it's not called concurrently.
+            const std::lock_guard<std::mutex> lock(*acceptMutex);
+            socket = listener.Accept();
+        } else {
+            socket = listener.Accept();
+        }
+        if (socket.IsValid() == false) {
+            return;
+        }
+
+        socket.SetNonBlocking();
+        // Responses are already coalesced by gathered sends, don't let Nagle delay them.
+        socket.Set<SocketOption::NoDelay>(true);
+
+        auto connection = std::make_unique<Connection>();
+        connection->socket = std::move(socket);
+
+        const Socket::Handle handle = connection->socket.GetHandle();
+        poller.Add(handle, Poller::Readable, connection.get());
+        connections.emplace(handle, std::move(connection));
+    }
+}
+
+void HttpServer::Worker::CloseConnection(Connection& connection) {
+    const Socket::Handle handle = connection.socket.GetHandle();
+
+    poller.Remove(handle);
+    connections.erase(handle);
+}
+
+void HttpServer::Worker::UpgradeConnection(Connection& connection) {
+    const Socket::Handle handle = connection.socket.GetHandle();
+    poller.Remove(handle);
+
+    const auto it = connections.find(handle);
+    std::unique_ptr<Connection> owned = std::move(it->second);
+    connections.erase(it);
+
+    owned->socket.SetNonBlocking(false);
+
+    std::lock_guard<std::mutex> lock(server.upgradedMutex);
+    // Threads of closed connections are joined here, so they don't pile up on a long running server.
+    server.upgraded.remove_if([](Upgraded& entry) {
+        if (entry.isFinished == false) return false;
+        entry.thread.join();
+        return true;
+    });
+
+    Upgraded& entry = server.upgraded.emplace_back();
+    entry.handle = handle;
+    entry.thread = std::thread([&server = server, &entry, connection = std::move(owned)]() {
+        {
+            WebSocket webSocket(
+                std::move(connection->socket),
+                WebSocket::Role::Server,
+                std::string_view(connection->input, connection->input.size),
+                connection->webSocketDeflate,
+                connection->webSocketOptions
+            );
+            connection->webSocketHandler(webSocket);
+
+            std::lock_guard<std::mutex> lock(server.upgradedMutex);
+            entry.isReleased = true;
+        }
+        entry.isFinished = true;
+    });
+}
+
+void HttpServer::Worker::OnReadable(Connection& connection) {
+    DataBuffer& input = connection.input;
+
+    const uint received = connection.socket.Receive(input + input.size, DataBuffer::MAX_SIZE - input.size);
+    if (received == 0) {
+        // Either peer closed the connection or an error happened, both are final unless it's spurious wakeup.
+        if (connection.socket.Fail() != TryAgain) {
+            CloseConnection(connection);
+        }
+        return;
+    }
+
+    input.size += received;
+
+    size_t offset = 0;
+    while (offset < input.size && connection.closing == false) {
+        const int consumed = ParseRequest(input + offset, input.size - offset, request);
+        if (consumed < 0) {
+            AppendError(400);
+            connection.closing = true;
+            break;
+        }
+        if (consumed == 0) {
+            if (offset == 0 && input.size == DataBuffer::MAX_SIZE) {
+                // Complete head means it's the body that doesn't fit.
+                const bool isHeadComplete = std::string_view(input, input.size).find(HEADERS_END) != std::string::npos;
+                AppendError(isHeadComplete ? 413 : 431);
+                connection.closing = true;
+            }
+            break;
+        }
+
+        offset += consumed;
+
+        writer.Reset();
+        server.Dispatch(request, writer);
+
+        if (writer.webSocketHandler) {
+            // Anything after the handshake is WebSocket frames, so parsing stops here.
+            AppendResponse(true);
+            connection.webSocketHandler = std::move(writer.webSocketHandler);
+            connection.webSocketDeflate = writer.webSocketDeflate;
+            connection.webSocketOptions = writer.webSocketOptions;
+            break;
+        }
+
+        AppendResponse(request.keepAlive);
+        connection.closing = !request.keepAlive || writer.close;
+    }
+
+    // Responses may point into the input, so it's compacted only after they're sent.
+    if (Flush(connection) == false) {
+        return;
+    }
+
+    if (offset > 0) {
+        input.size -= offset;
+        std::memmove(input.data, input.data + offset, input.size);
+    }
+
+    if (connection.webSocketHandler && connection.pending.empty()) {
+        UpgradeConnection(connection);
+    }
+}
+
+void HttpServer::Worker::OnWritable(Connection& connection) {
+    const uint sent = connection.socket.Send(connection.pending.data(), connection.pending.size());
+    if (sent == 0) {
+        if (connection.socket.Fail() != TryAgain) {
+            CloseConnection(connection);
+        }
+        return;
+    }
+
+    connection.pending.erase(0, sent);
+    if (connection.pending.empty() == false) {
+        return;
+    }
+
+    if (connection.closing) {
+        CloseConnection(connection);
+        return;
+    }
+    if (connection.webSocketHandler) {
+        UpgradeConnection(connection);
+        return;
+    }
+
+    poller.Modify(connection.socket.GetHandle(), Poller::Readable);
+}
+
+void HttpServer::Worker::AppendResponse(const bool keepAlive) {
+    std::string_view body = writer.body;
+    if (body.data() == writer.ownedBody.data() && body.empty() == false) {
+        // Writer is reused for the next request, so move the body out of it.
+        body = ownedBodies.emplace_back(std::move(writer.ownedBody));
+    }
+
+    const size_t headOffset = heads.size();
+
+    char number[24];
+    const char* numberEnd = std::to_chars(std::begin(number), std::end(number), writer.statusCode).ptr;
+
+    heads.append("HTTP/1.1 ").append(number, numberEnd - number).append(" ");
+    heads.append(GetReasonPhrase(writer.statusCode)).append(CRLF);
+
+    // Informational, `204` and `304` responses have no body and no length.
+    const uint16_t statusCode = writer.statusCode;
+    if (statusCode >= 200 && statusCode != 204 && statusCode != 304) {
+        numberEnd = std::to_chars(std::begin(number), std::end(number), body.size()).ptr;
+        heads.append("Content-Length: ").append(number, numberEnd - number).append(CRLF);
+    } else {
+        body = {};
+    }
+
+    if (!keepAlive || writer.close) {
+        heads.append("Connection: close\r\n");
+    } else if (request.version == "HTTP/1.0") {
+        heads.append("Connection: keep-alive\r\n");
+    }
+
+    heads.append(writer.headers).append(CRLF);
+
+    segments.push_back({headOffset, heads.size() - headOffset, body});
+}
+
+void HttpServer::Worker::AppendError(const uint16_t statusCode) {
+    writer.Reset();
+    writer.SetStatus(statusCode);
+    AppendResponse(false);
+}
+
+bool HttpServer::Worker::Flush(Connection& connection) {
+    ioBuffers.clear();
+    for (const Segment& segment : segments) {
+        ioBuffers.push_back(MakeIoBuffer(heads.data() + segment.headOffset, segment.headSize));
+        if (segment.body.empty() == false) {
+            ioBuffers.push_back(MakeIoBuffer(segment.body.data(), segment.body.size()));
+        }
+    }
+
+    size_t index = 0;
+    bool failed = false;
+
+    while (index < ioBuffers.size()) {
+        const uint count = std::min<size_t>(ioBuffers.size() - index, MAX_GATHER_BUFFERS);
+        uint sent = connection.socket.SendGather(ioBuffers.data() + index, count);
+
+        if (sent == 0) {
+            failed = connection.socket.Fail() != TryAgain;
+            break;
+        }
+
+        // Skip fully sent buffers, the partially sent one is cut in place.
+        while (index < ioBuffers.size() && sent >= GetIoBufferSize(ioBuffers[index])) {
+            sent -= static_cast<uint>(GetIoBufferSize(ioBuffers[index]));
+            ++index;
+        }
+        if (index < ioBuffers.size() && sent > 0) {
+            AdvanceIoBuffer(ioBuffers[index], sent);
+        }
+    }
+
+    if (failed == false) {
+        // Socket is full: keep the rest and wait until it is writable.
+        for (; index < ioBuffers.size(); ++index) {
+            connection.pending.append(GetIoBufferData(ioBuffers[index]), GetIoBufferSize(ioBuffers[index]));
+        }
+    }
+
+    heads.clear();
+    segments.clear();
+    ownedBodies.clear();
+
+    if (failed || (connection.closing && connection.pending.empty())) {
+        CloseConnection(connection);
+        return false;
+    }
+
+    if (connection.pending.empty() == false) {
+        poller.Modify(connection.socket.GetHandle(), Poller::Writable);
+    }
+    return true;
+}
+
+void HttpServer::Run(const uint threadsCount) {
+    LIBPOG_ASSERT(listener.IsListening(), "Server must listen before running");
+
+    // Each worker gets its own listener where the kernel balances connections between them,
+    // the shared one is used by the calling thread and as a fallback.
+    std::vector<Socket> listeners(threadsCount > 1 ? threadsCount - 1 : 0);
+    bool isShared = false;
+    for (Socket& workerListener : listeners) {
+        workerListener = OpenWorkerListener();
+        isShared = isShared || workerListener.IsListening() == false;
+    }
+    std::mutex* const sharedMutex = isShared ? &acceptMutex : nullptr;
+
+    std::vector<std::thread> threads;
+    for (Socket& workerListener : listeners) {
+        if (workerListener.IsListening()) {
+            threads.emplace_back([this, &workerListener]() { Worker(*this, workerListener, nullptr).Run(); });
+        } else {
+            threads.emplace_back([this, sharedMutex]() { Worker(*this, listener, sharedMutex).Run(); });
+        }
+    }
+
+    Worker(*this, listener, sharedMutex).Run();
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    CloseUpgraded();
+}
+
+void HttpServer::CloseUpgraded() {
+    {
+        // Blocked reads of the handlers fail then, the sockets of returned ones may be closed already.
+        std::lock_guard<std::mutex> lock(upgradedMutex);
+        for (const Upgraded& entry : upgraded) {
+            if (entry.isReleased == false) shutdown(entry.handle, static_cast<int>(Socket::ShutdownMode::Both));
+        }
+    }
+
+    // Workers are gone, nothing is added meanwhile.
+    for (Upgraded& entry : upgraded) {
+        entry.thread.join();
+    }
+    upgraded.clear();
+}
+
+Socket HttpServer::OpenWorkerListener() const {
+    Socket workerListener;
+#ifdef __linux__
+    if (workerListener.Open(listenAddress.GetFamily(), Protocol::TCP) == false) [[unlikely]] {
+        return workerListener;
+    }
+
+    workerListener.Set<SocketOption::ReuseAddress>(true);
+    workerListener.Set<SocketOption::ReusePort>(true);
+    if (workerListener.Listen(listenAddress) == Address::INVALID_PORT) [[unlikely]] {
+        Utils::Warn("Failed to open worker listener, sharing the main one");
+        workerListener.Close();
+        return workerListener;
+    }
+    workerListener.SetNonBlocking();
+#endif
+    return workerListener;
+}
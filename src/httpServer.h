@@ -0,0 +1,169 @@
+#ifndef _HTTPSERVER_H
+#define _HTTPSERVER_H
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "socket.h"
+#include "webSocket.h"
+
+namespace Net {
+    /// HTTP request parsed in place: all views point into the connection receive buffer
+    /// and stay valid only during the handler call.
+    struct HttpRequest {
+        struct Header {
+            std::string_view name;
+            std::string_view value;
+        };
+
+        static constexpr uint8_t MAX_HEADERS = 64;
+
+        std::string_view method;
+        std::string_view target;
+        std::string_view path;
+        std::string_view query;
+        std::string_view version;
+        std::string_view body;
+
+        Header headers[MAX_HEADERS];
+        uint8_t headersCount = 0;
+
+        bool keepAlive = true;
+
+        /// Case-insensitive header lookup, returns empty view if there is no such header.
+        std::string_view GetHeader(const std::string_view name) const;
+    };
+
+    /// Builds the response for a single request within `HttpServer` handler.
+    /// `Content-Length` and `Connection` headers are set automatically.
+    class HttpResponseWriter {
+    public:
+        typedef std::function<void(WebSocket&)> WebSocketHandler;
+
+    private:
+        uint16_t statusCode = 200;
+        std::string headers;
+        std::string_view body;
+        std::string ownedBody;
+        bool close = false;
+
+        WebSocketHandler webSocketHandler;
+        WebSocket::Deflate webSocketDeflate;
+        WebSocket::Options webSocketOptions;
+
+        friend class HttpServer;
+
+        void Reset();
+
+    public:
+        inline void SetStatus(const uint16_t code) { statusCode = code; }
+        void AddHeader(const std::string_view name, const std::string_view value);
+
+        /// Sets the body without copying, the data must outlive the handler call:
+        /// static data or views into the request are fine.
+        inline void SetBody(const std::string_view data) { body = data; }
+        /// Sets the body taking ownership of the string.
+        inline void SetBody(std::string&& data) {
+            ownedBody = std::move(data);
+            body = ownedBody;
+        }
+
+        /// Closes the connection after the response is sent.
+        inline void CloseConnection() { close = true; }
+
+        /// Responds with `101` if the request is a valid WebSocket opening handshake, `400` otherwise.
+        /// Once the response is sent, the connection leaves the server and `handler` is called
+        /// on its own thread with a blocking `WebSocket`, the socket is closed when it returns.
+        bool AcceptWebSocket(
+            const HttpRequest& request,
+            WebSocketHandler handler,
+            const WebSocket::Options& options = {}
+        );
+
+        inline uint16_t GetStatus() const { return statusCode; }
+    };
+
+    /// Small HTTP/1.1 server on top of `Socket::Listen`/`Accept`.
+    /// Supports keep-alive and pipelining, requests are routed by method and path.
+    /// Each worker thread runs its own `Poller` loop over non-blocking sockets,
+    /// responses of pipelined requests are written with a single gathered send.
+    class HttpServer {
+    public:
+        typedef std::function<void(const HttpRequest&, HttpResponseWriter&)> Handler;
+
+        static const char* GetReasonPhrase(const uint16_t statusCode);
+
+        /// Parses single request from `data`.
+        /// Returns number of consumed bytes, `0` if the request is incomplete, `-1` if it's malformed.
+        static int ParseRequest(const char* data, const size_t size, HttpRequest& outRequest);
+
+    private:
+        struct RouteEntry {
+            std::string method;
+            Handler handler;
+        };
+
+        class Worker;
+
+        /// Connection served by its WebSocket handler on a separate thread.
+        struct Upgraded {
+            std::thread thread;
+            Socket::Handle handle;
+            /// Set under `upgradedMutex` once the handler returns, the socket may be closed after that.
+            bool isReleased = false;
+            std::atomic<bool> isFinished = false;
+        };
+
+        Socket listener;
+        Address listenAddress;
+        std::mutex acceptMutex;
+        std::atomic<bool> running = false;
+
+        std::deque<std::string> routePaths;
+        std::unordered_map<std::string_view, std::vector<RouteEntry>> routes;
+        Handler fallback;
+
+        std::mutex upgradedMutex;
+        std::list<Upgraded> upgraded;
+
+        void Dispatch(const HttpRequest& request, HttpResponseWriter& writer) const;
+        /// Listener bound to the same address for one more worker, invalid socket if the os can't balance them.
+        Socket OpenWorkerListener() const;
+        /// Shuts down connections still served by WebSocket handlers and joins their threads.
+        void CloseUpgraded();
+
+    public:
+        HttpServer() = default;
+        ~HttpServer() { Stop(); }
+
+        HttpServer(const HttpServer&) = delete;
+
+        /// Registers handler for exact `method` and `path` (query string is not the part of path).
+        /// Routes must be registered before `Run()`.
+        void Route(const std::string_view method, const std::string_view path, Handler handler);
+        /// Handler for requests without matching route, by default responds with `404`.
+        inline void SetFallback(Handler handler) { fallback = std::move(handler); }
+
+        /// Binds and starts listening at `address`.
+        /// Returns `Address::INVALID_PORT` if failed, actually bound port otherwise.
+        Address::port_t Listen(const Address& address);
+
+        /// Serves connections on the calling thread and `threadsCount - 1` additional ones until `Stop()`.
+        /// Handlers are called concurrently if `threadsCount > 1`.
+        /// Upgraded WebSocket connections are shut down once stopped, `Run()` returns after their handlers do.
+        void Run(const uint threadsCount = 1);
+        /// Asks running loops to exit, can be called from any thread.
+        inline void Stop() { running = false; }
+
+        inline bool IsRunning() const { return running; }
+    };
+} // namespace Net
+
+#endif
@@ -3,8 +3,18 @@
 
 // All in one header.
 
+#include "http2Client.h"
+#include "httpBatchFetcher.h"
+#include "httpCache.h"
 #include "httpClient.h"
-#include "client.h"
+#include "httpDownloader.h"
+#include "httpHeaders.h"
+#include "httpServer.h"
+#include "poller.h"
+#include "relay.h"
 #include "socket.h"
+#include "typedSocket.h"
+#include "udpDemux.h"
+#include "webSocket.h"
 
 #endif
\ No newline at end of file
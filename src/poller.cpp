@@ -0,0 +1,83 @@
+#include "poller.h"
+
+#include <system_error>
+
+#include "utils.h"
+
+using namespace Net;
+
+#ifdef _WIN32
+#define OS_POLL WSAPoll
+#else
+#define OS_POLL poll
+#endif
+
+short Poller::ToOsEvents(const uint8_t events) {
+    short result = 0;
+    if (events & Readable) result |= POLLIN;
+    if (events & Writable) result |= POLLOUT;
+
+    return result;
+}
+
+void Poller::Add(const Socket::Handle handle, const uint8_t events, void* userData) {
+    LIBPOG_ASSERT(indices.find(handle) == indices.end(), "Socket is already added");
+
+    indices.emplace(handle, pollFds.size());
+    pollFds.push_back({handle, ToOsEvents(events), 0});
+    userDatas.push_back(userData);
+}
+
+void Poller::Modify(const Socket::Handle handle, const uint8_t events) {
+    const auto it = indices.find(handle);
+    LIBPOG_ASSERT(it != indices.end(), "Socket must be added first");
+
+    pollFds[it->second].events = ToOsEvents(events);
+}
+
+void Poller::Remove(const Socket::Handle handle) {
+    const auto it = indices.find(handle);
+    if (it == indices.end()) [[unlikely]] {
+        return;
+    }
+
+    // Swap with the last one to keep arrays dense.
+    const size_t index = it->second;
+    const size_t last = pollFds.size() - 1;
+    if (index != last) {
+        pollFds[index] = pollFds[last];
+        userDatas[index] = userDatas[last];
+        indices[pollFds[index].fd] = index;
+    }
+
+    pollFds.pop_back();
+    userDatas.pop_back();
+    indices.erase(it);
+}
+
+uint Poller::Wait(std::vector<Event>& outEvents, const int timeoutMs) {
+    outEvents.clear();
+
+    const int ret = OS_POLL(pollFds.data(), pollFds.size(), timeoutMs);
+    if (ret <= 0) {
+        if (ret < 0 && errno != EINTR) [[unlikely]] {
+            Utils::Error("Failed to poll sockets: ", std::system_category().message(errno));
+        }
+        return 0;
+    }
+
+    outEvents.reserve(ret);
+    for (size_t i = 0; i < pollFds.size() && outEvents.size() < static_cast<size_t>(ret); ++i) {
+        const short osEvents = pollFds[i].revents;
+        if (osEvents == 0) continue;
+
+        uint8_t events = None;
+        if (osEvents & POLLIN) events |= Readable;
+        if (osEvents & POLLOUT) events |= Writable;
+        if (osEvents & (POLLERR | POLLHUP | POLLNVAL)) events |= Closed;
+
+        outEvents.push_back({pollFds[i].fd, events, userDatas[i]});
+    }
+
+    return static_cast<uint>(outEvents.size());
+}
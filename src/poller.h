@@ -0,0 +1,63 @@
+#ifndef _POLLER_H
+#define _POLLER_H
+
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#else
+#include <poll.h>
+#endif
+
+#include "socket.h"
+
+namespace Net {
+    /// Waits for readiness of many sockets at once, used to drive non-blocking sockets
+    /// from a single thread. Built on top of `poll` (`WSAPoll` on windows).
+    class Poller {
+    public:
+        enum Events : uint8_t {
+            None = 0,
+            Readable = 1 << 0,
+            Writable = 1 << 1,
+            // Reported only, error or hang up on the socket.
+            Closed = 1 << 2,
+        };
+
+        struct Event {
+            Socket::Handle handle;
+            uint8_t events;
+            void* userData;
+        };
+
+    private:
+        std::vector<struct pollfd> pollFds;
+        std::vector<void*> userDatas;
+        std::unordered_map<Socket::Handle, size_t> indices;
+
+        static short ToOsEvents(const uint8_t events);
+
+    public:
+        /// Starts watching the socket.
+        /// - `events`: combination of `Readable` and `Writable`.
+        /// - `userData`: pointer returned within `Event` when the socket is ready.
+        void Add(const Socket::Handle handle, const uint8_t events, void* userData = nullptr);
+        /// Changes set of events the socket is watched for.
+        void Modify(const Socket::Handle handle, const uint8_t events);
+        /// Stops watching the socket, must be called before the socket is closed.
+        void Remove(const Socket::Handle handle);
+
+        /// Waits until at least one socket is ready or timeout expired.
+        /// - `outEvents`: cleared and filled with ready sockets.
+        /// - `timeoutMs`: negative value means infinite waiting.
+        ///
+        /// Returns number of ready sockets, `0` on timeout or failure.
+        uint Wait(std::vector<Event>& outEvents, const int timeoutMs = -1);
+
+        inline size_t GetSize() const { return pollFds.size(); }
+        inline bool IsEmpty() const { return pollFds.empty(); }
+    };
+} // namespace Net
+
+#endif
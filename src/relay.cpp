@@ -0,0 +1,280 @@
+#include "relay.h"
+
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+#include "utils.h"
+
+using namespace Net;
+
+static constexpr int POLL_TIMEOUT_MS = 100;
+
+/// One way of the relay: bytes are taken from `source` into the pipe (or buffer) and given to `destination`.
+class Relay::Direction {
+private:
+    Socket& source;
+    Socket& destination;
+
+#ifdef __linux__
+    int pipeHandles[2] = {-1, -1};
+#else
+    std::vector<char> buffer;
+    size_t begin = 0;
+#endif
+    size_t capacity;
+    // Bytes taken from source but not yet given to destination.
+    size_t pending = 0;
+    // Pipe ran out of slots before `capacity`: every splice takes one, so small segments fill it early.
+    // Reading waits for the destination then, otherwise readable source would wake `poll` all the time.
+    bool isPipeFull = false;
+
+public:
+    uint64_t transferred = 0;
+    bool isSourceFinished = false;
+    bool isFinished = false;
+    Status status = Success;
+
+    Direction(Socket& source, Socket& destination, const uint bufferSize)
+        : source(source), destination(destination), capacity(bufferSize) {}
+
+    ~Direction() {
+#ifdef __linux__
+        if (pipeHandles[0] >= 0) close(pipeHandles[0]);
+        if (pipeHandles[1] >= 0) close(pipeHandles[1]);
+#endif
+    }
+
+    Direction(const Direction&) = delete;
+
+    bool Init() {
+#ifdef __linux__
+        if (pipe2(pipeHandles, O_CLOEXEC | O_NONBLOCK) != 0) [[unlikely]] {
+            status = static_cast<Status>(errno);
+            return false;
+        }
+
+        // Above `/proc/sys/fs/pipe-max-size` unprivileged processes get `EPERM`, the default size is kept then.
+        int size = fcntl(pipeHandles[1], F_SETPIPE_SZ, static_cast<int>(capacity));
+        if (size < 0) size = fcntl(pipeHandles[1], F_GETPIPE_SZ);
+        if (size > 0) capacity = static_cast<size_t>(size);
+#else
+        buffer.resize(capacity);
+#endif
+        return true;
+    }
+
+    inline bool WantsRead() const {
+        return isSourceFinished == false && pending < capacity && isPipeFull == false && status == Success;
+    }
+    inline bool WantsWrite() const { return pending > 0 && status == Success; }
+
+    /// Takes everything the source has until the pipe is full.
+    void Fill() {
+        while (WantsRead()) {
+#ifdef __linux__
+            const ssize_t ret = splice(
+                source.GetHandle(), nullptr, pipeHandles[1], nullptr, capacity - pending,
+                SPLICE_F_MOVE | SPLICE_F_NONBLOCK
+            );
+            if (ret < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN) {
+                    status = static_cast<Status>(errno);
+                } else {
+                    // Either the source is drained or the pipe can't take more, only the latter leaves data behind.
+                    int available = 0;
+                    isPipeFull = pending > 0 && ioctl(source.GetHandle(), FIONREAD, &available) == 0 && available > 0;
+                }
+                return;
+            }
+#else
+            // Free space is kept at the end of the buffer.
+            if (begin + pending == capacity) {
+                std::memmove(buffer.data(), buffer.data() + begin, pending);
+                begin = 0;
+            }
+            const uint ret =
+                source.Receive(buffer.data() + begin + pending, static_cast<uint>(capacity - begin - pending));
+            if (ret == 0) {
+                const Status error = source.Fail();
+                if (error == TryAgain) return;
+                if (error != Success) {
+                    status = error;
+                    return;
+                }
+            }
+#endif
+            if (ret == 0) {
+                isSourceFinished = true;
+                return;
+            }
+            pending += static_cast<size_t>(ret);
+        }
+    }
+
+    /// Gives the destination everything it accepts.
+    void Drain() {
+        while (WantsWrite()) {
+#ifdef __linux__
+            const ssize_t ret = splice(
+                pipeHandles[0], nullptr, destination.GetHandle(), nullptr, pending, SPLICE_F_MOVE | SPLICE_F_NONBLOCK
+            );
+            if (ret < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN) status = static_cast<Status>(errno);
+                return;
+            }
+#else
+            const uint ret = destination.Send(buffer.data() + begin, static_cast<uint>(pending));
+            if (ret == 0) {
+                const Status error = destination.Fail();
+                if (error != TryAgain) status = error;
+                return;
+            }
+            begin = (pending == ret) ? 0 : begin + ret;
+#endif
+            pending -= static_cast<size_t>(ret);
+            transferred += static_cast<uint64_t>(ret);
+            isPipeFull = false;
+        }
+    }
+
+    /// Forwards end of stream once everything before it is delivered.
+    void Finish() {
+        if (isFinished || isSourceFinished == false || pending > 0 || status != Success) {
+            return;
+        }
+
+        isFinished = true;
+        if (destination.Shutdown(Socket::ShutdownMode::Send) == false) [[unlikely]] {
+            // Peer may be gone already, its own direction reports that.
+            destination.Fail();
+        }
+    }
+};
+
+#ifndef _WIN32
+namespace {
+    /// `splice` into a socket can't take `MSG_NOSIGNAL`, so `SIGPIPE` is blocked on the calling thread
+    /// for the relay lifetime and pending ones are discarded before the mask is restored.
+    class SigPipeGuard {
+    private:
+        sigset_t oldMask;
+        bool wasPending = false;
+
+    public:
+        SigPipeGuard() {
+            sigset_t pending;
+            sigpending(&pending);
+            wasPending = sigismember(&pending, SIGPIPE) == 1;
+
+            sigset_t mask;
+            sigemptyset(&mask);
+            sigaddset(&mask, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &mask, &oldMask);
+        }
+
+        ~SigPipeGuard() {
+            if (wasPending == false) {
+                sigset_t mask;
+                sigemptyset(&mask);
+                sigaddset(&mask, SIGPIPE);
+
+                const struct timespec zero = {0, 0};
+                while (sigtimedwait(&mask, nullptr, &zero) > 0) {
+                }
+            }
+            pthread_sigmask(SIG_SETMASK, &oldMask, nullptr);
+        }
+    };
+} // namespace
+#endif
+
+Relay::Stats Relay::Run() {
+    LIBPOG_ASSERT(first.IsConnected() && second.IsConnected(), "Both sockets must be connected");
+
+    Stats stats;
+
+    Direction forward(first, second, bufferSize);
+    Direction backward(second, first, bufferSize);
+    if (forward.Init() == false || backward.Init() == false) [[unlikely]] {
+        stats.status = forward.status != Success ? forward.status : backward.status;
+        return stats;
+    }
+
+    if (first.SetNonBlocking() == false || second.SetNonBlocking() == false) [[unlikely]] {
+        stats.status = first.GetStatus() != Success ? first.GetStatus() : second.GetStatus();
+        return stats;
+    }
+
+#ifndef _WIN32
+    const SigPipeGuard sigPipeGuard;
+#endif
+
+    while (isStopped == false && (forward.isFinished == false || backward.isFinished == false)) {
+        if (forward.status != Success || backward.status != Success) {
+            break;
+        }
+
+        // Every socket waits for reading as the source of one direction and for writing as the destination
+        // of the other, a full pipe stops reading and lets the TCP window close on the sender.
+#ifdef _WIN32
+        WSAPOLLFD pollFds[2] = {};
+#else
+        struct pollfd pollFds[2] = {};
+#endif
+        pollFds[0].fd = first.GetHandle();
+        pollFds[0].events = (forward.WantsRead() ? POLLIN : 0) | (backward.WantsWrite() ? POLLOUT : 0);
+        pollFds[1].fd = second.GetHandle();
+        pollFds[1].events = (backward.WantsRead() ? POLLIN : 0) | (forward.WantsWrite() ? POLLOUT : 0);
+
+#ifdef _WIN32
+        const int ret = WSAPoll(pollFds, 2, POLL_TIMEOUT_MS);
+#else
+        const int ret = poll(pollFds, 2, POLL_TIMEOUT_MS);
+#endif
+        if (ret < 0) [[unlikely]] {
+#ifndef _WIN32
+            if (errno == EINTR) continue;
+#endif
+            stats.status = Failed;
+            break;
+        }
+
+        // Errors and hang ups surface from the calls themselves.
+        const short anyEvent = POLLIN | POLLOUT | POLLERR | POLLHUP;
+        if (pollFds[0].revents & anyEvent) {
+            forward.Fill();
+            backward.Drain();
+        }
+        if (pollFds[1].revents & anyEvent) {
+            backward.Fill();
+            forward.Drain();
+        }
+        // Freshly filled pipes are drained right away, mostly the destination is writable.
+        forward.Drain();
+        backward.Drain();
+
+        forward.Finish();
+        backward.Finish();
+    }
+    isStopped = false;
+
+    stats.firstToSecond = forward.transferred;
+    stats.secondToFirst = backward.transferred;
+    if (stats.status == Success) {
+        stats.status = forward.status != Success ? forward.status : backward.status;
+    }
+    return stats;
+}
@@ -0,0 +1,57 @@
+#ifndef _RELAY_H
+#define _RELAY_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "socket.h"
+
+namespace Net {
+    /// Forwards bytes both ways between two connected stream sockets until both sides finish,
+    /// the building block of an L4 proxy.
+    ///
+    /// On Linux data moves with `splice` through a kernel pipe per direction and never enters userspace,
+    /// elsewhere it goes through a buffer with `Receive`/`Send`. Each direction holds at most `bufferSize`
+    /// bytes in flight, a slow receiver stops reading from the fast sender (TCP backpressure).
+    /// End of stream is propagated separately per direction with `Socket::Shutdown(ShutdownMode::Send)`,
+    /// so half-closed connections keep working.
+    ///
+    /// Both sockets are switched into non-blocking mode and left open, closing is up to the caller.
+    class Relay {
+    public:
+        struct Stats {
+            /// Bytes delivered from the first socket to the second one.
+            uint64_t firstToSecond = 0;
+            /// Bytes delivered from the second socket to the first one.
+            uint64_t secondToFirst = 0;
+            /// First failure of either socket, `Success` if both sides finished cleanly.
+            Status status = Success;
+        };
+
+        static constexpr uint DEFAULT_BUFFER_SIZE = 1024 * 1024;
+
+    private:
+        class Direction;
+
+        Socket& first;
+        Socket& second;
+        uint bufferSize = DEFAULT_BUFFER_SIZE;
+        // Set by `Stop()` and cleared once the run exits, so a stop requested before the run starts isn't lost.
+        std::atomic<bool> isStopped = false;
+
+    public:
+        Relay(Socket& first, Socket& second) : first(first), second(second) {}
+
+        Relay(const Relay&) = delete;
+
+        /// Limits bytes in flight per direction, the kernel may round it (pipe capacity is in pages).
+        inline void SetBufferSize(const uint size) { bufferSize = size; }
+
+        /// Forwards until both directions reach end of stream, either socket fails or `Stop()` is called.
+        Stats Run();
+        /// Asks `Run()` to exit, can be called from any thread, also before `Run()` starts.
+        inline void Stop() { isStopped = true; }
+    };
+} // namespace Net
+
+#endif
@@ -1,5 +1,7 @@
 #include "socket.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstring>
 #include <system_error>
 
@@ -48,6 +50,12 @@ static void DeinitWSA() {
 #define OS(nt, unix) unix
 
 #include <arpa/inet.h>
+#include <fcntl.h>
+#ifdef __linux__
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include <time.h>
+#endif
 #include <netdb.h>
 #include <netinet/tcp.h>
 #include <poll.h>
@@ -60,7 +68,12 @@ inline static int GetLastSystemError() {
 }
 #endif
 
-const char* GetStatusName(const Status status) {
+// Writing into a socket closed by peer shouldn't kill the whole process with `SIGPIPE`.
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+const char* Net::GetStatusName(const Status status) {
     switch (status) {
         case Status::Success:
             return "Success";
@@ -80,6 +93,8 @@ const char* GetStatusName(const Status status) {
             return "Timeout";
         case Status::TryAgain:
             return "Try Again";
+        case Status::InProgress:
+            return "In Progress";
         case Status::Unreachable:
             return "Unreachable";
         default:
@@ -88,7 +103,7 @@ const char* GetStatusName(const Status status) {
     return "Unknown";
 }
 
-const char* GetProtocolName(const Protocol protocol) {
+const char* Net::GetProtocolName(const Protocol protocol) {
     switch (protocol) {
         case Protocol::None:
             return "None";
@@ -173,7 +188,9 @@ Address Address::FromDomain(const char* domainStr, const port_t port, const Prot
         return result;
     }
 
-    result.osAddress.any = *addresses->ai_addr;
+    // `sockaddr` is too small for IPv6 addresses, copy as much as the resolver returned.
+    const size_t addressSize = std::min<size_t>(addresses->ai_addrlen, sizeof(result.osAddress));
+    std::memcpy(static_cast<void*>(&result.osAddress), addresses->ai_addr, addressSize);
     result.osAddress.ipv4.sin_port = htons(port);
     freeaddrinfo(addresses);
 
@@ -204,7 +221,89 @@ Address Address::MakeBind(const Protocol protocol, const Family family, const po
     return result;
 }
 
+#ifndef _WIN32
+Address Address::FromPath(const std::string_view path, const bool isAbstract) {
+    Address result;
+
+    // Filesystem path needs the terminating null, abstract name needs the leading one.
+    const size_t size = path.size() + 1;
+    if (path.empty() || size > sizeof(result.osAddress.local.sun_path)) [[unlikely]] {
+        Utils::Error("Invalid local address path");
+        return result;
+    }
+
+    std::memset(&result.osAddress.local, 0, sizeof(result.osAddress.local));
+    result.osAddress.local.sun_family = AF_LOCAL;
+    std::memcpy(result.osAddress.local.sun_path + (isAbstract ? 1 : 0), path.data(), path.size());
+    result.localPathSize = static_cast<uint8_t>(size);
+
+    return result;
+}
+
+std::string_view Address::GetPath() const {
+    if (IsLocal() == false || localPathSize == 0) {
+        return {};
+    }
+
+    const char* path = osAddress.local.sun_path;
+    if (path[0] == '\0') {
+        return std::string_view(path + 1, localPathSize - 1);
+    }
+
+    return std::string_view(path, strnlen(path, localPathSize));
+}
+#endif
+
+socklen_t Address::GetSize() const {
+    switch (GetFamily()) {
+        case Family::IPv4:
+            return sizeof(osAddress.ipv4);
+        case Family::IPv6:
+            return sizeof(osAddress.ipv6);
+#ifndef _WIN32
+        case Family::Local:
+            return static_cast<socklen_t>(offsetof(SOCKADDR_UN, sun_path) + localPathSize);
+#endif
+        default:
+            break;
+    }
+    return sizeof(osAddress);
+}
+
+void Address::SetSize(const socklen_t size) {
+#ifndef _WIN32
+    if (IsLocal()) {
+        const size_t pathOffset = offsetof(SOCKADDR_UN, sun_path);
+        localPathSize = static_cast<uint8_t>(size > pathOffset ? size - pathOffset : 0);
+    }
+#endif
+}
+
+Address::Key Address::GetKey() const {
+    LIBPOG_ASSERT(IsIPv4() || IsIPv6(), "Only IP addresses have keys");
+
+    Key result;
+    std::memset(&result, 0, sizeof(result));
+    result.family = GetFamily();
+
+    if (IsIPv4()) {
+        std::memcpy(result.ip, &osAddress.ipv4.sin_addr, sizeof(osAddress.ipv4.sin_addr));
+        result.port = ntohs(osAddress.ipv4.sin_port);
+    } else {
+        std::memcpy(result.ip, &osAddress.ipv6.sin6_addr, sizeof(osAddress.ipv6.sin6_addr));
+        result.port = ntohs(osAddress.ipv6.sin6_port);
+    }
+
+    return result;
+}
+
 std::string Address::ConvertToString() const {
+#ifndef _WIN32
+    if (IsLocal()) {
+        return (IsAbstract() ? "@" : "") + std::string(GetPath());
+    }
+#endif
+
     std::string result;
     const void* ret;
     if (osAddress.any.sa_family == AF_INET) {
@@ -230,6 +329,34 @@ std::string Address::ConvertToString() const {
     return std::move(result);
 }
 
+Socket Socket::FromHandle(const Handle handle, const State state) {
+    Socket result;
+    result.osSocket = handle;
+    result.state = (handle == INVALID_SOCKET) ? State::None : state;
+
+    return result;
+}
+
+#ifndef _WIN32
+bool Socket::CreatePair(const Protocol protocol, Socket& outFirst, Socket& outSecond) {
+    LIBPOG_ASSERT(outFirst.IsOpen() == false && outSecond.IsOpen() == false, "Output sockets must be closed");
+
+    const int type = protocol == Protocol::None ? SOCK_STREAM : static_cast<int>(protocol);
+
+    int handles[2];
+    if (socketpair(AF_LOCAL, type, 0, handles) < 0) [[unlikely]] {
+        const int error = GetLastSystemError();
+        outFirst.status = static_cast<Status>(error);
+        Utils::Error("Failed to create socket pair: ", std::system_category().message(error));
+        return false;
+    }
+
+    outFirst = FromHandle(handles[0]);
+    outSecond = FromHandle(handles[1]);
+    return true;
+}
+#endif
+
 bool Socket::Open(const Address::Family addr_family, const Protocol protocol) {
     LIBPOG_ASSERT(IsOpen() == false, "Socket can be open only once");
 
@@ -243,7 +370,8 @@ bool Socket::Open(const Address::Family addr_family, const Protocol protocol) {
     const int sock_type = protocol == Protocol::None ? SOCK_STREAM : static_cast<int>(protocol);
     int sock_prot = 0;
 
-    switch (protocol) {
+    // Local sockets have no transport protocol.
+    switch (addr_family == Address::Family::Local ? Protocol::None : protocol) {
         case Protocol::TCP:
             sock_prot = IPPROTO_TCP;
             break;
@@ -280,14 +408,32 @@ void Socket::Close() {
     osSocket = INVALID_SOCKET;
 }
 
+bool Socket::Shutdown(const ShutdownMode mode) {
+    LIBPOG_ASSERT(IsOpen(), "Socket must be open");
+
+    if (shutdown(osSocket, static_cast<int>(mode)) != 0) [[unlikely]] {
+        status = static_cast<Status>(GetLastSystemError());
+        return false;
+    }
+
+    return true;
+}
+
 bool Socket::Connect(const Address& address) {
     LIBPOG_ASSERT(
         (IsOpen() && state == State::None),
         "Socket can be connected from opened state only, if it's not alredy connected or listening"
     );
 
-    if (connect(osSocket, &address.osAddress.any, sizeof(address)) < 0) {
+    if (connect(osSocket, &address.osAddress.any, address.GetSize()) < 0) {
         status = static_cast<Status>(GetLastSystemError());
+#ifdef _WIN32
+        if (WSAGetLastError() == WSAEWOULDBLOCK) status = InProgress;
+#endif
+        if (status == InProgress) {
+            state = State::Connected;
+            return true;
+        }
         Utils::Error("Failed to connect: ", std::system_category().message(static_cast<int>(status)));
         return false;
     }
@@ -296,47 +442,122 @@ bool Socket::Connect(const Address& address) {
     return true;
 }
 
-Address::port_t Socket::Listen(const Address& address) {
+bool Socket::Bind(const Address& address) {
+    LIBPOG_ASSERT((IsOpen() && state == State::None), "Socket can be bound from opened state only");
+
+    if (bind(osSocket, &address.osAddress.any, address.GetSize()) < 0) {
+        status = static_cast<Status>(GetLastSystemError());
+        Utils::Error("Failed to bind address to socket: ", std::system_category().message(static_cast<int>(status)));
+        return false;
+    }
+
+    return true;
+}
+
+bool Socket::Listen(const int backlog) {
     LIBPOG_ASSERT(
         (IsOpen() && state == State::None),
         "Socket can start listening from opened state only, if it's not alredy connected or listening"
     );
 
-    if (bind(osSocket, &address.osAddress.any, sizeof(address.osAddress.any)) < 0) {
+    if (listen(osSocket, backlog) < 0) {
         status = static_cast<Status>(GetLastSystemError());
-        Utils::Error("Failed to bind address to socket: ", std::system_category().message(static_cast<int>(status)));
+        Utils::Error("Failed to start listening: ", std::system_category().message(static_cast<int>(status)));
+        return false;
+    }
+
+    state = State::Listening;
+    return true;
+}
+
+uint Socket::ConnectFastOpen(const Address& address, const char* dataPtr, const uint size) {
+    LIBPOG_ASSERT(
+        (IsOpen() && state == State::None),
+        "Socket can be connected from opened state only, if it's not alredy connected or listening"
+    );
+
+#ifdef MSG_FASTOPEN
+    // Implicit connect, the data is queued until the handshake completes if it doesn't fit into SYN.
+    const ssize_t ret =
+        sendto(osSocket, dataPtr, size, MSG_FASTOPEN | MSG_NOSIGNAL, &address.osAddress.any, address.GetSize());
+    if (ret < 0) [[unlikely]] {
+        status = static_cast<Status>(GetLastSystemError());
+        if (status == static_cast<Status>(EOPNOTSUPP)) {
+            // Client side TFO is disabled by `net.ipv4.tcp_fastopen`, the socket isn't connected yet.
+            if (Connect(address) == false) [[unlikely]] {
+                return 0;
+            }
+            return Send(dataPtr, size);
+        }
+        if (status != AlreadyInProgress && status != static_cast<Status>(EINPROGRESS)) {
+            Utils::Error("Failed to connect: ", std::system_category().message(static_cast<int>(status)));
+            return 0;
+        }
+
+        // Non-blocking socket, connection is still being established.
+        state = State::Connected;
+        return 0;
+    }
+
+    state = State::Connected;
+    return static_cast<uint>(ret);
+#else
+    if (Connect(address) == false) [[unlikely]] {
+        return 0;
+    }
+
+    return Send(dataPtr, size);
+#endif
+}
+
+Address::port_t Socket::Listen(const Address& address, const int backlog) {
+    LIBPOG_ASSERT(address.IsLocal() == false, "Local addresses have no port, use `Bind()` and `Listen(backlog)`");
+
+    if (Bind(address) == false || Listen(backlog) == false) {
         return Address::INVALID_PORT;
     }
-    if (listen(osSocket, 0) < 0) {
+
+    if (address.GetPort() != Address::INVALID_PORT) [[likely]] {
+        return address.GetPort();
+    }
+
+    // Port was picked by the system, ask which one.
+    Address boundAddress;
+    socklen_t addressSize = sizeof(boundAddress.osAddress);
+    if (getsockname(osSocket, &boundAddress.osAddress.any, &addressSize) < 0) [[unlikely]] {
         status = static_cast<Status>(GetLastSystemError());
-        Utils::Error("Failed to start listening: ", std::system_category().message(static_cast<int>(status)));
         return Address::INVALID_PORT;
     }
 
-    state = State::Listening;
-    return address.GetPort();
+    return boundAddress.GetPort();
 }
 
 Socket Socket::Accept(Address& outRemoteAddress) {
     LIBPOG_ASSERT(IsListening(), "Socket must listen");
 
     Socket result;
-    socklen_t sockSize = sizeof(outRemoteAddress.osAddress.any);
+    socklen_t sockSize = sizeof(outRemoteAddress.osAddress);
 
     result.osSocket = accept(osSocket, &outRemoteAddress.osAddress.any, &sockSize);
     if (result.osSocket == INVALID_SOCKET) [[unlikely]] {
         status = static_cast<Status>(GetLastSystemError());
         return result;
     }
+    outRemoteAddress.SetSize(sockSize);
 
     result.state = State::Connected;
     return result;
 }
 
+Socket Socket::Accept() {
+    Address remoteAddress;
+    return Accept(remoteAddress);
+}
+
 uint Socket::Send(const char* data, const uint size) {
     LIBPOG_ASSERT(IsConnected(), "Socket must be connected");
 
-    ssize_t ret = send(osSocket, data, size, 0);
+    ssize_t ret = send(osSocket, data, size, MSG_NOSIGNAL);
     if (ret < 0) [[unlikely]] {
         status = static_cast<Status>(GetLastSystemError());
         return 0;
@@ -345,6 +566,33 @@ uint Socket::Send(const char* data, const uint size) {
     return static_cast<uint>(ret);
 }
 
+uint Socket::SendGather(const IoBuffer* buffers, const uint count) {
+    LIBPOG_ASSERT(IsConnected(), "Socket must be connected");
+
+#ifdef _WIN32
+    DWORD sent = 0;
+    if (WSASend(osSocket, const_cast<IoBuffer*>(buffers), count, &sent, 0, nullptr, nullptr) != 0) [[unlikely]] {
+        status = static_cast<Status>(GetLastSystemError());
+        return 0;
+    }
+
+    return static_cast<uint>(sent);
+#else
+    struct msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = const_cast<IoBuffer*>(buffers);
+    message.msg_iovlen = count;
+
+    const ssize_t ret = sendmsg(osSocket, &message, MSG_NOSIGNAL);
+    if (ret < 0) [[unlikely]] {
+        status = static_cast<Status>(GetLastSystemError());
+        return 0;
+    }
+
+    return static_cast<uint>(ret);
+#endif
+}
+
 uint Socket::Receive(char* buffer, const uint size) {
     LIBPOG_ASSERT(IsConnected(), "Socket must be connected");
 
@@ -360,7 +608,7 @@ uint Socket::Receive(char* buffer, const uint size) {
 uint Socket::SendTo(const Address& address, const char* dataPtr, const uint size) {
     LIBPOG_ASSERT(IsOpen(), "Socket must be open");
 
-    const ssize_t ret = sendto(osSocket, dataPtr, size, 0, &address.osAddress.any, sizeof(address.osAddress.any));
+    const ssize_t ret = sendto(osSocket, dataPtr, size, 0, &address.osAddress.any, address.GetSize());
     if (ret < 0) [[unlikely]] {
         status = static_cast<Status>(GetLastSystemError());
         return 0;
@@ -372,12 +620,13 @@ uint Socket::SendTo(const Address& address, const char* dataPtr, const uint size
 uint Socket::ReceiveFrom(char* bufferPtr, const uint size, Address& outRemoteAddress) {
     LIBPOG_ASSERT(IsOpen(), "Socket must be open");
 
-    socklen_t sockSize = sizeof(outRemoteAddress.osAddress.any);
+    socklen_t sockSize = sizeof(outRemoteAddress.osAddress);
     const ssize_t ret = recvfrom(osSocket, bufferPtr, size, 0, &outRemoteAddress.osAddress.any, &sockSize);
     if (ret < 0) {
         status = static_cast<Status>(GetLastSystemError());
         return 0;
     }
+    outRemoteAddress.SetSize(sockSize);
 
     return static_cast<uint>(ret);
 }
@@ -399,6 +648,246 @@ uint Socket::ReceiveFrom(char* bufferPtr, const uint size, Socket& outSocket) {
     return ret;
 }
 
+#ifndef _WIN32
+uint Socket::SendDescriptors(const char* dataPtr, const uint size, const Handle* handles, const uint count) {
+    LIBPOG_ASSERT(IsConnected(), "Socket must be connected");
+    LIBPOG_ASSERT(size > 0, "Descriptors must be sent along with data");
+    LIBPOG_ASSERT(count <= MAX_DESCRIPTORS, "Too many descriptors");
+
+    union {
+        struct cmsghdr header;
+        char data[CMSG_SPACE(sizeof(Handle) * MAX_DESCRIPTORS)];
+    } control;
+
+    IoBuffer buffer = MakeIoBuffer(dataPtr, size);
+
+    struct msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &buffer;
+    message.msg_iovlen = 1;
+
+    if (count > 0) {
+        message.msg_control = control.data;
+        message.msg_controllen = CMSG_SPACE(sizeof(Handle) * count);
+
+        struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(Handle) * count);
+        std::memcpy(CMSG_DATA(header), handles, sizeof(Handle) * count);
+    }
+
+    const ssize_t ret = sendmsg(osSocket, &message, MSG_NOSIGNAL);
+    if (ret < 0) [[unlikely]] {
+        status = static_cast<Status>(GetLastSystemError());
+        return 0;
+    }
+
+    return static_cast<uint>(ret);
+}
+
+uint Socket::ReceiveDescriptors(
+    char* bufferPtr,
+    const uint size,
+    Handle* outHandles,
+    const uint maxCount,
+    uint& outCount
+) {
+    LIBPOG_ASSERT(IsOpen(), "Socket must be open");
+
+    outCount = 0;
+
+    union {
+        struct cmsghdr header;
+        char data[CMSG_SPACE(sizeof(Handle) * MAX_DESCRIPTORS)];
+    } control;
+
+    IoBuffer buffer = MakeIoBuffer(bufferPtr, size);
+
+    struct msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &buffer;
+    message.msg_iovlen = 1;
+    message.msg_control = control.data;
+    message.msg_controllen = sizeof(control.data);
+
+#ifdef MSG_CMSG_CLOEXEC
+    const int flags = MSG_CMSG_CLOEXEC;
+#else
+    const int flags = 0;
+#endif
+
+    const ssize_t ret = recvmsg(osSocket, &message, flags);
+    if (ret < 0) [[unlikely]] {
+        status = static_cast<Status>(GetLastSystemError());
+        return 0;
+    }
+
+    for (struct cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+
+        const uint count = static_cast<uint>((header->cmsg_len - CMSG_LEN(0)) / sizeof(Handle));
+        for (uint i = 0; i < count; ++i) {
+            Handle handle;
+            std::memcpy(&handle, CMSG_DATA(header) + i * sizeof(Handle), sizeof(Handle));
+
+            // Caller has no room for the rest, don't leak them.
+            if (outCount < maxCount) {
+                outHandles[outCount++] = handle;
+            } else {
+                close(handle);
+            }
+        }
+    }
+
+    if (message.msg_flags & MSG_CTRUNC) [[unlikely]] {
+        Utils::Warn("Some received descriptors were discarded");
+    }
+
+    return static_cast<uint>(ret);
+}
+#endif
+
+#ifdef __linux__
+static uint64_t ToNanoseconds(const struct timespec& time) {
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000ull + static_cast<uint64_t>(time.tv_nsec);
+}
+
+static uint64_t GetRealTimeNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return ToNanoseconds(now);
+}
+
+// Control messages of a packet: timestamps and, for the error queue, the extended error carrying TX stage and id.
+union TimestampControl {
+    struct cmsghdr header;
+    char data[CMSG_SPACE(sizeof(struct scm_timestamping)) + CMSG_SPACE(sizeof(struct sock_extended_err) + 64)];
+};
+
+static void ParseTimestamps(struct msghdr& message, PacketTimestamps& outTimestamps) {
+    for (struct cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_TIMESTAMPING) {
+            struct scm_timestamping timestamps;
+            std::memcpy(&timestamps, CMSG_DATA(header), sizeof(timestamps));
+            // `ts[1]` is deprecated, `ts[2]` is the raw NIC clock.
+            outTimestamps.software = ToNanoseconds(timestamps.ts[0]);
+            outTimestamps.hardware = ToNanoseconds(timestamps.ts[2]);
+        }
+    }
+}
+
+bool Socket::EnableTimestamping(const uint8_t flags) {
+    LIBPOG_ASSERT(IsOpen(), "Socket must be open");
+
+    uint osFlags = 0;
+    if (flags & RxSoftware) osFlags |= SOF_TIMESTAMPING_RX_SOFTWARE;
+    if (flags & RxHardware) osFlags |= SOF_TIMESTAMPING_RX_HARDWARE;
+    if (flags & TxSoftware) osFlags |= SOF_TIMESTAMPING_TX_SOFTWARE | SOF_TIMESTAMPING_TX_SCHED;
+    if (flags & TxHardware) osFlags |= SOF_TIMESTAMPING_TX_HARDWARE;
+    if (flags & TxAcknowledged) osFlags |= SOF_TIMESTAMPING_TX_ACK;
+
+    // Generation flags above only ask for timestamps, reporting flags let them reach the application.
+    if (flags & (RxSoftware | TxSoftware | TxAcknowledged)) osFlags |= SOF_TIMESTAMPING_SOFTWARE;
+    if (flags & (RxHardware | TxHardware)) osFlags |= SOF_TIMESTAMPING_RAW_HARDWARE;
+    // TX timestamps come without the packet copy and tagged with the id of the send call.
+    if (flags & (TxSoftware | TxHardware | TxAcknowledged)) {
+        osFlags |= SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+    }
+
+    return SetOption(SOL_SOCKET, SO_TIMESTAMPING, &osFlags, sizeof(osFlags));
+}
+
+uint Socket::Receive(char* bufferPtr, const uint size, PacketTimestamps& outTimestamps) {
+    LIBPOG_ASSERT(IsConnected(), "Socket must be connected");
+
+    Address ignored;
+    return ReceiveFrom(bufferPtr, size, ignored, outTimestamps);
+}
+
+uint Socket::ReceiveFrom(char* bufferPtr, const uint size, Address& outRemoteAddress, PacketTimestamps& outTimestamps) {
+    LIBPOG_ASSERT(IsOpen(), "Socket must be open");
+
+    outTimestamps = PacketTimestamps();
+
+    TimestampControl control;
+    IoBuffer buffer = MakeIoBuffer(bufferPtr, size);
+
+    struct msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_name = &outRemoteAddress.osAddress;
+    message.msg_namelen = sizeof(outRemoteAddress.osAddress);
+    message.msg_iov = &buffer;
+    message.msg_iovlen = 1;
+    message.msg_control = control.data;
+    message.msg_controllen = sizeof(control.data);
+
+    const ssize_t ret = recvmsg(osSocket, &message, 0);
+    outTimestamps.user = GetRealTimeNs();
+    if (ret < 0) [[unlikely]] {
+        status = static_cast<Status>(GetLastSystemError());
+        return 0;
+    }
+
+    outRemoteAddress.SetSize(message.msg_namelen);
+    ParseTimestamps(message, outTimestamps);
+
+    return static_cast<uint>(ret);
+}
+
+bool Socket::ReceiveTxTimestamp(TxTimestamp& outTimestamp) {
+    LIBPOG_ASSERT(IsOpen(), "Socket must be open");
+
+    TimestampControl control;
+    // Timestamps are requested without payload, yet some kernels still expect room for it.
+    char payload[64];
+    IoBuffer buffer = MakeIoBuffer(payload, sizeof(payload));
+
+    struct msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &buffer;
+    message.msg_iovlen = 1;
+    message.msg_control = control.data;
+    message.msg_controllen = sizeof(control.data);
+
+    if (recvmsg(osSocket, &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+        status = static_cast<Status>(GetLastSystemError());
+        return false;
+    }
+
+    outTimestamp = TxTimestamp();
+    outTimestamp.timestamps.user = GetRealTimeNs();
+    ParseTimestamps(message, outTimestamp.timestamps);
+
+    for (struct cmsghdr* header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+        const bool isIpError = (header->cmsg_level == SOL_IP && header->cmsg_type == IP_RECVERR) ||
+                               (header->cmsg_level == SOL_IPV6 && header->cmsg_type == IPV6_RECVERR);
+        if (isIpError == false) continue;
+
+        struct sock_extended_err error;
+        std::memcpy(&error, CMSG_DATA(header), sizeof(error));
+        if (error.ee_errno != ENOMSG || error.ee_origin != SO_EE_ORIGIN_TIMESTAMPING) continue;
+
+        outTimestamp.id = error.ee_data;
+        switch (error.ee_info) {
+            case SCM_TSTAMP_SCHED:
+                outTimestamp.stage = TxTimestamp::Stage::Scheduled;
+                break;
+            case SCM_TSTAMP_ACK:
+                outTimestamp.stage = TxTimestamp::Stage::Acknowledged;
+                break;
+            default:
+                outTimestamp.stage = TxTimestamp::Stage::Sent;
+                break;
+        }
+    }
+
+    return true;
+}
+#endif
+
 // Wrappers for strings
 template<>
 uint Socket::Send(const char* string) {
@@ -413,18 +902,69 @@ uint Socket::Send(const std::string& string) {
     return Send(string.data(), string.size());
 }
 
-bool Socket::SetOption(const Option option, const void* value, const uint valueSize) {
-    if (setsockopt(osSocket, SOL_SOCKET, static_cast<int>(option), value, sizeof(value)) == SOCKET_ERROR) {
+bool Socket::SetNonBlocking(const bool enable) {
+    LIBPOG_ASSERT(IsOpen(), "Socket must be open");
+
+#ifdef _WIN32
+    u_long mode = enable ? 1 : 0;
+    if (ioctlsocket(osSocket, FIONBIO, &mode) != 0) [[unlikely]] {
+        status = static_cast<Status>(GetLastSystemError());
+        return false;
+    }
+#else
+    const int flags = fcntl(osSocket, F_GETFL, 0);
+    if (flags < 0 || fcntl(osSocket, F_SETFL, enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK)) < 0) [[unlikely]] {
         status = static_cast<Status>(GetLastSystemError());
         return false;
     }
+#endif
+
     return true;
 }
 
+bool Socket::SetOption(const Option option, const void* value, const uint valueSize) {
+    return SetOption(SOL_SOCKET, static_cast<int>(option), value, valueSize);
+}
+
 bool Socket::GetOption(const Option option, void* outValue, uint& valueSize) const {
-    if (getsockopt(osSocket, SOL_SOCKET, static_cast<int>(option), &outValue, &valueSize) == SOCKET_ERROR) {
+    return GetOption(SOL_SOCKET, static_cast<int>(option), outValue, valueSize);
+}
+
+bool Socket::SetOption(const int level, const int name, const void* value, const uint valueSize) {
+    const char* valuePtr = static_cast<const char*>(value);
+    if (setsockopt(osSocket, level, name, valuePtr, static_cast<socklen_t>(valueSize)) == SOCKET_ERROR) {
         status = static_cast<Status>(GetLastSystemError());
         return false;
     }
     return true;
+}
+
+bool Socket::GetOption(const int level, const int name, void* outValue, uint& valueSize) const {
+    socklen_t osValueSize = static_cast<socklen_t>(valueSize);
+    if (getsockopt(osSocket, level, name, static_cast<char*>(outValue), &osValueSize) == SOCKET_ERROR) {
+        status = static_cast<Status>(GetLastSystemError());
+        return false;
+    }
+
+    valueSize = static_cast<uint>(osValueSize);
+    return true;
+}
+
+bool Socket::ApplyProfile(const TcpProfile& profile) {
+    bool result = true;
+
+    if (profile.noDelay) result &= Set<SocketOption::NoDelay>(true);
+#ifdef TCP_QUICKACK
+    if (profile.quickAck) result &= Set<SocketOption::QuickAck>(true);
+#endif
+    if (profile.sendBufferSize > 0) result &= Set<SocketOption::SendBuffer>(profile.sendBufferSize);
+    if (profile.receiveBufferSize > 0) result &= Set<SocketOption::ReceiveBuffer>(profile.receiveBufferSize);
+#ifdef TCP_NOTSENT_LOWAT
+    if (profile.notSentLowat > 0) result &= Set<SocketOption::NotSentLowat>(profile.notSentLowat);
+#endif
+#ifdef SO_BUSY_POLL
+    if (profile.busyPollUs > 0) result &= Set<SocketOption::BusyPoll>(profile.busyPollUs);
+#endif
+
+    return result;
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <cstring>
 #include <string>
+#include <utility>
 
 #ifdef _WIN32 // Windows NT
 #include <WS2tcpip.h>
@@ -11,7 +12,10 @@
 #pragma comment(lib, "ws2_32.lib")
 #else // POSIX
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 #endif
 
 #include "dataBuffer.h"
@@ -30,6 +34,7 @@ namespace Net {
         Failed, // Any other fail.
         AlreadyConnected = EISCONN,
         AlreadyInProgress = EALREADY,
+        InProgress = EINPROGRESS,
         ConnectionRefused = ECONNREFUSED,
         ConnectionReset = ECONNRESET,
         InvalidAddress = EAFNOSUPPORT,
@@ -47,6 +52,35 @@ namespace Net {
     const char* GetStatusName(const Status status);
     const char* GetProtocolName(const Protocol protocol);
 
+    /// Os-specific scatter/gather buffer descriptor, used by `Socket::SendGather()`.
+#ifdef _WIN32
+    typedef WSABUF IoBuffer;
+
+    inline IoBuffer MakeIoBuffer(const char* dataPtr, const size_t size) {
+        return {static_cast<ULONG>(size), const_cast<char*>(dataPtr)};
+    }
+    inline const char* GetIoBufferData(const IoBuffer& buffer) { return buffer.buf; }
+    inline size_t GetIoBufferSize(const IoBuffer& buffer) { return buffer.len; }
+    /// Skips first `count` bytes of the buffer, e.g. after a partial send.
+    inline void AdvanceIoBuffer(IoBuffer& buffer, const size_t count) {
+        buffer.buf += count;
+        buffer.len -= static_cast<ULONG>(count);
+    }
+#else
+    typedef struct iovec IoBuffer;
+
+    inline IoBuffer MakeIoBuffer(const char* dataPtr, const size_t size) {
+        return {const_cast<char*>(dataPtr), size};
+    }
+    inline const char* GetIoBufferData(const IoBuffer& buffer) { return static_cast<const char*>(buffer.iov_base); }
+    inline size_t GetIoBufferSize(const IoBuffer& buffer) { return buffer.iov_len; }
+    /// Skips first `count` bytes of the buffer, e.g. after a partial send.
+    inline void AdvanceIoBuffer(IoBuffer& buffer, const size_t count) {
+        buffer.iov_base = static_cast<char*>(buffer.iov_base) + count;
+        buffer.iov_len -= count;
+    }
+#endif
+
     /// Represents os-specific network address, used within the `Socket` to configure connections.
     /// Supports `IPv4` and `IPv6` addresses, `UNIX` local addresses supported only on *NIX systems.
     class Address {
@@ -66,11 +100,41 @@ namespace Net {
             IPv6 = AF_INET6
         };
 
+        /// Compact hashable identity of IP address and port, e.g. to key flow tables.
+        /// IPv4 addresses occupy the first 4 bytes of `ip`, the rest is zero.
+        struct Key {
+            uint8_t ip[16];
+            port_t port;
+            Family family;
+
+            inline bool operator==(const Key& other) const {
+                return port == other.port && family == other.family && std::memcmp(ip, other.ip, sizeof(ip)) == 0;
+            }
+            inline bool operator!=(const Key& other) const { return !(*this == other); }
+
+            inline uint64_t Hash() const {
+                uint64_t high, low;
+                std::memcpy(&high, ip, sizeof(high));
+                std::memcpy(&low, ip + sizeof(high), sizeof(low));
+
+                // Murmur3 finalizer over the folded key.
+                uint64_t hash = high ^ (low * 0x9e3779b97f4a7c15ull) ^ (static_cast<uint64_t>(port) << 8) ^
+                                static_cast<uint64_t>(family);
+                hash ^= hash >> 33;
+                hash *= 0xff51afd7ed558ccdull;
+                hash ^= hash >> 33;
+                hash *= 0xc4ceb93fe53b1a87ull;
+                hash ^= hash >> 33;
+                return hash;
+            }
+        };
+
     private:
         typedef struct sockaddr_in SOCKADDR_IN;
         typedef struct sockaddr_in6 SOCKADDR_IN6;
 #ifndef _WIN32
         typedef struct sockaddr SOCKADDR;
+        typedef struct sockaddr_un SOCKADDR_UN;
 #endif
 
         static constexpr uint16_t INVALID_FLAG = 0xffff;
@@ -82,9 +146,21 @@ namespace Net {
             SOCKADDR any;
             SOCKADDR_IN ipv4;
             SOCKADDR_IN6 ipv6;
+#ifndef _WIN32
+            SOCKADDR_UN local;
+#endif
         } osAddress;
 
+        // Used bytes of `sun_path`, abstract names are not null-terminated so it can't be computed.
+        uint8_t localPathSize = 0;
+
         friend class Socket;
+        friend class UdpDemux;
+        template<Family>
+        friend class Endpoint;
+
+        /// Updates the size after the os filled `osAddress` (`accept`, `recvfrom`, etc.).
+        void SetSize(const socklen_t size);
 
     public:
         static const char* GetFamilyName(const Family family);
@@ -120,11 +196,37 @@ namespace Net {
         static Address
         MakeBind(const Protocol protocol = Protocol::TCP, const Family family = Family::IPv4, const port_t port = 0);
 
-        /// Convert internal os-specific network address to string.
+#ifndef _WIN32
+        /// Construct `Local` (Unix domain socket) `Address` from filesystem path or abstract name.
+        /// - `path`: filesystem path, or a name in the abstract namespace (Linux only) if `isAbstract`.
+        ///
+        /// Returns a valid `Address` if the path fits into `sockaddr_un`.
+        static Address FromPath(const std::string_view path, const bool isAbstract = false);
+
+        /// Returns path of the `Local` address, empty for unnamed sockets.
+        std::string_view GetPath() const;
+        inline bool IsAbstract() const {
+            return IsLocal() && localPathSize > 0 && osAddress.local.sun_path[0] == '\0';
+        }
+#endif
+
+        /// Returns size of the os-specific address for its family, as system calls expect it.
+        socklen_t GetSize() const;
+
+        /// Returns compact key of `IPv4`/`IPv6` address, `Local` addresses are not supported.
+        Key GetKey() const;
+
+        /// Convert internal os-specific network address to string, `Local` addresses are converted
+        /// to their path (abstract names are prefixed with `@`).
         std::string ConvertToString() const;
 
-        inline port_t GetPort() const { return ntohs(osAddress.ipv4.sin_port); }
-        inline Family GetFamily() const { return static_cast<Family>(ntohs(osAddress.ipv4.sin_family)); }
+        /// Returns `INVALID_PORT` for `Local` addresses.
+        inline port_t GetPort() const { return IsLocal() ? INVALID_PORT : ntohs(osAddress.ipv4.sin_port); }
+        /// Ignored for `Local` addresses.
+        inline void SetPort(const port_t port) {
+            if (IsLocal() == false) osAddress.ipv4.sin_port = htons(port);
+        }
+        inline Family GetFamily() const { return static_cast<Family>(osAddress.any.sa_family); }
 
         inline bool IsValid() const { return osAddress._validFlag != INVALID_FLAG; }
         inline bool IsLocal() const {
@@ -138,6 +240,115 @@ namespace Net {
         inline bool IsIPv6() const { return GetFamily() == Family::IPv6; }
     };
 
+    /// Typed socket options for `Socket::Set()`/`Socket::Get()`, value type is checked at compile time.
+    /// Options unknown to the target os are not declared, so using them fails to compile.
+    namespace SocketOption {
+        template<int Level, int Name, typename T>
+        struct Descriptor {
+            typedef T Value;
+
+            static constexpr int LEVEL = Level;
+            static constexpr int NAME = Name;
+        };
+
+        typedef Descriptor<SOL_SOCKET, SO_KEEPALIVE, bool> KeepAlive;
+        typedef Descriptor<SOL_SOCKET, SO_REUSEADDR, bool> ReuseAddress;
+#ifdef SO_REUSEPORT
+        /// Lets several sockets bind the same address, Linux balances incoming connections between listeners.
+        typedef Descriptor<SOL_SOCKET, SO_REUSEPORT, bool> ReusePort;
+#endif
+        /// Pending error of the socket (read-only, reading clears it), e.g. the result of non-blocking connect.
+        typedef Descriptor<SOL_SOCKET, SO_ERROR, int> Error;
+        /// Kernel buffer sizes in bytes (Linux reports doubled value back).
+        typedef Descriptor<SOL_SOCKET, SO_SNDBUF, int> SendBuffer;
+        typedef Descriptor<SOL_SOCKET, SO_RCVBUF, int> ReceiveBuffer;
+#ifdef SO_BUSY_POLL
+        /// Microseconds to busy poll the device queue on blocking receive, trades CPU for latency.
+        typedef Descriptor<SOL_SOCKET, SO_BUSY_POLL, int> BusyPoll;
+#endif
+
+        /// Disables Nagle's algorithm, small writes go out immediately.
+        typedef Descriptor<IPPROTO_TCP, TCP_NODELAY, bool> NoDelay;
+#ifdef TCP_CORK
+        /// Holds partial frames until uncorked or full, to coalesce several writes into full segments.
+        typedef Descriptor<IPPROTO_TCP, TCP_CORK, bool> Cork;
+#endif
+#ifdef TCP_QUICKACK
+        /// Sends ACKs immediately instead of delaying them. It isn't permanent: the kernel clears it
+        /// when it goes back to delayed ACKs, so callers that need it must set it again, e.g. after reads.
+        typedef Descriptor<IPPROTO_TCP, TCP_QUICKACK, bool> QuickAck;
+#endif
+#ifdef TCP_NOTSENT_LOWAT
+        /// Limits unsent data buffered in the kernel, keeps the queue short for fresh data.
+        typedef Descriptor<IPPROTO_TCP, TCP_NOTSENT_LOWAT, uint> NotSentLowat;
+#endif
+#ifdef TCP_FASTOPEN
+        /// Enables TCP Fast Open on listening socket, the value is the queue length of pending TFO requests.
+        typedef Descriptor<IPPROTO_TCP, TCP_FASTOPEN, int> FastOpen;
+#endif
+    } // namespace SocketOption
+
+    /// Set of TCP options applied at once with `Socket::ApplyProfile()`, zero values keep os defaults.
+    struct TcpProfile {
+        bool noDelay = false;
+        /// Set once, see `SocketOption::QuickAck`.
+        bool quickAck = false;
+        int sendBufferSize = 0;
+        int receiveBufferSize = 0;
+        uint notSentLowat = 0;
+        int busyPollUs = 0;
+
+        /// Request/response traffic: no Nagle, immediate ACKs, short unsent queue.
+        static constexpr TcpProfile LowLatency() {
+            TcpProfile result;
+            result.noDelay = true;
+            result.quickAck = true;
+            result.notSentLowat = 16 * 1024;
+            return result;
+        }
+
+        /// Bulk transfers: large kernel buffers, Nagle is kept to fill segments.
+        static constexpr TcpProfile Throughput() {
+            TcpProfile result;
+            result.sendBufferSize = 4 * 1024 * 1024;
+            result.receiveBufferSize = 4 * 1024 * 1024;
+            return result;
+        }
+    };
+
+#ifdef __linux__
+    /// Kernel (`software`) and NIC (`hardware`) timestamps of a packet from `SO_TIMESTAMPING`,
+    /// nanoseconds since the unix epoch, `0` if not reported.
+    struct PacketTimestamps {
+        uint64_t software = 0;
+        uint64_t hardware = 0;
+        /// Taken right after the receive call returned, same clock as `software`.
+        uint64_t user = 0;
+
+        /// Time the data waited in the kernel between the arrival and the application picking it up,
+        /// the part of latency caused by the receiver being busy. `0` without software RX timestamp.
+        inline uint64_t GetDwellTime() const { return (software && user > software) ? user - software : 0; }
+    };
+
+    /// Transmit timestamp read from the error queue with `Socket::ReceiveTxTimestamp()`.
+    struct TxTimestamp {
+        enum class Stage : uint8_t {
+            /// Entered the packet scheduler (qdisc).
+            Scheduled,
+            /// Handed to the driver or sent by the NIC (with hardware timestamp).
+            Sent,
+            /// All bytes acknowledged by the peer, TCP only.
+            Acknowledged
+        };
+
+        PacketTimestamps timestamps;
+        Stage stage = Stage::Sent;
+        /// Counter of the send call (UDP) or offset of its last byte in the stream (TCP),
+        /// counted from the moment timestamping was enabled.
+        uint32_t id = 0;
+    };
+#endif
+
     class Socket {
     public:
         enum class State : uint8_t {
@@ -145,16 +356,43 @@ namespace Net {
             Connected,
             Listening
         };
+        /// Directions for `Shutdown()`, values match `SHUT_*`/`SD_*`.
+        enum class ShutdownMode : uint8_t {
+            Receive = 0,
+            Send = 1,
+            Both = 2
+        };
         enum class Option : uint8_t {
             AcceptConnections = SO_ACCEPTCONN,
             KeepAlive = SO_KEEPALIVE,
             Broadcast = SO_BROADCAST,
+            ReuseAddress = SO_REUSEADDR,
         };
 
-    private:
 #ifndef _WIN32
         typedef int SOCKET;
 #endif
+        typedef SOCKET Handle;
+
+#ifdef __linux__
+        /// Flags for `EnableTimestamping()`.
+        enum Timestamping : uint8_t {
+            RxSoftware = 1 << 0,
+            /// Needs NIC support and hardware timestamping enabled on the interface (`SIOCSHWTSTAMP`).
+            RxHardware = 1 << 1,
+            TxSoftware = 1 << 2,
+            TxHardware = 1 << 3,
+            /// TCP only, reported once the peer acknowledged the data.
+            TxAcknowledged = 1 << 4,
+        };
+#endif
+
+#ifndef _WIN32
+        /// Maximal number of descriptors in one `SendDescriptors()` call (`SCM_MAX_FD` on Linux).
+        static constexpr uint MAX_DESCRIPTORS = 253;
+#endif
+
+    private:
         SOCKET osSocket = INVALID_SOCKET;
         State state = State::None;
 
@@ -167,25 +405,61 @@ namespace Net {
             Open(addrFamily, protocol);
         }
         // Move semantic.
-        Socket(Socket&& other) noexcept {
+        Socket(Socket&& other) noexcept { *this = std::move(other); }
+        Socket& operator=(Socket&& other) noexcept {
+            if (this == &other) return *this;
+
+            Close();
             osSocket = other.osSocket;
+            state = other.state;
+            status = other.status;
+
             other.osSocket = INVALID_SOCKET;
+            other.state = State::None;
+            return *this;
         }
         // Socket cannot be copied.
         Socket(const Socket&) = delete;
+        Socket& operator=(const Socket&) = delete;
 
         ~Socket() noexcept { Close(); }
 
+        /// Takes ownership of already opened os-specific socket, e.g. received via `ReceiveDescriptors()`.
+        static Socket FromHandle(const Handle handle, const State state = State::Connected);
+
+#ifndef _WIN32
+        /// Creates a pair of connected `Local` sockets (`socketpair`), `UDP` gives datagram sockets.
+        static bool CreatePair(const Protocol protocol, Socket& outFirst, Socket& outSecond);
+#endif
+
         bool Open(const Address::Family addrFamily, const Protocol protocol);
         void Close();
+        /// Closes one or both directions of the connection, the socket stays open.
+        /// `ShutdownMode::Send` delivers end of stream to the peer (half-close) while receiving goes on.
+        bool Shutdown(const ShutdownMode mode);
 
         // Client side.
+        /// Connects to `address`. Non-blocking sockets return `true` with `Status::InProgress` set,
+        /// the socket becomes writable once done and `SocketOption::Error` tells the outcome.
         bool Connect(const Address& address);
+        /// Connects with TCP Fast Open: the data goes in the SYN if the client has a cookie for the server,
+        /// saving a round trip, otherwise it's sent right after the handshake.
+        /// Falls back to `Connect()` and `Send()` where TFO is unavailable.
+        /// Returns the number of bytes sent, `0` on failure.
+        uint ConnectFastOpen(const Address& address, const char* dataPtr, const uint size);
+
+        /// Binds the socket to `address`, datagram sockets need it to receive replies.
+        /// Bound filesystem path of `Local` address is not removed on close, `unlink` it before reuse.
+        bool Bind(const Address& address);
 
         /// Starts listening for incoming connections.
-        /// - `address`: address to start listening at.
-        /// Returns `Address::INVALID_PORT` if failed, valid port otherwise.
-        Address::port_t Listen(const Address& address);
+        /// - `address`: address to start listening at, if port is `0` the system picks a free one.
+        /// - `backlog`: maximal length of the pending connections queue.
+        /// Returns `Address::INVALID_PORT` if failed, actually bound port otherwise.
+        /// `Local` addresses have no port, use `Bind()` and `Listen(backlog)` for them.
+        Address::port_t Listen(const Address& address, const int backlog = SOMAXCONN);
+        /// Starts listening on the already bound socket.
+        bool Listen(const int backlog = SOMAXCONN);
         /// Wait and accept incoming connection. Returns `Socket` connected to
         /// remote side on success, to check if the operation failed use `Socket::IsValid()` on
         /// returned object and `Socket::Fail()` on current socket to get failure code.
@@ -195,6 +469,10 @@ namespace Net {
         /// Sends the data to remote side. On success return the number of bytes sent.
         /// Otherwise returns `0`, use `Socket::Fail()` to determine what happend.
         uint Send(const char* dataPtr, const uint size);
+        /// Sends several buffers at once with a single system call (`writev`-like).
+        /// Returns the number of bytes sent, which may be less than the total size of buffers.
+        /// Otherwise returns `0`, use `Socket::Fail()` to determine what happend.
+        uint SendGather(const IoBuffer* buffers, const uint count);
         /// Receives data from remote side.
         /// Returns number of received bytes. `0` represents an error or no-data,
         /// use `Socket::Fail()` to determine what happend.
@@ -202,8 +480,42 @@ namespace Net {
 
         uint SendTo(const Address& address, const char* dataPtr, const uint size);
         uint ReceiveFrom(char* bufferPtr, const uint size, Address& outRemoteAddress);
+        /// Same as `ReceiveFrom(char*, const uint, Address&)`, but opens `outSocket` connected to the sender.
+        /// Costs a socket per call, servers with many peers should use `UdpDemux` instead.
         uint ReceiveFrom(char* bufferPtr, const uint size, Socket& outSocket);
 
+#ifndef _WIN32
+        /// Sends the data along with open descriptors (`SCM_RIGHTS`) over `Local` socket,
+        /// the receiving process gets its own duplicates. At least one byte of data is required.
+        /// Returns the number of bytes sent, `0` on failure.
+        uint SendDescriptors(const char* dataPtr, const uint size, const Handle* handles, const uint count);
+        /// Receives the data and up to `maxCount` descriptors sent with it, `outCount` is set to the number
+        /// of received ones. The caller owns them, wrap sockets with `Socket::FromHandle()`.
+        /// Returns number of received bytes, `0` represents an error or closed connection.
+        uint ReceiveDescriptors(
+            char* bufferPtr,
+            const uint size,
+            Handle* outHandles,
+            const uint maxCount,
+            uint& outCount
+        );
+#endif
+
+#ifdef __linux__
+        /// Turns on `SO_TIMESTAMPING` for the combination of `Timestamping` flags, `0` turns it off.
+        /// TX ids start from zero again every time it's enabled.
+        bool EnableTimestamping(const uint8_t flags);
+        /// Same as `Receive(char*, const uint)`, also returns timestamps of the received data.
+        /// For stream sockets they belong to the last packet the data was taken from.
+        uint Receive(char* bufferPtr, const uint size, PacketTimestamps& outTimestamps);
+        /// Same as `ReceiveFrom(char*, const uint, Address&)`, also returns timestamps of the datagram.
+        uint ReceiveFrom(char* bufferPtr, const uint size, Address& outRemoteAddress, PacketTimestamps& outTimestamps);
+        /// Takes one transmit timestamp from the socket error queue without waiting,
+        /// they are reported asynchronously once the packet passes the stage (`POLLERR` signals them).
+        /// Returns `false` if the queue is empty (`Status::TryAgain`) or on failure.
+        bool ReceiveTxTimestamp(TxTimestamp& outTimestamp);
+#endif
+
         /// Same as `Send(const char*, const uint size)`, but works with typed objects.
         template<typename T>
         uint Send(const T* object) {
@@ -226,13 +538,45 @@ namespace Net {
             return Receive(&destObject);
         }
 
+        /// Switches socket into non-blocking mode, after that `Send`/`Receive`/`Accept`
+        /// fail with `Status::TryAgain` instead of waiting.
+        bool SetNonBlocking(const bool enable = true);
+
         bool SetOption(const Option option, const void* value, const uint valueSize);
         bool GetOption(const Option option, void* value, uint& valueSize) const;
 
         template<typename T>
         bool SetOption(const Option option, const T value) { return SetOption(option, &value, sizeof(value)); }
         template<typename T>
-        bool GetOption(const Option option, T& outValue) const { return GetOption(option, &outValue, sizeof(outValue)); }
+        bool GetOption(const Option option, T& outValue) const {
+            uint valueSize = sizeof(outValue);
+            return GetOption(option, &outValue, valueSize);
+        }
+
+        /// Sets raw option of any level, e.g. `IPPROTO_TCP`.
+        bool SetOption(const int level, const int name, const void* value, const uint valueSize);
+        bool GetOption(const int level, const int name, void* value, uint& valueSize) const;
+
+        /// Sets typed option from `SocketOption`, e.g. `socket.Set<SocketOption::NoDelay>(true)`.
+        template<typename O>
+        bool Set(const typename O::Value value) {
+            const int osValue = static_cast<int>(value);
+            return SetOption(O::LEVEL, O::NAME, &osValue, sizeof(osValue));
+        }
+        /// Reads typed option from `SocketOption`.
+        template<typename O>
+        bool Get(typename O::Value& outValue) const {
+            int osValue = 0;
+            uint valueSize = sizeof(osValue);
+            if (GetOption(O::LEVEL, O::NAME, &osValue, valueSize) == false) return false;
+
+            outValue = static_cast<typename O::Value>(osValue);
+            return true;
+        }
+
+        /// Applies all non-default options of the profile, options unsupported by the os are skipped.
+        /// Returns `false` if any of them failed, the rest is applied anyway.
+        bool ApplyProfile(const TcpProfile& profile);
 
         /// Returns last error/failure code and clear it.
         inline Status Fail() const {
@@ -253,6 +597,8 @@ namespace Net {
         inline bool IsListening() const { return state == State::Listening; };
         /// Returns `true` if the `Socket` represents a real os-specific socket, `false` otherwise.
         inline bool IsValid() const { return IsOpen(); }
+        /// Returns underlying os-specific socket descriptor.
+        inline Handle GetHandle() const { return osSocket; }
     };
 } // namespace Net
 
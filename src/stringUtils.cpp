@@ -1,6 +1,7 @@
 #include "stringUtils.h"
 
 #include <algorithm>
+#include <charconv>
 
 std::string StringUtils::Trim(const std::string_view stringToTrim) {
     std::string resultString = stringToTrim.data();
@@ -57,4 +58,23 @@ std::string StringUtils::ToLower(const std::string_view stringToLower) {
         ch = tolower(ch);
 
     return resultString;
-}
\ No newline at end of file
+}
+
+bool StringUtils::EqualsIgnoreCase(const std::string_view left, const std::string_view right) {
+    if (left.size() != right.size()) return false;
+
+    for (size_t i = 0; i < left.size(); ++i) {
+        if (tolower(static_cast<unsigned char>(left[i])) != tolower(static_cast<unsigned char>(right[i]))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool StringUtils::ParseUnsigned(const std::string_view text, uint64_t& outValue, const int base) {
+    const char* end = text.data() + text.size();
+    const std::from_chars_result result = std::from_chars(text.data(), end, outValue, base);
+
+    return text.empty() == false && result.ec == std::errc() && result.ptr == end;
+}
@@ -1,6 +1,7 @@
 #ifndef _STRING_UTILS_H
 #define _STRING_UTILS_H
 
+#include <cstdint>
 #include <string>
 
 class StringUtils {
@@ -11,6 +12,13 @@ public:
 
     static std::string ToUpper(const std::string_view stringToUpper);
     static std::string ToLower(const std::string_view stringToLower);
+
+    /// Compares ASCII strings ignoring case, doesn't allocate.
+    static bool EqualsIgnoreCase(const std::string_view left, const std::string_view right);
+
+    /// Parses the whole `text` as an unsigned number in `base`: no sign, spaces or trailing characters.
+    /// Returns `false` if there is anything else or the value doesn't fit.
+    static bool ParseUnsigned(const std::string_view text, uint64_t& outValue, const int base = 10);
 };
 
 #endif // !STRING_UTILS_H
\ No newline at end of file
@@ -0,0 +1,361 @@
+#ifndef _TYPEDSOCKET_H
+#define _TYPEDSOCKET_H
+
+#include <string_view>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <unistd.h>
+#endif
+
+#include "socket.h"
+
+// Sockets specialized at compile time by protocol and address family.
+// Unlike `Socket` they have no runtime state checks: operations that make no sense for the type
+// (e.g. `SendTo` on a TCP stream) don't exist, address sizes are constants and hot calls inline
+// down to the system call. Errors are returned with the result instead of stored in the socket.
+
+namespace Net {
+    template<Address::Family F>
+    struct FamilyTraits;
+
+    template<>
+    struct FamilyTraits<Address::Family::IPv4> {
+        typedef struct sockaddr_in OsAddress;
+
+        static inline void Init(OsAddress& address, const Address::port_t port) {
+            address.sin_family = AF_INET;
+            address.sin_port = htons(port);
+        }
+        static inline void* GetIp(OsAddress& address) { return &address.sin_addr; }
+        static inline Address::port_t GetPort(const OsAddress& address) { return ntohs(address.sin_port); }
+        static inline bool IsValid(const OsAddress& address) { return address.sin_family == AF_INET; }
+    };
+
+    template<>
+    struct FamilyTraits<Address::Family::IPv6> {
+        typedef struct sockaddr_in6 OsAddress;
+
+        static inline void Init(OsAddress& address, const Address::port_t port) {
+            address.sin6_family = AF_INET6;
+            address.sin6_port = htons(port);
+        }
+        static inline void* GetIp(OsAddress& address) { return &address.sin6_addr; }
+        static inline Address::port_t GetPort(const OsAddress& address) { return ntohs(address.sin6_port); }
+        static inline bool IsValid(const OsAddress& address) { return address.sin6_family == AF_INET6; }
+    };
+
+    /// Address of the fixed family, its os-specific size is known at compile time.
+    template<Address::Family F>
+    class Endpoint {
+    public:
+        typedef FamilyTraits<F> Traits;
+        typedef typename Traits::OsAddress OsAddress;
+
+        static constexpr socklen_t SIZE = sizeof(OsAddress);
+
+    private:
+        OsAddress osAddress = {};
+
+    public:
+        /// Returns a valid `Endpoint` if `addressStr` is an IP address of the family.
+        static Endpoint FromString(const char* addressStr, const Address::port_t port) {
+            Endpoint result;
+            if (inet_pton(static_cast<int>(F), addressStr, Traits::GetIp(result.osAddress)) == 1) {
+                Traits::Init(result.osAddress, port);
+            }
+            return result;
+        }
+        /// Returns a valid `Endpoint` if `address` has the same family.
+        static Endpoint FromAddress(const Address& address) {
+            Endpoint result;
+            if (address.GetFamily() == F) {
+                std::memcpy(&result.osAddress, &address.osAddress, SIZE);
+            }
+            return result;
+        }
+        /// Wildcard address for binding.
+        static Endpoint Any(const Address::port_t port = 0) {
+            Endpoint result;
+            Traits::Init(result.osAddress, port);
+            return result;
+        }
+
+        Address ToAddress() const {
+            Address result;
+            std::memcpy(static_cast<void*>(&result.osAddress), &osAddress, SIZE);
+            return result;
+        }
+
+        inline Address::port_t GetPort() const { return Traits::GetPort(osAddress); }
+        inline bool IsValid() const { return Traits::IsValid(osAddress); }
+
+        inline const struct sockaddr* GetOsAddress() const {
+            return reinterpret_cast<const struct sockaddr*>(&osAddress);
+        }
+        inline struct sockaddr* GetOsAddress() { return reinterpret_cast<struct sockaddr*>(&osAddress); }
+    };
+
+    /// Result of typed socket I/O: transferred bytes or the failure reason.
+    struct IoResult {
+        uint size = 0;
+        Status status = Success;
+
+        inline explicit operator bool() const { return status == Success; }
+    };
+
+    namespace Detail {
+        inline Status GetLastStatus() {
+#ifdef _WIN32
+            return static_cast<Status>(WSAGetLastError());
+#else
+            return static_cast<Status>(errno);
+#endif
+        }
+
+        inline IoResult MakeIoResult(const ssize_t ret) {
+            return (ret < 0) ? IoResult{0, GetLastStatus()} : IoResult{static_cast<uint>(ret), Success};
+        }
+
+        // Writing into a socket closed by peer shouldn't kill the whole process with `SIGPIPE`.
+#ifdef MSG_NOSIGNAL
+        static constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+        static constexpr int SEND_FLAGS = 0;
+#endif
+
+        /// Move-only owner of the os-specific socket, shared part of the typed sockets.
+        template<Address::Family F, int Type>
+        class SocketHandle {
+        protected:
+            Socket::Handle handle = INVALID_SOCKET;
+
+            explicit SocketHandle(const Socket::Handle handle) noexcept : handle(handle) {}
+
+            static Socket::Handle OpenHandle(Status* outStatus) {
+                const Socket::Handle result = ::socket(static_cast<int>(F), Type, 0);
+                if (result == INVALID_SOCKET && outStatus != nullptr) [[unlikely]] {
+                    *outStatus = GetLastStatus();
+                }
+                return result;
+            }
+
+        public:
+            SocketHandle() noexcept = default;
+            SocketHandle(SocketHandle&& other) noexcept : handle(other.handle) { other.handle = INVALID_SOCKET; }
+            SocketHandle& operator=(SocketHandle&& other) noexcept {
+                if (this != &other) {
+                    Close();
+                    handle = other.handle;
+                    other.handle = INVALID_SOCKET;
+                }
+                return *this;
+            }
+            SocketHandle(const SocketHandle&) = delete;
+            SocketHandle& operator=(const SocketHandle&) = delete;
+
+            ~SocketHandle() noexcept { Close(); }
+
+            inline void Close() {
+                if (handle == INVALID_SOCKET) return;
+#ifdef _WIN32
+                closesocket(handle);
+#else
+                ::close(handle);
+#endif
+                handle = INVALID_SOCKET;
+            }
+
+            /// Sets typed option from `SocketOption`.
+            template<typename O>
+            inline bool Set(const typename O::Value value) {
+                const int osValue = static_cast<int>(value);
+                const char* valuePtr = reinterpret_cast<const char*>(&osValue);
+                return setsockopt(handle, O::LEVEL, O::NAME, valuePtr, sizeof(osValue)) == 0;
+            }
+
+            /// Gives the descriptor away to dynamic `Socket`.
+            inline Socket ToSocket(const Socket::State state = Socket::State::Connected) && {
+                const Socket::Handle released = handle;
+                handle = INVALID_SOCKET;
+                return Socket::FromHandle(released, state);
+            }
+
+            /// Returns the address the socket is bound to.
+            Endpoint<F> GetLocalEndpoint() const {
+                Endpoint<F> result;
+                socklen_t size = Endpoint<F>::SIZE;
+                getsockname(handle, result.GetOsAddress(), &size);
+                return result;
+            }
+
+            inline bool IsOpen() const { return handle != INVALID_SOCKET; }
+            inline bool IsValid() const { return IsOpen(); }
+            inline Socket::Handle GetHandle() const { return handle; }
+        };
+    } // namespace Detail
+
+    /// Connected TCP socket.
+    template<Address::Family F>
+    class TcpStream : public Detail::SocketHandle<F, SOCK_STREAM> {
+    private:
+        typedef Detail::SocketHandle<F, SOCK_STREAM> Base;
+        using Base::handle;
+
+        template<Address::Family>
+        friend class TcpListener;
+
+        explicit TcpStream(const Socket::Handle handle) noexcept : Base(handle) {}
+
+    public:
+        TcpStream() noexcept = default;
+
+        /// Returns a valid `TcpStream` connected to `endpoint`, the failure reason goes to `outStatus`.
+        static TcpStream Connect(const Endpoint<F>& endpoint, Status* outStatus = nullptr) {
+            TcpStream result(Base::OpenHandle(outStatus));
+            if (result.IsOpen() && connect(result.handle, endpoint.GetOsAddress(), Endpoint<F>::SIZE) < 0) {
+                if (outStatus != nullptr) *outStatus = Detail::GetLastStatus();
+                result.Close();
+            }
+            return result;
+        }
+
+        inline IoResult Send(const void* dataPtr, const size_t size) {
+            return Detail::MakeIoResult(::send(handle, static_cast<const char*>(dataPtr), size, Detail::SEND_FLAGS));
+        }
+        inline IoResult Send(const std::string_view data) { return Send(data.data(), data.size()); }
+        /// Sends the object representation, only for trivially copyable types.
+        template<typename T>
+        inline IoResult SendValue(const T& value) {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable objects can be sent as bytes");
+            return Send(&value, sizeof(value));
+        }
+
+        /// Sends several buffers with a single system call.
+        inline IoResult SendGather(const IoBuffer* buffers, const uint count) {
+#ifdef _WIN32
+            DWORD sent = 0;
+            const int ret = WSASend(handle, const_cast<IoBuffer*>(buffers), count, &sent, 0, nullptr, nullptr);
+            return Detail::MakeIoResult(ret == 0 ? static_cast<ssize_t>(sent) : -1);
+#else
+            struct msghdr message = {};
+            message.msg_iov = const_cast<IoBuffer*>(buffers);
+            message.msg_iovlen = count;
+            return Detail::MakeIoResult(sendmsg(handle, &message, Detail::SEND_FLAGS));
+#endif
+        }
+
+        /// Receives available data, `size == 0` with `Success` means the peer closed the connection.
+        inline IoResult Receive(void* bufferPtr, const size_t size) {
+            return Detail::MakeIoResult(::recv(handle, static_cast<char*>(bufferPtr), size, 0));
+        }
+        /// Receives the object representation, only for trivially copyable types.
+        template<typename T>
+        inline IoResult ReceiveValue(T& outValue) {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable objects can be received as bytes");
+            return Receive(&outValue, sizeof(outValue));
+        }
+
+        /// Returns the address of the remote side.
+        Endpoint<F> GetRemoteEndpoint() const {
+            Endpoint<F> result;
+            socklen_t size = Endpoint<F>::SIZE;
+            getpeername(handle, result.GetOsAddress(), &size);
+            return result;
+        }
+    };
+
+    /// Listening TCP socket, produces `TcpStream`s of the same family.
+    template<Address::Family F>
+    class TcpListener : public Detail::SocketHandle<F, SOCK_STREAM> {
+    private:
+        typedef Detail::SocketHandle<F, SOCK_STREAM> Base;
+        using Base::handle;
+
+        explicit TcpListener(const Socket::Handle handle) noexcept : Base(handle) {}
+
+    public:
+        TcpListener() noexcept = default;
+
+        /// Returns a valid `TcpListener` bound to `endpoint`, the failure reason goes to `outStatus`.
+        static TcpListener
+        Listen(const Endpoint<F>& endpoint, const int backlog = SOMAXCONN, Status* outStatus = nullptr) {
+            TcpListener result(Base::OpenHandle(outStatus));
+            if (result.IsOpen() == false) [[unlikely]] {
+                return result;
+            }
+
+            result.template Set<SocketOption::ReuseAddress>(true);
+            if (bind(result.handle, endpoint.GetOsAddress(), Endpoint<F>::SIZE) < 0 ||
+                listen(result.handle, backlog) < 0) [[unlikely]] {
+                if (outStatus != nullptr) *outStatus = Detail::GetLastStatus();
+                result.Close();
+            }
+            return result;
+        }
+
+        /// Waits for incoming connection, returned stream is invalid on failure.
+        inline TcpStream<F> Accept(Endpoint<F>* outRemote = nullptr, Status* outStatus = nullptr) {
+            socklen_t size = Endpoint<F>::SIZE;
+            const Socket::Handle accepted =
+                accept(handle, outRemote != nullptr ? outRemote->GetOsAddress() : nullptr, outRemote ? &size : nullptr);
+            if (accepted == INVALID_SOCKET && outStatus != nullptr) [[unlikely]] {
+                *outStatus = Detail::GetLastStatus();
+            }
+            return TcpStream<F>(accepted);
+        }
+    };
+
+    /// UDP socket, datagrams are addressed per call.
+    template<Address::Family F>
+    class UdpSocket : public Detail::SocketHandle<F, SOCK_DGRAM> {
+    private:
+        typedef Detail::SocketHandle<F, SOCK_DGRAM> Base;
+        using Base::handle;
+
+        explicit UdpSocket(const Socket::Handle handle) noexcept : Base(handle) {}
+
+    public:
+        UdpSocket() noexcept = default;
+
+        /// Returns a valid unbound `UdpSocket`, the system binds it on the first send.
+        static UdpSocket Open(Status* outStatus = nullptr) { return UdpSocket(Base::OpenHandle(outStatus)); }
+
+        /// Returns a valid `UdpSocket` bound to `endpoint`, the failure reason goes to `outStatus`.
+        static UdpSocket Bind(const Endpoint<F>& endpoint, Status* outStatus = nullptr) {
+            UdpSocket result(Base::OpenHandle(outStatus));
+            if (result.IsOpen() && bind(result.handle, endpoint.GetOsAddress(), Endpoint<F>::SIZE) < 0) {
+                if (outStatus != nullptr) *outStatus = Detail::GetLastStatus();
+                result.Close();
+            }
+            return result;
+        }
+
+        inline IoResult SendTo(const Endpoint<F>& endpoint, const void* dataPtr, const size_t size) {
+            return Detail::MakeIoResult(::sendto(
+                handle, static_cast<const char*>(dataPtr), size, Detail::SEND_FLAGS, endpoint.GetOsAddress(),
+                Endpoint<F>::SIZE
+            ));
+        }
+        inline IoResult SendTo(const Endpoint<F>& endpoint, const std::string_view data) {
+            return SendTo(endpoint, data.data(), data.size());
+        }
+
+        inline IoResult ReceiveFrom(void* bufferPtr, const size_t size, Endpoint<F>& outEndpoint) {
+            socklen_t addressSize = Endpoint<F>::SIZE;
+            return Detail::MakeIoResult(
+                ::recvfrom(handle, static_cast<char*>(bufferPtr), size, 0, outEndpoint.GetOsAddress(), &addressSize)
+            );
+        }
+    };
+
+    typedef TcpStream<Address::Family::IPv4> TcpStream4;
+    typedef TcpStream<Address::Family::IPv6> TcpStream6;
+    typedef TcpListener<Address::Family::IPv4> TcpListener4;
+    typedef TcpListener<Address::Family::IPv6> TcpListener6;
+    typedef UdpSocket<Address::Family::IPv4> UdpSocket4;
+    typedef UdpSocket<Address::Family::IPv6> UdpSocket6;
+} // namespace Net
+
+#endif
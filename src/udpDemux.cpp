@@ -0,0 +1,232 @@
+#include "udpDemux.h"
+
+#include <chrono>
+#include <system_error>
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+#include "utils.h"
+
+using namespace Net;
+
+static constexpr int POLL_TIMEOUT_MS = 100;
+static constexpr size_t INITIAL_CAPACITY = 64;
+
+// Datagrams are received in batches of `BATCH_SIZE` into `MAX_DATAGRAM_SIZE` slots.
+static constexpr uint BATCH_SIZE = 16;
+static constexpr uint MAX_DATAGRAM_SIZE = 65536;
+// Budget per `Poll()`, so the expiration sweep isn't starved by a flood.
+static constexpr uint MAX_BATCHES = 64;
+
+static uint64_t GetTimeMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+UdpDemux::UdpDemux() : slots(INITIAL_CAPACITY), buffers(BATCH_SIZE * MAX_DATAGRAM_SIZE) {}
+
+UdpDemux::~UdpDemux() = default;
+
+Address::port_t UdpDemux::Bind(const Address& address) {
+    if (socket.Open(address.GetFamily(), Protocol::UDP) == false || socket.Bind(address) == false) [[unlikely]] {
+        socket.Close();
+        return Address::INVALID_PORT;
+    }
+
+    socket.SetNonBlocking();
+    running = true;
+
+    if (address.GetPort() != Address::INVALID_PORT) {
+        return address.GetPort();
+    }
+
+    Address boundAddress;
+    socklen_t addressSize = sizeof(boundAddress.osAddress);
+    if (getsockname(socket.GetHandle(), &boundAddress.osAddress.any, &addressSize) < 0) [[unlikely]] {
+        return Address::INVALID_PORT;
+    }
+
+    return boundAddress.GetPort();
+}
+
+size_t UdpDemux::FindSlot(const Address::Key& key) const {
+    const size_t mask = slots.size() - 1;
+
+    size_t index = key.Hash() & mask;
+    while (slots[index].peer != nullptr && slots[index].key != key) {
+        index = (index + 1) & mask;
+    }
+
+    return index;
+}
+
+void UdpDemux::Grow() {
+    std::vector<Slot> oldSlots(slots.size() * 2);
+    oldSlots.swap(slots);
+
+    for (Slot& slot : oldSlots) {
+        if (slot.peer == nullptr) continue;
+
+        Slot& target = slots[FindSlot(slot.key)];
+        target.key = slot.key;
+        target.peer = std::move(slot.peer);
+    }
+}
+
+void UdpDemux::RemoveSlot(size_t index) {
+    const size_t mask = slots.size() - 1;
+
+    slots[index].peer.reset();
+    --peersCount;
+
+    // Shift the following entries of the cluster back, so lookups never stop at the hole too early.
+    size_t next = (index + 1) & mask;
+    while (slots[next].peer != nullptr) {
+        const size_t home = slots[next].key.Hash() & mask;
+
+        // Entry can move into the hole only if the hole lies between its home and its position.
+        const bool canMove = (next > index) ? (home <= index || home > next) : (home <= index && home > next);
+        if (canMove) {
+            slots[index].key = slots[next].key;
+            slots[index].peer = std::move(slots[next].peer);
+            index = next;
+        }
+
+        next = (next + 1) & mask;
+    }
+}
+
+UdpDemux::Peer* UdpDemux::FindPeer(const Address& address) {
+    Slot& slot = slots[FindSlot(address.GetKey())];
+    return slot.peer.get();
+}
+
+void UdpDemux::Dispatch(const Address& address, const std::string_view datagram, const uint64_t nowMs) {
+    const Address::Key key = address.GetKey();
+    size_t index = FindSlot(key);
+
+    if (slots[index].peer == nullptr) {
+        if (!acceptor) [[unlikely]] {
+            return;
+        }
+
+        auto peer = std::make_unique<Peer>(*this, address);
+        peer->handler = acceptor(*peer);
+        if (!peer->handler || peer->isClosed) {
+            return;
+        }
+
+        // Keep load factor under 1/2, probes stay short.
+        if ((peersCount + 1) * 2 > slots.size()) {
+            Grow();
+            index = FindSlot(key);
+        }
+
+        slots[index].key = key;
+        slots[index].peer = std::move(peer);
+        ++peersCount;
+    }
+
+    Peer& peer = *slots[index].peer;
+    peer.lastActiveMs = nowMs;
+    peer.handler(peer, datagram);
+
+    if (peer.isClosed) {
+        // Handler can't change the table, so the slot is still there.
+        if (expireHandler) expireHandler(peer);
+        RemoveSlot(index);
+    }
+}
+
+void UdpDemux::ExpireIdle(const uint64_t nowMs) {
+    if (idleTimeoutMs == 0 || nowMs - lastSweepMs < idleTimeoutMs / 4) {
+        return;
+    }
+    lastSweepMs = nowMs;
+
+    // Removal shifts the next entries into the current slot, so it's checked again.
+    for (size_t i = 0; i < slots.size();) {
+        Peer* peer = slots[i].peer.get();
+        if (peer != nullptr && nowMs - peer->lastActiveMs >= idleTimeoutMs) {
+            if (expireHandler) expireHandler(*peer);
+            RemoveSlot(i);
+            continue;
+        }
+        ++i;
+    }
+}
+
+uint UdpDemux::Poll(const int timeoutMs) {
+    LIBPOG_ASSERT(socket.IsOpen(), "Socket must be bound");
+
+    uint dispatched = 0;
+
+#ifdef _WIN32
+    WSAPOLLFD pollFd = {socket.GetHandle(), POLLIN, 0};
+    const int ret = WSAPoll(&pollFd, 1, timeoutMs);
+#else
+    struct pollfd pollFd = {socket.GetHandle(), POLLIN, 0};
+    const int ret = poll(&pollFd, 1, timeoutMs);
+#endif
+
+    if (ret > 0) {
+#if defined(__linux__)
+        struct mmsghdr messages[BATCH_SIZE];
+        struct iovec ioBuffers[BATCH_SIZE];
+        Address addresses[BATCH_SIZE];
+
+        for (uint batch = 0; batch < MAX_BATCHES; ++batch) {
+            for (uint i = 0; i < BATCH_SIZE; ++i) {
+                ioBuffers[i] = MakeIoBuffer(buffers.data() + i * MAX_DATAGRAM_SIZE, MAX_DATAGRAM_SIZE);
+
+                std::memset(&messages[i], 0, sizeof(messages[i]));
+                messages[i].msg_hdr.msg_iov = &ioBuffers[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+                messages[i].msg_hdr.msg_name = &addresses[i].osAddress;
+                messages[i].msg_hdr.msg_namelen = sizeof(addresses[i].osAddress);
+            }
+
+            const int count = recvmmsg(socket.GetHandle(), messages, BATCH_SIZE, MSG_DONTWAIT, nullptr);
+            if (count <= 0) {
+                break;
+            }
+
+            const uint64_t nowMs = GetTimeMs();
+            for (int i = 0; i < count; ++i) {
+                // Truncated datagrams are useless.
+                if (messages[i].msg_hdr.msg_flags & MSG_TRUNC) [[unlikely]] continue;
+
+                const std::string_view datagram(static_cast<const char*>(ioBuffers[i].iov_base), messages[i].msg_len);
+                Dispatch(addresses[i], datagram, nowMs);
+                ++dispatched;
+            }
+
+            if (static_cast<uint>(count) < BATCH_SIZE) {
+                break;
+            }
+        }
+#else
+        for (uint i = 0; i < BATCH_SIZE * MAX_BATCHES; ++i) {
+            Address address;
+            const uint received = socket.ReceiveFrom(buffers.data(), MAX_DATAGRAM_SIZE, address);
+            if (received == 0 && socket.Fail() != Success) {
+                break;
+            }
+
+            Dispatch(address, std::string_view(buffers.data(), received), GetTimeMs());
+            ++dispatched;
+        }
+#endif
+    }
+
+    ExpireIdle(GetTimeMs());
+    return dispatched;
+}
+
+void UdpDemux::Run() {
+    while (running) {
+        Poll(POLL_TIMEOUT_MS);
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef _UDPDEMUX_H
+#define _UDPDEMUX_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "socket.h"
+
+namespace Net {
+    /// Serves many UDP peers through a single bound socket.
+    /// Datagrams are received in batches (`recvmmsg` where available) and dispatched to per-peer
+    /// handlers found in an open-addressing flow table keyed by `Address::Key`, replies go through
+    /// the same socket. Flows are expired after being idle for `SetIdleTimeout()`.
+    ///
+    /// Not thread-safe, everything including handlers runs on the thread calling `Poll()`/`Run()`.
+    class UdpDemux {
+    public:
+        class Peer;
+
+        /// Called for every datagram of the peer.
+        typedef std::function<void(Peer& peer, const std::string_view datagram)> Handler;
+        /// Called for the first datagram from unknown peer, returns the handler of its flow.
+        /// Empty handler drops the datagram without creating the flow.
+        typedef std::function<Handler(Peer& peer)> Acceptor;
+        /// Called right before the flow is removed.
+        typedef std::function<void(Peer& peer)> ExpireHandler;
+
+        class Peer {
+        private:
+            UdpDemux& demux;
+            Address address;
+            Handler handler;
+            uint64_t lastActiveMs = 0;
+            bool isClosed = false;
+
+            friend class UdpDemux;
+
+        public:
+            /// Free for the application, e.g. to point at the session state.
+            void* userData = nullptr;
+
+            Peer(UdpDemux& demux, const Address& address) : demux(demux), address(address) {}
+
+            /// Sends the datagram to the peer through the shared socket.
+            inline uint Send(const char* dataPtr, const uint size) {
+                return demux.socket.SendTo(address, dataPtr, size);
+            }
+            inline uint Send(const std::string_view data) { return Send(data.data(), data.size()); }
+
+            /// Removes the flow once the current handler returns.
+            inline void Close() { isClosed = true; }
+
+            inline const Address& GetAddress() const { return address; }
+        };
+
+        static constexpr uint DEFAULT_IDLE_TIMEOUT_MS = 30000;
+
+    private:
+        struct Slot {
+            Address::Key key;
+            std::unique_ptr<Peer> peer;
+        };
+
+        Socket socket;
+        std::atomic<bool> running = false;
+
+        // Power of two sized, linear probing, deletion by backward shift (no tombstones).
+        std::vector<Slot> slots;
+        size_t peersCount = 0;
+
+        Acceptor acceptor;
+        ExpireHandler expireHandler;
+        uint idleTimeoutMs = DEFAULT_IDLE_TIMEOUT_MS;
+        uint64_t lastSweepMs = 0;
+
+        std::vector<char> buffers;
+
+        size_t FindSlot(const Address::Key& key) const;
+        void Grow();
+        void RemoveSlot(size_t index);
+
+        void Dispatch(const Address& address, const std::string_view datagram, const uint64_t nowMs);
+        void ExpireIdle(const uint64_t nowMs);
+
+    public:
+        UdpDemux();
+        ~UdpDemux();
+
+        UdpDemux(const UdpDemux&) = delete;
+
+        /// Binds the shared socket, returns `Address::INVALID_PORT` if failed, actually bound port otherwise.
+        Address::port_t Bind(const Address& address);
+
+        inline void SetAcceptor(Acceptor handler) { acceptor = std::move(handler); }
+        inline void SetExpireHandler(ExpireHandler handler) { expireHandler = std::move(handler); }
+        /// Flows without datagrams for `timeoutMs` are removed, `0` disables expiration.
+        inline void SetIdleTimeout(const uint timeoutMs) { idleTimeoutMs = timeoutMs; }
+
+        /// Waits up to `timeoutMs` for datagrams and dispatches everything received.
+        /// Returns the number of dispatched datagrams.
+        uint Poll(const int timeoutMs);
+        /// Polls until `Stop()`.
+        void Run();
+        /// Asks `Run()` to exit, can be called from any thread.
+        inline void Stop() { running = false; }
+
+        /// Returns the peer of the active flow, `nullptr` if there is none.
+        Peer* FindPeer(const Address& address);
+
+        inline size_t GetPeersCount() const { return peersCount; }
+        inline Socket& GetSocket() { return socket; }
+    };
+} // namespace Net
+
+#endif
@@ -0,0 +1,688 @@
+#include "webSocket.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+#ifndef _WIN32
+#include <poll.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#ifdef LIBPOG_ZLIB
+#include <zlib.h>
+#endif
+
+#include "stringUtils.h"
+#include "utils.h"
+
+using namespace Net;
+
+static constexpr size_t READ_CHUNK_SIZE = 16384;
+// Payload remainder above this size is received straight into the message.
+static constexpr size_t DIRECT_RECEIVE_THRESHOLD = 4096;
+static constexpr size_t DIRECT_RECEIVE_CHUNK = 256 * 1024;
+// Smaller messages aren't worth compressing.
+static constexpr size_t DEFLATE_MIN_SIZE = 64;
+static constexpr uint8_t MAX_CONTROL_PAYLOAD = 125;
+
+// Empty uncompressed block, stripped from every compressed message (RFC 7692, section 7.2.1).
+static constexpr std::string_view DEFLATE_TAIL("\x00\x00\xff\xff", 4);
+
+void WebSocket::ApplyMask(uint8_t* data, const size_t size, const uint8_t mask[4], const size_t offset) {
+    // Rotate the key, so it starts at `data[0]`.
+    uint8_t key[4];
+    for (uint8_t i = 0; i < 4; ++i) {
+        key[i] = mask[(offset + i) & 3];
+    }
+
+    uint32_t key32;
+    std::memcpy(&key32, key, sizeof(key32));
+
+    size_t i = 0;
+#if defined(__AVX2__)
+    const __m256i key256 = _mm256_set1_epi32(static_cast<int>(key32));
+    for (; i + 32 <= size; i += 32) {
+        const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_xor_si256(value, key256));
+    }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+    const __m128i key128 = _mm_set1_epi32(static_cast<int>(key32));
+    for (; i + 16 <= size; i += 16) {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), _mm_xor_si128(value, key128));
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t key128 = vreinterpretq_u8_u32(vdupq_n_u32(key32));
+    for (; i + 16 <= size; i += 16) {
+        vst1q_u8(data + i, veorq_u8(vld1q_u8(data + i), key128));
+    }
+#endif
+
+    // Chunks above are multiples of 4, so the key is still aligned with `i`.
+    const uint64_t key64 = (static_cast<uint64_t>(key32) << 32) | key32;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t value;
+        std::memcpy(&value, data + i, sizeof(value));
+        value ^= key64;
+        std::memcpy(data + i, &value, sizeof(value));
+    }
+    for (; i < size; ++i) {
+        data[i] ^= key[i & 3];
+    }
+}
+
+std::string WebSocket::MakeKey() {
+    unsigned char nonce[16];
+    RAND_bytes(nonce, sizeof(nonce));
+
+    std::string result(24, '\0');
+    EVP_EncodeBlock(reinterpret_cast<unsigned char*>(result.data()), nonce, sizeof(nonce));
+    return result;
+}
+
+std::string WebSocket::MakeAcceptKey(const std::string_view key) {
+    std::string source;
+    source.reserve(key.size() + GUID.size());
+    source.append(key).append(GUID);
+
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestSize = 0;
+    EVP_Digest(source.data(), source.size(), digest, &digestSize, EVP_sha1(), nullptr);
+
+    std::string result(4 * ((digestSize + 2) / 3), '\0');
+    EVP_EncodeBlock(reinterpret_cast<unsigned char*>(result.data()), digest, digestSize);
+    return result;
+}
+
+static std::string_view TrimSpaces(std::string_view string) {
+    while (!string.empty() && (string.front() == ' ' || string.front() == '\t')) string.remove_prefix(1);
+    while (!string.empty() && (string.back() == ' ' || string.back() == '\t')) string.remove_suffix(1);
+
+    return string;
+}
+
+static bool ParseWindowBits(const std::string_view value, uint8_t& outBits) {
+    const std::string_view digits = TrimSpaces(value);
+    const char* end = digits.data() + digits.size();
+
+    // zlib can't produce raw deflate streams with 256 bytes window, so 8 isn't accepted.
+    return std::from_chars(digits.data(), end, outBits).ptr == end && outBits >= 9 && outBits <= 15;
+}
+
+bool WebSocket::ParseDeflate(const std::string_view header, Deflate& outDeflate) {
+    size_t extensionBegin = 0;
+    while (extensionBegin < header.size()) {
+        size_t extensionEnd = header.find(',', extensionBegin);
+        if (extensionEnd == std::string_view::npos) extensionEnd = header.size();
+
+        const std::string_view extension = header.substr(extensionBegin, extensionEnd - extensionBegin);
+        extensionBegin = extensionEnd + 1;
+
+        size_t paramEnd = extension.find(';');
+        if (TrimSpaces(extension.substr(0, paramEnd)) != DEFLATE_EXTENSION) {
+            continue;
+        }
+
+        outDeflate = Deflate();
+        outDeflate.isEnabled = true;
+
+        while (paramEnd != std::string_view::npos) {
+            const size_t paramBegin = paramEnd + 1;
+            paramEnd = extension.find(';', paramBegin);
+
+            const std::string_view param = extension.substr(paramBegin, paramEnd - paramBegin);
+            const size_t equals = param.find('=');
+            const std::string_view name = TrimSpaces(param.substr(0, equals));
+            const std::string_view value =
+                (equals == std::string_view::npos) ? std::string_view() : param.substr(equals + 1);
+
+            if (name == "server_no_context_takeover") {
+                outDeflate.serverNoContextTakeover = true;
+            } else if (name == "client_no_context_takeover") {
+                outDeflate.clientNoContextTakeover = true;
+            } else if (name == "server_max_window_bits") {
+                if (ParseWindowBits(value, outDeflate.serverMaxWindowBits) == false) return false;
+            } else if (name == "client_max_window_bits") {
+                // Without value it only tells that the client supports the parameter.
+                if (value.empty() == false && ParseWindowBits(value, outDeflate.clientMaxWindowBits) == false) {
+                    return false;
+                }
+            } else {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+std::string WebSocket::FormatDeflate(const Deflate& deflate) {
+    std::string result(DEFLATE_EXTENSION);
+
+    if (deflate.serverNoContextTakeover) result += "; server_no_context_takeover";
+    if (deflate.clientNoContextTakeover) result += "; client_no_context_takeover";
+    if (deflate.serverMaxWindowBits != 15) {
+        result += "; server_max_window_bits=" + std::to_string(deflate.serverMaxWindowBits);
+    }
+    if (deflate.clientMaxWindowBits != 15) {
+        result += "; client_max_window_bits=" + std::to_string(deflate.clientMaxWindowBits);
+    }
+
+    return result;
+}
+
+bool WebSocket::IsDeflateSupported() {
+#ifdef LIBPOG_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef LIBPOG_ZLIB
+/// Per-connection `permessage-deflate` state, zlib streams are kept between messages
+/// unless the "no context takeover" parameter was negotiated for that direction.
+struct WebSocket::Compression {
+    z_stream deflater = {};
+    z_stream inflater = {};
+    bool isDeflaterReset;
+    bool isInflaterReset;
+
+    Compression(const Deflate& deflate, const Role role) {
+        const bool isClient = role == Role::Client;
+        isDeflaterReset = isClient ? deflate.clientNoContextTakeover : deflate.serverNoContextTakeover;
+        isInflaterReset = isClient ? deflate.serverNoContextTakeover : deflate.clientNoContextTakeover;
+
+        const int windowBits = isClient ? deflate.clientMaxWindowBits : deflate.serverMaxWindowBits;
+        deflateInit2(&deflater, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -windowBits, 8, Z_DEFAULT_STRATEGY);
+        inflateInit2(&inflater, -15);
+    }
+
+    ~Compression() {
+        deflateEnd(&deflater);
+        inflateEnd(&inflater);
+    }
+
+    bool Compress(const std::string_view data, std::string& out) {
+        out.resize(deflateBound(&deflater, data.size()) + 16);
+
+        deflater.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        deflater.avail_in = static_cast<uInt>(data.size());
+        deflater.next_out = reinterpret_cast<Bytef*>(out.data());
+        deflater.avail_out = static_cast<uInt>(out.size());
+
+        if (deflate(&deflater, Z_SYNC_FLUSH) != Z_OK || deflater.avail_in != 0) [[unlikely]] {
+            return false;
+        }
+
+        out.resize(out.size() - deflater.avail_out);
+        if (out.size() >= DEFLATE_TAIL.size()) {
+            out.resize(out.size() - DEFLATE_TAIL.size());
+        }
+
+        if (isDeflaterReset) deflateReset(&deflater);
+        return true;
+    }
+
+    bool Decompress(std::string& data, std::string& out, const size_t maxSize) {
+        data.append(DEFLATE_TAIL);
+
+        inflater.next_in = reinterpret_cast<Bytef*>(data.data());
+        inflater.avail_in = static_cast<uInt>(data.size());
+
+        out.clear();
+        while (inflater.avail_in > 0) {
+            const size_t oldSize = out.size();
+            out.resize(std::max<size_t>(oldSize * 2, data.size() * 4));
+
+            inflater.next_out = reinterpret_cast<Bytef*>(out.data() + oldSize);
+            inflater.avail_out = static_cast<uInt>(out.size() - oldSize);
+
+            const int ret = inflate(&inflater, Z_SYNC_FLUSH);
+            out.resize(out.size() - inflater.avail_out);
+
+            if ((ret != Z_OK && ret != Z_BUF_ERROR) || out.size() > maxSize) [[unlikely]] {
+                return false;
+            }
+        }
+
+        if (isInflaterReset) inflateReset(&inflater);
+        return true;
+    }
+};
+#else
+struct WebSocket::Compression {
+    Compression(const Deflate&, const Role) {}
+
+    bool Compress(const std::string_view, std::string&) { return false; }
+    bool Decompress(std::string&, std::string&, const size_t) { return false; }
+};
+#endif
+
+WebSocket::WebSocket() noexcept = default;
+WebSocket::WebSocket(WebSocket&& other) noexcept = default;
+WebSocket& WebSocket::operator=(WebSocket&& other) noexcept = default;
+
+WebSocket::~WebSocket() {
+    if (IsOpen()) Close(CloseCode::GoingAway);
+}
+
+WebSocket::WebSocket(
+    Socket&& socket,
+    const Role role,
+    const std::string_view bufferedInput,
+    const Deflate& deflate,
+    const Options& options
+)
+    : socket(std::move(socket)), role(role), options(options), input(bufferedInput) {
+    if (deflate.isEnabled && IsDeflateSupported()) {
+        compression = std::make_unique<Compression>(deflate, role);
+    }
+}
+
+int WebSocket::ParseFrameHeader() {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(input.data() + inputOffset);
+    const size_t available = input.size() - inputOffset;
+    if (available < 2) {
+        return 0;
+    }
+
+    const uint8_t lengthCode = data[1] & 0x7f;
+    const bool isFrameMasked = (data[1] & 0x80) != 0;
+
+    size_t headerSize = 2;
+    if (lengthCode == 126) {
+        headerSize += 2;
+    } else if (lengthCode == 127) {
+        headerSize += 8;
+    }
+    if (isFrameMasked) {
+        headerSize += 4;
+    }
+    if (available < headerSize) {
+        return 0;
+    }
+
+    uint64_t length = lengthCode;
+    if (lengthCode == 126) {
+        length = (static_cast<uint64_t>(data[2]) << 8) | data[3];
+    } else if (lengthCode == 127) {
+        length = 0;
+        for (uint8_t i = 0; i < 8; ++i) length = (length << 8) | data[2 + i];
+    }
+
+    const bool isFin = (data[0] & 0x80) != 0;
+    const bool isRsv1 = (data[0] & 0x40) != 0;
+    const auto opcode = static_cast<Opcode>(data[0] & 0x0f);
+    const bool isControl = (data[0] & 0x08) != 0;
+
+    // Only server receives masked frames, RSV1 is allowed for the first frame of compressed message only.
+    bool isValid = (data[0] & 0x30) == 0 && isFrameMasked == (role == Role::Server);
+    // The most significant bit of 64-bit length must be zero.
+    if (length >> 63 != 0) {
+        isValid = false;
+    }
+    if (isRsv1 && (compression == nullptr || isControl || opcode == Opcode::Continuation)) {
+        isValid = false;
+    }
+
+    if (isControl) {
+        isValid = isValid && isFin && length <= MAX_CONTROL_PAYLOAD &&
+                  (opcode == Opcode::Close || opcode == Opcode::Ping || opcode == Opcode::Pong);
+    } else if (opcode == Opcode::Continuation) {
+        isValid = isValid && messageOpcode != Opcode::Continuation;
+    } else if (opcode == Opcode::Text || opcode == Opcode::Binary) {
+        isValid = isValid && messageOpcode == Opcode::Continuation;
+    } else {
+        isValid = false;
+    }
+
+    if (isValid == false) [[unlikely]] {
+        Fail(CloseCode::ProtocolError);
+        return -1;
+    }
+    if (isControl == false && length > options.maxMessageSize - messageData.size()) [[unlikely]] {
+        Fail(CloseCode::MessageTooBig);
+        return -1;
+    }
+
+    if (isControl == false && opcode != Opcode::Continuation) {
+        messageOpcode = opcode;
+        isCompressedMessage = isRsv1;
+    }
+
+    hasFrame = true;
+    isFinal = isFin;
+    frameOpcode = opcode;
+    frameRemaining = length;
+    isMasked = isFrameMasked;
+    maskOffset = 0;
+    if (isFrameMasked) {
+        std::memcpy(mask, data + headerSize - 4, 4);
+    }
+
+    return static_cast<int>(headerSize);
+}
+
+bool WebSocket::ReadMore() {
+    if (inputOffset == input.size()) {
+        input.clear();
+    } else {
+        input.erase(0, inputOffset);
+    }
+    inputOffset = 0;
+
+    if (WaitInput() == false) {
+        return false;
+    }
+
+    const size_t oldSize = input.size();
+    input.resize(oldSize + READ_CHUNK_SIZE);
+
+    const uint received = socket.Receive(input.data() + oldSize, READ_CHUNK_SIZE);
+    input.resize(oldSize + received);
+
+    if (received == 0) {
+        // Peer is gone without the closing handshake.
+        closeCode = CloseCode::Abnormal;
+        isCloseReceived = true;
+        socket.Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool WebSocket::WaitInput() {
+    if (closeDeadline == std::chrono::steady_clock::time_point::max()) {
+        return true;
+    }
+
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(
+        closeDeadline - std::chrono::steady_clock::now()
+    );
+    const int timeoutMs = static_cast<int>(std::max<int64_t>(remaining.count(), 0));
+
+#ifdef _WIN32
+    WSAPOLLFD pollFd = {socket.GetHandle(), POLLIN, 0};
+    const int ret = WSAPoll(&pollFd, 1, timeoutMs);
+#else
+    struct pollfd pollFd = {socket.GetHandle(), POLLIN, 0};
+    const int ret = poll(&pollFd, 1, timeoutMs);
+#endif
+
+    if (ret <= 0) [[unlikely]] {
+        // Peer didn't complete the closing handshake in time.
+        socket.Close();
+        return false;
+    }
+    return true;
+}
+
+bool WebSocket::OnControlFrame() {
+    switch (frameOpcode) {
+        case Opcode::Ping:
+            if (isCloseSent == false) {
+                SendFrame(Opcode::Pong, controlData, false);
+            }
+            break;
+        case Opcode::Close: {
+            isCloseReceived = true;
+
+            if (controlData.size() == 1) [[unlikely]] {
+                closeCode = CloseCode::ProtocolError;
+            } else if (controlData.size() >= 2) {
+                const uint8_t* payload = reinterpret_cast<const uint8_t*>(controlData.data());
+                closeCode = static_cast<CloseCode>((payload[0] << 8) | payload[1]);
+            } else {
+                closeCode = CloseCode::NoStatus;
+            }
+
+            // Echo the status code to complete the closing handshake.
+            if (isCloseSent == false) {
+                isCloseSent = true;
+                SendFrame(Opcode::Close, std::string_view(controlData).substr(0, 2), false);
+            }
+
+            socket.Close();
+            return false;
+        }
+        default:
+            break;
+    }
+
+    return true;
+}
+
+void WebSocket::Fail(const CloseCode code) {
+    closeCode = code;
+
+    if (isCloseSent == false && socket.IsOpen()) {
+        const char payload[2] = {static_cast<char>(static_cast<uint16_t>(code) >> 8), static_cast<char>(code)};
+        isCloseSent = true;
+        SendFrame(Opcode::Close, std::string_view(payload, sizeof(payload)), false);
+    }
+
+    socket.Close();
+}
+
+bool WebSocket::SendFrame(const Opcode opcode, const std::string_view payload, const bool isCompressed) {
+    uint8_t header[14];
+    size_t headerSize = 2;
+
+    header[0] = 0x80 | (isCompressed ? 0x40 : 0) | static_cast<uint8_t>(opcode);
+    if (payload.size() < 126) {
+        header[1] = static_cast<uint8_t>(payload.size());
+    } else if (payload.size() <= UINT16_MAX) {
+        header[1] = 126;
+        header[2] = static_cast<uint8_t>(payload.size() >> 8);
+        header[3] = static_cast<uint8_t>(payload.size());
+        headerSize = 4;
+    } else {
+        header[1] = 127;
+        for (uint8_t i = 0; i < 8; ++i) {
+            header[2 + i] = static_cast<uint8_t>(static_cast<uint64_t>(payload.size()) >> (56 - 8 * i));
+        }
+        headerSize = 10;
+    }
+
+    if (role == Role::Client) {
+        // Client frames are masked, so the payload has to be copied anyway.
+        // Masking keys must be unpredictable (RFC 6455, section 5.3).
+        if (RAND_bytes(header + headerSize, 4) != 1) [[unlikely]] {
+            return false;
+        }
+        header[1] |= 0x80;
+
+        output.assign(reinterpret_cast<const char*>(header), headerSize + 4);
+        output.append(payload);
+        ApplyMask(reinterpret_cast<uint8_t*>(output.data()) + headerSize + 4, payload.size(), header + headerSize);
+
+        size_t sent = 0;
+        while (sent < output.size()) {
+            const uint ret = socket.Send(output.data() + sent, static_cast<uint>(output.size() - sent));
+            if (ret == 0) return false;
+            sent += ret;
+        }
+        return true;
+    }
+
+    IoBuffer buffers[2] = {
+        MakeIoBuffer(reinterpret_cast<const char*>(header), headerSize),
+        MakeIoBuffer(payload.data(), payload.size())
+    };
+
+    size_t sent = socket.SendGather(buffers, payload.empty() ? 1 : 2);
+    if (sent == 0) return false;
+
+    // Gathered send can be partial, finish the rest piece by piece.
+    while (sent < headerSize + payload.size()) {
+        const uint ret = (sent < headerSize)
+                             ? socket.Send(reinterpret_cast<const char*>(header) + sent, headerSize - sent)
+                             : socket.Send(payload.data() + sent - headerSize, payload.size() - (sent - headerSize));
+        if (ret == 0) return false;
+        sent += ret;
+    }
+
+    return true;
+}
+
+bool WebSocket::Send(const std::string_view data, const Opcode opcode) {
+    LIBPOG_ASSERT(opcode == Opcode::Text || opcode == Opcode::Binary, "Only data messages can be sent");
+
+    if (IsOpen() == false) [[unlikely]] {
+        return false;
+    }
+
+    if (compression != nullptr && data.size() >= DEFLATE_MIN_SIZE) {
+        std::string compressed;
+        if (compression->Compress(data, compressed)) {
+            return SendFrame(opcode, compressed, true);
+        }
+    }
+
+    return SendFrame(opcode, data, false);
+}
+
+bool WebSocket::Ping(const std::string_view payload) {
+    if (IsOpen() == false || payload.size() > MAX_CONTROL_PAYLOAD) [[unlikely]] {
+        return false;
+    }
+
+    return SendFrame(Opcode::Ping, payload, false);
+}
+
+bool WebSocket::Receive(Message& outMessage) {
+    while (socket.IsOpen() && isCloseReceived == false) {
+        if (hasFrame == false) {
+            const int headerSize = ParseFrameHeader();
+            if (headerSize < 0) {
+                return false;
+            }
+            if (headerSize == 0) {
+                if (ReadMore() == false) return false;
+                continue;
+            }
+
+            inputOffset += headerSize;
+        }
+
+        const bool isControl = (static_cast<uint8_t>(frameOpcode) & 0x08) != 0;
+        std::string& target = isControl ? controlData : messageData;
+
+        // Take whatever is already buffered.
+        const size_t available = std::min<uint64_t>(input.size() - inputOffset, frameRemaining);
+        if (available > 0) {
+            const size_t oldSize = target.size();
+            target.append(input, inputOffset, available);
+            if (isMasked) {
+                ApplyMask(reinterpret_cast<uint8_t*>(target.data()) + oldSize, available, mask, maskOffset);
+            }
+
+            inputOffset += available;
+            maskOffset += available;
+            frameRemaining -= available;
+        }
+
+        if (frameRemaining > 0) {
+            if (frameRemaining < DIRECT_RECEIVE_THRESHOLD) {
+                if (ReadMore() == false) return false;
+                continue;
+            }
+
+            // Input buffer is drained here, receive the large payload directly into the message.
+            if (WaitInput() == false) {
+                return false;
+            }
+            const size_t chunk = std::min<uint64_t>(frameRemaining, DIRECT_RECEIVE_CHUNK);
+            const size_t oldSize = target.size();
+            target.resize(oldSize + chunk);
+
+            const uint received = socket.Receive(target.data() + oldSize, static_cast<uint>(chunk));
+            target.resize(oldSize + received);
+            if (received == 0) {
+                closeCode = CloseCode::Abnormal;
+                isCloseReceived = true;
+                socket.Close();
+                return false;
+            }
+
+            if (isMasked) {
+                ApplyMask(reinterpret_cast<uint8_t*>(target.data()) + oldSize, received, mask, maskOffset);
+            }
+            maskOffset += received;
+            frameRemaining -= received;
+            continue;
+        }
+
+        hasFrame = false;
+
+        if (isControl) {
+            const bool isOpen = OnControlFrame();
+            controlData.clear();
+            if (isOpen == false) return false;
+            continue;
+        }
+        if (isFinal == false) {
+            continue;
+        }
+
+        outMessage.opcode = messageOpcode;
+        messageOpcode = Opcode::Continuation;
+
+        if (isCompressedMessage) {
+            if (compression->Decompress(messageData, outMessage.data, options.maxMessageSize) == false) {
+                Fail(CloseCode::InvalidPayload);
+                return false;
+            }
+            messageData.clear();
+        } else {
+            outMessage.data.swap(messageData);
+            messageData.clear();
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+void WebSocket::Close(const CloseCode code, const std::string_view reason) {
+    if (socket.IsOpen() == false) {
+        return;
+    }
+
+    if (isCloseSent == false) {
+        std::string payload;
+        payload.push_back(static_cast<char>(static_cast<uint16_t>(code) >> 8));
+        payload.push_back(static_cast<char>(code));
+        payload.append(reason.substr(0, MAX_CONTROL_PAYLOAD - 2));
+
+        isCloseSent = true;
+        closeCode = code;
+        SendFrame(Opcode::Close, payload, false);
+    }
+
+    // Wait for the peer's close frame, data messages received meanwhile are dropped.
+    closeDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.closeTimeoutMs);
+    Message message;
+    while (isCloseReceived == false && socket.IsOpen()) {
+        Receive(message);
+    }
+
+    socket.Close();
+}
@@ -0,0 +1,167 @@
+#ifndef _WEBSOCKET_H
+#define _WEBSOCKET_H
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "socket.h"
+
+namespace Net {
+    /// WebSocket (RFC 6455) connection over already upgraded `Socket`, works for both sides.
+    /// Use `HttpClient::UpgradeToWebSocket()` on the client side and
+    /// `HttpResponseWriter::AcceptWebSocket()` on the server side to get one.
+    ///
+    /// Frames are parsed incrementally: payload goes straight from the socket into the message
+    /// and is unmasked in place, large payloads are received directly into the message buffer.
+    class WebSocket {
+    public:
+        enum class Role : uint8_t {
+            Client,
+            Server
+        };
+        enum class Opcode : uint8_t {
+            Continuation = 0x0,
+            Text = 0x1,
+            Binary = 0x2,
+            Close = 0x8,
+            Ping = 0x9,
+            Pong = 0xa,
+        };
+        enum class CloseCode : uint16_t {
+            Normal = 1000,
+            GoingAway = 1001,
+            ProtocolError = 1002,
+            UnsupportedData = 1003,
+            NoStatus = 1005,
+            Abnormal = 1006,
+            InvalidPayload = 1007,
+            PolicyViolation = 1008,
+            MessageTooBig = 1009,
+            InternalError = 1011,
+        };
+
+        struct Message {
+            Opcode opcode = Opcode::Text;
+            std::string data;
+
+            inline bool IsText() const { return opcode == Opcode::Text; }
+            inline bool IsBinary() const { return opcode == Opcode::Binary; }
+        };
+
+        /// Negotiated `permessage-deflate` (RFC 7692) parameters.
+        struct Deflate {
+            bool isEnabled = false;
+            bool clientNoContextTakeover = false;
+            bool serverNoContextTakeover = false;
+            uint8_t clientMaxWindowBits = 15;
+            uint8_t serverMaxWindowBits = 15;
+        };
+
+        struct Options {
+            /// Offer/accept `permessage-deflate`, available if the library is built with zlib.
+            bool usePerMessageDeflate = false;
+            size_t maxMessageSize = 64 * 1024 * 1024;
+            /// How long `Close()` waits for the peer's close frame before closing the socket anyway.
+            uint closeTimeoutMs = 5000;
+        };
+
+        static constexpr std::string_view GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+        static constexpr std::string_view DEFLATE_EXTENSION = "permessage-deflate";
+
+        /// XORs `data` with 4-byte `mask` in place, `offset` is the position of `data` within the payload.
+        /// Uses SIMD (AVX2, SSE2 or NEON) where it's available at compile time.
+        static void ApplyMask(uint8_t* data, const size_t size, const uint8_t mask[4], const size_t offset = 0);
+
+        /// Returns random base64-encoded `Sec-WebSocket-Key`.
+        static std::string MakeKey();
+        /// Returns `Sec-WebSocket-Accept` value for the key.
+        static std::string MakeAcceptKey(const std::string_view key);
+
+        /// Parses `Sec-WebSocket-Extensions` header looking for `permessage-deflate`.
+        /// Returns `false` if the extension isn't there or has invalid parameters.
+        static bool ParseDeflate(const std::string_view header, Deflate& outDeflate);
+        /// Formats `permessage-deflate` parameters for `Sec-WebSocket-Extensions` header.
+        static std::string FormatDeflate(const Deflate& deflate);
+        /// Returns `true` if the library supports `permessage-deflate` (built with zlib).
+        static bool IsDeflateSupported();
+
+    private:
+        struct Compression;
+
+        Socket socket;
+        Role role = Role::Client;
+        Options options;
+        std::unique_ptr<Compression> compression;
+
+        std::string input;
+        size_t inputOffset = 0;
+
+        // Currently parsed frame.
+        bool hasFrame = false;
+        bool isFinal = false;
+        bool isCompressedMessage = false;
+        Opcode frameOpcode = Opcode::Continuation;
+        uint8_t mask[4] = {};
+        bool isMasked = false;
+        uint64_t frameRemaining = 0;
+        size_t maskOffset = 0;
+
+        // Message being assembled and control frame payload (can interleave fragments).
+        Opcode messageOpcode = Opcode::Continuation;
+        std::string messageData;
+        std::string controlData;
+
+        std::string output;
+
+        bool isCloseSent = false;
+        bool isCloseReceived = false;
+        CloseCode closeCode = CloseCode::NoStatus;
+        /// Set by `Close()`, reads give up once it passes.
+        std::chrono::steady_clock::time_point closeDeadline = std::chrono::steady_clock::time_point::max();
+
+        int ParseFrameHeader();
+        bool ReadMore();
+        /// Waits for input until the close deadline if there is one, closes the socket when it passes.
+        bool WaitInput();
+        bool OnControlFrame();
+        void Fail(const CloseCode code);
+
+        bool SendFrame(const Opcode opcode, const std::string_view payload, const bool isCompressed);
+
+    public:
+        WebSocket() noexcept;
+        /// Takes over the socket after successful handshake.
+        /// - `bufferedInput`: bytes received after the handshake, they belong to the first frames.
+        WebSocket(
+            Socket&& socket,
+            const Role role,
+            const std::string_view bufferedInput,
+            const Deflate& deflate,
+            const Options& options
+        );
+        WebSocket(WebSocket&& other) noexcept;
+        WebSocket& operator=(WebSocket&& other) noexcept;
+        ~WebSocket();
+
+        bool Send(const std::string_view data, const Opcode opcode = Opcode::Text);
+        inline bool SendText(const std::string_view text) { return Send(text, Opcode::Text); }
+        inline bool SendBinary(const std::string_view data) { return Send(data, Opcode::Binary); }
+        bool Ping(const std::string_view payload = {});
+
+        /// Waits for the next complete text or binary message, control frames are handled inside.
+        /// Returns `false` if the connection was closed or failed, see `GetCloseCode()`.
+        bool Receive(Message& outMessage);
+
+        /// Performs closing handshake and closes the socket, waits for the peer at most `Options::closeTimeoutMs`.
+        void Close(const CloseCode code = CloseCode::Normal, const std::string_view reason = {});
+
+        inline bool IsOpen() const { return socket.IsOpen() && !isCloseSent && !isCloseReceived; }
+        inline bool IsCompressed() const { return compression != nullptr; }
+        inline CloseCode GetCloseCode() const { return closeCode; }
+        inline Role GetRole() const { return role; }
+    };
+} // namespace Net
+
+#endif
@@ -0,0 +1,213 @@
+#include "../src/hpack.h"
+#include "../src/http2Client.h"
+#include "../src/http2Frame.h"
+#include "../src/utils.h"
+
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+
+typedef Net::Http2Frame Frame;
+
+// Minimal h2c (prior knowledge) server, enough to check `Http2Client` offline.
+// Responds to every request with the request body, or with the path if the body is empty.
+// Keeps the default 64KB receive window, so large uploads exercise client flow control.
+class Http2TestServer {
+private:
+    struct Stream {
+        std::string path;
+        std::string body;
+        size_t headerSize = 0;
+    };
+
+    Net::Socket listener;
+    std::thread thread;
+    std::atomic<uint> connections = 0;
+
+    static void Serve(Net::Socket& socket) {
+        Net::HpackDecoder decoder;
+        Net::HpackEncoder encoder;
+        std::map<uint32_t, Stream> streams;
+
+        std::string input;
+        std::string output;
+        std::string headerBlock;
+        uint32_t headerStreamId = 0;
+        bool isHeaderEndStream = false;
+        bool isPrefaceReceived = false;
+
+        // Up to 8 concurrent streams, so the client has to queue the rest.
+        Frame::AppendHeader(output, 6, Frame::Type::Settings, 0, 0);
+        Frame::AppendSetting(output, Frame::Setting::MaxConcurrentStreams, 8);
+
+        const auto respond = [&](const uint32_t streamId) {
+            Stream& stream = streams[streamId];
+            const std::string& body = stream.body.empty() ? stream.path : stream.body;
+
+            std::string block;
+            encoder.Encode(
+                {{":status", "200"},
+                 {"content-type", "text/plain"},
+                 {"x-header-size", std::to_string(stream.headerSize)}},
+                block
+            );
+            Frame::AppendHeader(output, block.size(), Frame::Type::Headers, Frame::EndHeaders, streamId);
+            output += block;
+
+            for (size_t offset = 0; offset < body.size() || offset == 0;) {
+                const size_t chunk = std::min<size_t>(body.size() - offset, Frame::DEFAULT_MAX_FRAME_SIZE);
+                const bool isLast = offset + chunk == body.size();
+                Frame::AppendHeader(output, chunk, Frame::Type::Data, isLast ? Frame::EndStream : 0, streamId);
+                output.append(body, offset, chunk);
+                offset += chunk;
+                if (isLast) break;
+            }
+            streams.erase(streamId);
+        };
+
+        const auto onHeaders = [&](const uint32_t streamId, const bool isEndStream) {
+            std::vector<Net::HeaderField> fields;
+            const uint8_t* block = reinterpret_cast<const uint8_t*>(headerBlock.data());
+            const bool isDecoded = decoder.Decode(block, headerBlock.size(), fields);
+            LIBPOG_ASSERT(isDecoded, "Header block must decode");
+
+            Stream& stream = streams[streamId];
+            for (const Net::HeaderField& field : fields) {
+                if (field.name == ":path") stream.path = field.value;
+                stream.headerSize += field.name.size() + field.value.size();
+            }
+            if (isEndStream) respond(streamId);
+        };
+
+        DataBuffer buffer;
+        while (true) {
+            if (!output.empty()) {
+                socket.Send(output.data(), output.size());
+                output.clear();
+            }
+
+            buffer.size = socket.Receive(buffer, DataBuffer::MAX_SIZE);
+            if (buffer.size == 0) return;
+            input.append(buffer, buffer.size);
+
+            if (!isPrefaceReceived) {
+                if (input.size() < Frame::PREFACE.size()) continue;
+                LIBPOG_ASSERT(input.compare(0, Frame::PREFACE.size(), Frame::PREFACE) == 0, "Client must send preface");
+                input.erase(0, Frame::PREFACE.size());
+                isPrefaceReceived = true;
+            }
+
+            while (input.size() >= Frame::HEADER_SIZE) {
+                const uint8_t* data = reinterpret_cast<const uint8_t*>(input.data());
+                const Frame frame = Frame::Parse(data);
+                if (input.size() < Frame::HEADER_SIZE + frame.length) break;
+
+                const uint8_t* payload = data + Frame::HEADER_SIZE;
+                switch (frame.type) {
+                    case Frame::Type::Settings:
+                        if (!frame.HasFlag(Frame::Ack)) {
+                            Frame::AppendHeader(output, 0, Frame::Type::Settings, Frame::Ack, 0);
+                        }
+                        break;
+                    case Frame::Type::Headers:
+                    case Frame::Type::Continuation:
+                        if (frame.type == Frame::Type::Headers) {
+                            headerBlock.clear();
+                            headerStreamId = frame.streamId;
+                            isHeaderEndStream = frame.HasFlag(Frame::EndStream);
+                        }
+                        headerBlock.append(reinterpret_cast<const char*>(payload), frame.length);
+                        if (frame.HasFlag(Frame::EndHeaders)) onHeaders(headerStreamId, isHeaderEndStream);
+                        break;
+                    case Frame::Type::Data:
+                        streams[frame.streamId].body.append(reinterpret_cast<const char*>(payload), frame.length);
+                        if (frame.length > 0) {
+                            Frame::AppendWindowUpdate(output, 0, frame.length);
+                            Frame::AppendWindowUpdate(output, frame.streamId, frame.length);
+                        }
+                        if (frame.HasFlag(Frame::EndStream)) respond(frame.streamId);
+                        break;
+                    case Frame::Type::GoAway:
+                        return;
+                    default:
+                        break;
+                }
+
+                input.erase(0, Frame::HEADER_SIZE + frame.length);
+            }
+        }
+    }
+
+public:
+    Net::Address::port_t Start() {
+        listener.Open(Net::Address::Family::IPv4, Net::Protocol::TCP);
+        const Net::Address::port_t port = listener.Listen(Net::Address::FromString("127.0.0.1", 0));
+
+        thread = std::thread([this]() {
+            while (true) {
+                Net::Socket socket = listener.Accept();
+                if (!socket.IsValid()) return;
+
+                ++connections;
+                Serve(socket);
+            }
+        });
+        return port;
+    }
+
+    void Stop() {
+        shutdown(listener.GetHandle(), SHUT_RDWR);
+        thread.join();
+    }
+
+    inline uint GetConnections() const { return connections; }
+};
+
+int main() {
+    Http2TestServer server;
+    const Net::Address::port_t port = server.Start();
+    LIBPOG_ASSERT(port != Net::Address::INVALID_PORT, "Server must listen");
+
+    Net::Http2Client client;
+    if (client.Connect("127.0.0.1", port) != Net::Success) {
+        std::cerr << "Failed to connect." << std::endl;
+        return -1;
+    }
+
+    // Many concurrent streams over one connection.
+    constexpr uint STREAMS_COUNT = 100;
+    for (uint i = 0; i < STREAMS_COUNT; ++i) {
+        client.Submit("GET", "/item/" + std::to_string(i));
+    }
+
+    std::vector<Net::Http2Response> responses;
+    client.WaitAll(responses);
+    LIBPOG_ASSERT(responses.size() == STREAMS_COUNT, "All streams must complete");
+    for (const Net::Http2Response& response : responses) {
+        LIBPOG_ASSERT(!response.isFailed && response.status == 200, "Stream must succeed");
+        LIBPOG_ASSERT(response.body.compare(0, 6, "/item/") == 0, "Body must echo path");
+    }
+    std::cout << "Concurrent streams: " << responses.size() << " completed." << std::endl;
+
+    // Upload larger than the server window, needs flow control.
+    const std::string upload(300000, 'u');
+    Net::Http2Response echo = client.Request("POST", "/upload", {{"content-type", "text/plain"}}, upload);
+    LIBPOG_ASSERT(!echo.isFailed && echo.body == upload, "Upload must be echoed");
+    std::cout << "Upload: " << echo.body.size() << " bytes echoed." << std::endl;
+
+    // Header block larger than a frame goes into `CONTINUATION` frames.
+    const std::string bigValue(40000, 'h');
+    Net::Http2Response big = client.Request("GET", "/big", {{"x-big", bigValue}});
+    LIBPOG_ASSERT(!big.isFailed && big.status == 200, "Big headers request must succeed");
+    std::cout << "Big header block: " << bigValue.size() << " bytes sent." << std::endl;
+
+    client.Disconnect();
+    server.Stop();
+
+    LIBPOG_ASSERT(server.GetConnections() == 1, "All requests must share one connection");
+    std::cout << "Connections used: " << server.GetConnections() << std::endl;
+    std::cout << "Done." << std::endl;
+    return 0;
+}
@@ -0,0 +1,231 @@
+#include "../src/httpBatchFetcher.h"
+#include "../src/utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Batch against a few local "hosts" (servers on different ports) which count requests in progress:
+// per-host and global limits, fair turns between hosts, keep-alive reuse, timeouts and failures.
+
+static std::atomic<uint> totalBusy = 0;
+static std::atomic<uint> totalBusyMax = 0;
+
+static void UpdateMax(std::atomic<uint>& max, const uint value) {
+    uint current = max;
+    while (value > current && max.compare_exchange_weak(current, value) == false) {
+    }
+}
+
+/// Thread per connection, answers every request with its target after `delayMs`.
+/// Requests for `/hang` never get a response.
+class SlowServer {
+private:
+    Net::Socket listener;
+    std::thread acceptor;
+    std::vector<std::thread> workers;
+
+public:
+    Net::Address::port_t port = Net::Address::INVALID_PORT;
+    uint delayMs = 0;
+    std::atomic<uint> busy = 0;
+    std::atomic<uint> busyMax = 0;
+    std::atomic<uint> accepted = 0;
+
+    explicit SlowServer(const uint delayMs) : delayMs(delayMs) {
+        listener.Open(Net::Address::Family::IPv4, Net::Protocol::TCP);
+        port = listener.Listen(Net::Address::FromString("127.0.0.1", 0));
+        LIBPOG_ASSERT(port != Net::Address::INVALID_PORT, "Server must listen");
+
+        acceptor = std::thread([this]() {
+            while (true) {
+                Net::Socket connection = listener.Accept();
+                if (connection.IsConnected() == false) break;
+
+                ++accepted;
+                workers.emplace_back([this, socket = std::move(connection)]() mutable { Serve(socket); });
+            }
+        });
+    }
+
+    ~SlowServer() {
+        listener.Shutdown(Net::Socket::ShutdownMode::Both);
+        listener.Close();
+        acceptor.join();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    void Serve(Net::Socket& socket) {
+        std::string input;
+        char buffer[4096];
+        while (true) {
+            size_t headEnd;
+            while ((headEnd = input.find("\r\n\r\n")) == std::string::npos) {
+                const uint received = socket.Receive(buffer, sizeof(buffer));
+                if (received == 0) return;
+                input.append(buffer, received);
+            }
+
+            const size_t targetBegin = input.find(' ') + 1;
+            const std::string target = input.substr(targetBegin, input.find(' ', targetBegin) - targetBegin);
+            const bool isClose = input.find("Connection: close") < headEnd;
+            input.erase(0, headEnd + 4);
+
+            if (target == "/hang") continue;
+
+            // Every request in progress holds a connection of the fetcher.
+            UpdateMax(busyMax, ++busy);
+            UpdateMax(totalBusyMax, ++totalBusy);
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+            --totalBusy;
+            --busy;
+
+            std::string response;
+            if (target == "/chunked") {
+                response = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n4\r\nchun\r\n3\r\nked\r\n0\r\n\r\n";
+            } else if (target == "/huge-length") {
+                response = "HTTP/1.1 200 OK\r\nContent-Length: 99999999999999\r\n\r\nabc";
+            } else if (target == "/bad-length") {
+                response = "HTTP/1.1 200 OK\r\nContent-Length: 3x\r\n\r\nabc";
+            } else if (target == "/bad-chunk") {
+                response = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\nxyz\r\n";
+            } else {
+                response = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(target.size()) + "\r\n\r\n" + target;
+            }
+            socket.Send(response.data(), static_cast<uint>(response.size()));
+
+            if (isClose) {
+                socket.Shutdown(Net::Socket::ShutdownMode::Send);
+            }
+        }
+    }
+};
+
+static void CheckLimits() {
+    static constexpr uint HOSTS_COUNT = 3;
+    static constexpr uint REQUESTS_PER_HOST = 40;
+
+    std::vector<std::unique_ptr<SlowServer>> servers;
+    for (uint i = 0; i < HOSTS_COUNT; ++i) servers.push_back(std::make_unique<SlowServer>(5));
+
+    Net::HttpBatchFetcher::Options options;
+    options.maxConnections = 8;
+    options.maxPerHost = 4;
+    Net::HttpBatchFetcher fetcher(options);
+
+    // Hosts are queued one after another, fair scheduling still serves them side by side.
+    for (uint host = 0; host < HOSTS_COUNT; ++host) {
+        for (uint i = 0; i < REQUESTS_PER_HOST; ++i) {
+            fetcher.Add("127.0.0.1", servers[host]->port, "/" + std::to_string(host) + "/" + std::to_string(i));
+        }
+    }
+
+    uint completed = 0;
+    uint lastHostFirstAt = 0;
+    std::vector<bool> isSeen(HOSTS_COUNT * REQUESTS_PER_HOST, false);
+    fetcher.Run([&](const Net::HttpBatchFetcher::Request& request, Net::HttpBatchFetcher::Result& result) {
+        LIBPOG_ASSERT(result.status == Net::Success && result.response.status == 200, "Request must succeed");
+        LIBPOG_ASSERT(result.response.body == request.uri, "Body must match the request");
+        LIBPOG_ASSERT(isSeen[result.index] == false, "Every result must be reported once");
+        isSeen[result.index] = true;
+
+        if (lastHostFirstAt == 0 && result.index >= (HOSTS_COUNT - 1) * REQUESTS_PER_HOST) {
+            lastHostFirstAt = completed + 1;
+        }
+        ++completed;
+    });
+
+    LIBPOG_ASSERT(completed == HOSTS_COUNT * REQUESTS_PER_HOST, "All requests must complete");
+    LIBPOG_ASSERT(lastHostFirstAt <= 2 * options.maxConnections, "Last host must not wait for the others");
+    LIBPOG_ASSERT(totalBusyMax <= options.maxConnections, "Global limit must hold");
+
+    uint accepted = 0;
+    for (const std::unique_ptr<SlowServer>& server : servers) {
+        LIBPOG_ASSERT(server->busyMax <= options.maxPerHost, "Per-host limit must hold");
+        accepted += server->accepted;
+    }
+    LIBPOG_ASSERT(accepted <= options.maxConnections + HOSTS_COUNT, "Connections must be reused");
+
+    std::cout << "Limits: OK (" << completed << " requests, " << accepted << " connections, at most "
+              << totalBusyMax << " busy at once, last host first done #" << lastHostFirstAt << ")." << std::endl;
+}
+
+static void CheckFailures() {
+    SlowServer server(0);
+
+    // Port of a closed listener refuses connections.
+    Net::Address::port_t closedPort;
+    {
+        Net::Socket listener(Net::Address::Family::IPv4, Net::Protocol::TCP);
+        closedPort = listener.Listen(Net::Address::FromString("127.0.0.1", 0));
+    }
+
+    Net::HttpBatchFetcher::Options options;
+    options.timeoutMs = 300;
+    options.keepAlive = false;
+    Net::HttpBatchFetcher fetcher(options);
+
+    Net::HttpBatchFetcher::Request request;
+    const bool isParsed = Net::HttpBatchFetcher::ParseUrl("http://127.0.0.1:" + std::to_string(server.port), request);
+    LIBPOG_ASSERT(isParsed, "URL must parse");
+    LIBPOG_ASSERT(request.host == "127.0.0.1" && request.port == server.port && request.uri == "/", "URL must parse");
+    LIBPOG_ASSERT(Net::HttpBatchFetcher::ParseUrl("https://example.com/", request) == false, "Only http is known");
+    LIBPOG_ASSERT(Net::HttpBatchFetcher::ParseUrl("http://[::1:80/", request) == false, "Bracket must be closed");
+    LIBPOG_ASSERT(Net::HttpBatchFetcher::ParseUrl("http://host:99999/", request) == false, "Port must fit");
+    LIBPOG_ASSERT(Net::HttpBatchFetcher::ParseUrl("http://host:8o/", request) == false, "Port must be digits");
+
+    const size_t okIndex = fetcher.Add("127.0.0.1", server.port, "/ok");
+    const size_t chunkedIndex = fetcher.Add("127.0.0.1", server.port, "/chunked");
+    const size_t hangIndex = fetcher.Add("127.0.0.1", server.port, "/hang");
+    const size_t refusedIndex = fetcher.Add("127.0.0.1", closedPort, "/");
+    const size_t invalidIndex = fetcher.Add("invalid.invalid", 80, "/");
+    const size_t hugeLengthIndex = fetcher.Add("127.0.0.1", server.port, "/huge-length");
+    const size_t badLengthIndex = fetcher.Add("127.0.0.1", server.port, "/bad-length");
+    const size_t badChunkIndex = fetcher.Add("127.0.0.1", server.port, "/bad-chunk");
+
+    std::vector<Net::Status> statuses(fetcher.GetPendingCount(), Net::Failed);
+    std::vector<std::string> bodies(fetcher.GetPendingCount());
+    fetcher.Run([&](const Net::HttpBatchFetcher::Request&, Net::HttpBatchFetcher::Result& result) {
+        statuses[result.index] = result.status;
+        bodies[result.index] = std::move(result.response.body);
+    });
+
+    LIBPOG_ASSERT(statuses[okIndex] == Net::Success && bodies[okIndex] == "/ok", "Plain request must succeed");
+    LIBPOG_ASSERT(statuses[chunkedIndex] == Net::Success && bodies[chunkedIndex] == "chunked", "Chunks must join");
+    LIBPOG_ASSERT(statuses[hangIndex] == Net::Timeout, "Silent server must time out");
+    LIBPOG_ASSERT(statuses[refusedIndex] == Net::ConnectionRefused, "Closed port must refuse");
+    LIBPOG_ASSERT(statuses[invalidIndex] == Net::InvalidAddress, "Unknown host must fail");
+    // Bogus framing: the declared length isn't allocated up front, malformed numbers fail instead of ending the body.
+    LIBPOG_ASSERT(statuses[hugeLengthIndex] == Net::ConnectionReset, "Huge length must end with the connection");
+    LIBPOG_ASSERT(statuses[badLengthIndex] == Net::Failed, "Malformed length must fail");
+    LIBPOG_ASSERT(statuses[badChunkIndex] == Net::Failed, "Malformed chunk size must fail");
+    LIBPOG_ASSERT(fetcher.GetPendingCount() == 0, "Queue must be empty");
+
+    // Stop before the run is kept, the run after it works normally.
+    fetcher.Add("127.0.0.1", server.port, "/ok");
+    fetcher.Stop();
+    size_t stoppedCount = 0;
+    fetcher.Run([&](const Net::HttpBatchFetcher::Request&, Net::HttpBatchFetcher::Result&) { ++stoppedCount; });
+    LIBPOG_ASSERT(stoppedCount == 0 && fetcher.GetPendingCount() == 0, "Stopped run must report nothing");
+
+    // Fetcher stays usable.
+    const size_t againIndex = fetcher.Add("127.0.0.1", server.port, "/ok");
+    fetcher.Run([&](const Net::HttpBatchFetcher::Request&, Net::HttpBatchFetcher::Result& result) {
+        LIBPOG_ASSERT(result.index == againIndex && result.status == Net::Success, "Next run must succeed");
+    });
+
+    std::cout << "Failures: OK." << std::endl;
+}
+
+int main() {
+    CheckLimits();
+    CheckFailures();
+
+    std::cout << "Done." << std::endl;
+    return 0;
+}
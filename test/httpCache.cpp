@@ -0,0 +1,215 @@
+#include "../src/httpCache.h"
+#include "../src/httpServer.h"
+#include "../src/utils.h"
+
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Client-side cache against a local server counting the requests that actually reached it:
+// fresh hits, conditional revalidation, `no-store`, invalidation, LRU bound and the disk tier.
+
+static std::atomic<uint> served = 0;
+static std::atomic<uint> notModified = 0;
+// Cache of the running check, `/vanishing` drops its entry as if another client did it.
+static Net::HttpCache* currentCache = nullptr;
+
+static void SetupRoutes(Net::HttpServer& server) {
+    server.Route("GET", "/fresh", [](const Net::HttpRequest&, Net::HttpResponseWriter& response) {
+        ++served;
+        response.AddHeader("Cache-Control", "max-age=60");
+        response.SetBody(std::string_view("fresh body"));
+    });
+
+    server.Route("GET", "/etag", [](const Net::HttpRequest& request, Net::HttpResponseWriter& response) {
+        ++served;
+        response.AddHeader("Cache-Control", "no-cache");
+        response.AddHeader("ETag", "\"v1\"");
+        if (request.GetHeader("If-None-Match") == "\"v1\"") {
+            ++notModified;
+            response.SetStatus(304);
+            return;
+        }
+        response.SetBody(std::string_view("tagged body"));
+    });
+
+    server.Route("GET", "/vanishing", [](const Net::HttpRequest& request, Net::HttpResponseWriter& response) {
+        ++served;
+        response.AddHeader("Cache-Control", "no-cache");
+        response.AddHeader("ETag", "\"v1\"");
+        if (request.GetHeader("If-None-Match") == "\"v1\"") {
+            ++notModified;
+            currentCache->Remove(Net::HttpCache::MakeKey(request.GetHeader("Host"), "/vanishing"));
+            response.SetStatus(304);
+            return;
+        }
+        response.SetBody(std::string_view("vanishing body"));
+    });
+
+    server.Route("GET", "/modified", [](const Net::HttpRequest& request, Net::HttpResponseWriter& response) {
+        ++served;
+        static const std::string lastModified = Net::HttpCache::FormatDate(Net::HttpCache::GetTime() - 3600);
+        response.AddHeader("Last-Modified", lastModified);
+        if (request.GetHeader("If-Modified-Since") == lastModified) {
+            ++notModified;
+            response.SetStatus(304);
+            response.AddHeader("Cache-Control", "max-age=60");
+            return;
+        }
+        response.AddHeader("Cache-Control", "max-age=0");
+        response.SetBody(std::string_view("dated body"));
+    });
+
+    server.Route("GET", "/private", [](const Net::HttpRequest&, Net::HttpResponseWriter& response) {
+        ++served;
+        response.AddHeader("Cache-Control", "no-store");
+        response.SetBody(std::string_view("secret"));
+    });
+
+    server.Route("POST", "/fresh", [](const Net::HttpRequest&, Net::HttpResponseWriter& response) {
+        response.SetStatus(204);
+    });
+
+    server.SetFallback([](const Net::HttpRequest& request, Net::HttpResponseWriter& response) {
+        ++served;
+        response.AddHeader("Cache-Control", "max-age=60");
+        response.SetBody(std::string(request.path) + std::string(1000, '.'));
+    });
+}
+
+static void Get(Net::HttpClient& client, const std::string_view uri, Net::HttpResponse& response) {
+    const Net::Status status = client.Request("GET", uri, response);
+    LIBPOG_ASSERT(status == Net::Success, "Request must succeed");
+}
+
+static void CheckDates() {
+    LIBPOG_ASSERT(Net::HttpCache::ParseDate("Sun, 06 Nov 1994 08:49:37 GMT") == 784111777, "Date must be parsed");
+    LIBPOG_ASSERT(Net::HttpCache::FormatDate(784111777) == "Sun, 06 Nov 1994 08:49:37 GMT", "Date must be formatted");
+    LIBPOG_ASSERT(Net::HttpCache::ParseDate("0") == -1, "Invalid date must be rejected");
+    std::cout << "Dates: OK." << std::endl;
+}
+
+static void CheckMemory(const Net::Address::port_t port) {
+    Net::HttpCache cache;
+    currentCache = &cache;
+    Net::HttpClient client;
+    client.SetCache(&cache);
+    const Net::Status connectStatus = client.Connect("127.0.0.1", port);
+    LIBPOG_ASSERT(connectStatus == Net::Success, "Client must connect");
+
+    Net::HttpResponse response;
+
+    // Fresh entry doesn't touch the network.
+    served = 0;
+    Get(client, "/fresh", response);
+    Get(client, "/fresh", response);
+    LIBPOG_ASSERT(served == 1 && response.isFromCache && response.body == "fresh body", "Fresh entry must be served");
+
+    // `no-cache` entries are revalidated every time with `If-None-Match`.
+    served = 0;
+    notModified = 0;
+    Get(client, "/etag", response);
+    Get(client, "/etag", response);
+    Get(client, "/etag", response);
+    LIBPOG_ASSERT(served == 3 && notModified == 2, "Entity tag must be revalidated");
+    LIBPOG_ASSERT(response.status == 200 && response.isFromCache && response.body == "tagged body", "Body must stay");
+
+    // Entry gone by the time 304 arrives: the body is fetched again instead of returning the empty 304.
+    served = 0;
+    notModified = 0;
+    Get(client, "/vanishing", response);
+    Get(client, "/vanishing", response);
+    LIBPOG_ASSERT(served == 3 && notModified == 1, "Lost entry must be fetched unconditionally");
+    LIBPOG_ASSERT(response.status == 200 && response.body == "vanishing body", "Body must be there");
+
+    // Stale entry revalidated by date, the 304 makes it fresh for a minute.
+    served = 0;
+    notModified = 0;
+    Get(client, "/modified", response);
+    Get(client, "/modified", response);
+    Get(client, "/modified", response);
+    LIBPOG_ASSERT(served == 2 && notModified == 1 && response.body == "dated body", "Date must be revalidated");
+
+    served = 0;
+    Get(client, "/private", response);
+    Get(client, "/private", response);
+    LIBPOG_ASSERT(served == 2 && response.isFromCache == false, "no-store must not be cached");
+
+    // Unsafe method invalidates the stored response.
+    client.Request("POST", "/fresh", response);
+    served = 0;
+    Get(client, "/fresh", response);
+    LIBPOG_ASSERT(served == 1 && response.isFromCache == false, "POST must invalidate");
+
+    const Net::HttpCache::Stats stats = cache.GetStats();
+    std::cout << "Memory: OK (hits " << stats.memoryHits << ", misses " << stats.misses << ", revalidations "
+              << stats.revalidations << ")." << std::endl;
+}
+
+static void CheckLimits(const Net::Address::port_t port) {
+    const std::string directory = "/tmp/libpog-cache-test";
+    std::filesystem::remove_all(directory);
+
+    Net::HttpCache::Options options;
+    options.memoryLimit = 8 * 1024;
+    options.directory = directory;
+
+    {
+        Net::HttpCache cache(options);
+        Net::HttpClient client;
+        client.SetCache(&cache);
+        client.Connect("127.0.0.1", port);
+
+        Net::HttpResponse response;
+        served = 0;
+        for (int i = 0; i < 32; ++i) {
+            Get(client, "/item/" + std::to_string(i), response);
+        }
+        LIBPOG_ASSERT(served == 32, "Every item must be fetched once");
+        LIBPOG_ASSERT(cache.GetMemorySize() <= options.memoryLimit && cache.GetEntriesCount() < 32, "LRU must evict");
+
+        // Evicted from memory, still on disk.
+        Get(client, "/item/0", response);
+        LIBPOG_ASSERT(served == 32 && response.isFromCache, "Disk tier must serve evicted entry");
+        LIBPOG_ASSERT(cache.GetStats().diskHits == 1, "Disk hit must be counted");
+    }
+
+    // Disk tier outlives the process.
+    Net::HttpCache cache(options);
+    Net::HttpClient client;
+    client.SetCache(&cache);
+    client.Connect("127.0.0.1", port);
+
+    Net::HttpResponse response;
+    Get(client, "/item/31", response);
+    LIBPOG_ASSERT(served == 32 && response.isFromCache, "Entry must be restored from disk");
+    LIBPOG_ASSERT(response.body.size() == 1008 && response.body.compare(0, 8, "/item/31") == 0, "Body must match");
+
+    cache.Clear();
+    LIBPOG_ASSERT(std::filesystem::is_empty(directory), "Clear must remove files");
+    std::filesystem::remove_all(directory);
+
+    std::cout << "LRU and disk tier: OK." << std::endl;
+}
+
+int main() {
+    CheckDates();
+
+    Net::HttpServer server;
+    SetupRoutes(server);
+
+    const Net::Address::port_t port = server.Listen(Net::Address::FromString("127.0.0.1", 0));
+    LIBPOG_ASSERT(port != Net::Address::INVALID_PORT, "Server must listen");
+    std::thread serverThread([&server]() { server.Run(); });
+
+    CheckMemory(port);
+    CheckLimits(port);
+
+    server.Stop();
+    serverThread.join();
+
+    std::cout << "Done." << std::endl;
+    return 0;
+}
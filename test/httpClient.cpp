@@ -0,0 +1,130 @@
+#include "../src/httpClient.h"
+#include "../src/utils.h"
+
+#include <poll.h>
+
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+// Response framing of `HttpClient`: status line and chunk size parsing, then bogus responses from a canned server.
+// Keep-alive connections closed by the server: only idempotent requests are repeated.
+
+// Reads until the end of the request head, `false` if the client has gone.
+static bool ReceiveHead(Net::Socket& connection) {
+    char buffer[4096];
+    std::string request;
+    while (request.find("\r\n\r\n") == std::string::npos) {
+        const uint received = connection.Receive(buffer, sizeof(buffer));
+        if (received == 0) return false;
+        request.append(buffer, received);
+    }
+    return true;
+}
+
+static void CheckMalformed() {
+    Net::HttpResponse response;
+    const bool isParsed = response.ParseHead("HTTP/1.1 204");
+    LIBPOG_ASSERT(isParsed && response.status == 204, "Reason may be missing");
+    LIBPOG_ASSERT(response.ParseHead("HTTP/1.1 2x0 OK") == false, "Status must be digits");
+    LIBPOG_ASSERT(response.ParseHead("HTTP/1.1 -20 OK") == false, "Status must be digits");
+    LIBPOG_ASSERT(response.ParseHead("HTTP/1.1 2000 OK") == false, "Status must have three digits");
+
+    uint64_t size = 0;
+    LIBPOG_ASSERT(Net::HttpResponse::ParseChunkSize("1aF;name=value", size) && size == 0x1af, "Extension ignored");
+    LIBPOG_ASSERT(Net::HttpResponse::ParseChunkSize("10 ", size) && size == 0x10, "Trailing space allowed");
+    LIBPOG_ASSERT(Net::HttpResponse::ParseChunkSize("", size) == false, "Size must be there");
+    LIBPOG_ASSERT(Net::HttpResponse::ParseChunkSize("zz", size) == false, "Size must be hex");
+    LIBPOG_ASSERT(Net::HttpResponse::ParseChunkSize("-1", size) == false, "Size must be unsigned");
+    LIBPOG_ASSERT(Net::HttpResponse::ParseChunkSize("10000000000000000", size) == false, "Size must fit");
+
+    // Bogus framing from a server must fail the request, not allocate the declared size or cut the body.
+    const std::string_view responses[] = {
+        "HTTP/1.1 200 OK\r\nContent-Length: 99999999999999\r\n\r\nabc",
+        "HTTP/1.1 200 OK\r\nContent-Length: 99999999999999999999999\r\n\r\nabc",
+        "HTTP/1.1 200 OK\r\nContent-Length: 3x\r\n\r\nabc",
+        "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\nxyz\r\n",
+        "HTTP/1.1 2x0 OK\r\nContent-Length: 0\r\n\r\n",
+    };
+    const Net::Status expected[] = {Net::ConnectionReset, Net::Failed, Net::Failed, Net::Failed, Net::Failed};
+
+    Net::Socket listener;
+    listener.Open(Net::Address::Family::IPv4, Net::Protocol::TCP);
+    const Net::Address::port_t port = listener.Listen(Net::Address::FromString("127.0.0.1", 0));
+    LIBPOG_ASSERT(port != Net::Address::INVALID_PORT, "Server must listen");
+
+    std::thread server([&listener, &responses]() {
+        for (const std::string_view cannedResponse : responses) {
+            Net::Socket connection = listener.Accept();
+            ReceiveHead(connection);
+            connection.Send(cannedResponse.data(), static_cast<uint>(cannedResponse.size()));
+        }
+    });
+
+    for (size_t i = 0; i < std::size(responses); ++i) {
+        Net::HttpClient client;
+        const Net::Status connectStatus = client.Connect("127.0.0.1", port);
+        LIBPOG_ASSERT(connectStatus == Net::Success, "Must connect");
+        const Net::Status status = client.Request("GET", "/", response);
+        LIBPOG_ASSERT(status == expected[i], "Bogus response must fail");
+    }
+    server.join();
+
+    std::cout << "Malformed: OK." << std::endl;
+}
+
+// Every connection answers one request and drops the next one unanswered.
+static void CheckRetry() {
+    static constexpr std::string_view RESPONSE = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+
+    Net::Socket listener;
+    listener.Open(Net::Address::Family::IPv4, Net::Protocol::TCP);
+    const Net::Address::port_t port = listener.Listen(Net::Address::FromString("127.0.0.1", 0));
+    LIBPOG_ASSERT(port != Net::Address::INVALID_PORT, "Server must listen");
+
+    uint requestsCount = 0;
+    bool isReconnected = false;
+    std::thread server([&]() {
+        for (uint i = 0; i < 3; ++i) {
+            Net::Socket connection = listener.Accept();
+            if (ReceiveHead(connection)) {
+                ++requestsCount;
+                connection.Send(RESPONSE.data(), static_cast<uint>(RESPONSE.size()));
+            }
+            if (ReceiveHead(connection)) ++requestsCount;
+        }
+        struct pollfd pollFd = {listener.GetHandle(), POLLIN, 0};
+        isReconnected = poll(&pollFd, 1, 200) > 0;
+    });
+
+    Net::HttpClient client;
+    const Net::Status connectStatus = client.Connect("127.0.0.1", port);
+    LIBPOG_ASSERT(connectStatus == Net::Success, "Must connect");
+
+    Net::HttpResponse response;
+    Net::Status status = client.Request("GET", "/", response);
+    LIBPOG_ASSERT(status == Net::Success, "First request must succeed");
+    // Dropped on the first connection, repeated on the second.
+    status = client.Request("PUT", "/", response, "idempotent");
+    LIBPOG_ASSERT(status == Net::Success && response.body == "ok", "Idempotent request must be repeated");
+    // Dropped on the second connection, may have been processed already.
+    status = client.Request("POST", "/", response, "unsafe");
+    LIBPOG_ASSERT(status != Net::Success, "POST must not be repeated");
+    // The third connection serves one request and isn't used more.
+    status = client.Request("GET", "/", response);
+    LIBPOG_ASSERT(status == Net::Success, "Next request must reconnect");
+    client.Disconnect();
+    server.join();
+
+    LIBPOG_ASSERT(requestsCount == 5 && isReconnected == false, "Each dropped request must be sent once");
+    std::cout << "Retry: OK." << std::endl;
+}
+
+int main() {
+    CheckMalformed();
+    CheckRetry();
+
+    std::cout << "Done." << std::endl;
+    return 0;
+}
@@ -0,0 +1,233 @@
+#include "../src/httpDownloader.h"
+#include "../src/utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Segmented download from a local server which supports ranges on `/ranged` only and cuts every fifth
+// response halfway: content must arrive intact, broken segments resumed, progress reported.
+
+static constexpr size_t CONTENT_SIZE = 64 * 1024 * 1024 + 12345;
+static constexpr uint CUT_EVERY = 5;
+
+static std::atomic<uint> busy = 0;
+static std::atomic<uint> busyMax = 0;
+static std::atomic<uint> responsesCount = 0;
+
+static char ContentAt(const size_t offset) {
+    return static_cast<char>((offset * 2654435761u) >> 13);
+}
+
+static bool SendAll(Net::Socket& socket, const char* data, size_t size) {
+    while (size > 0) {
+        const uint sent = socket.Send(data, static_cast<uint>(std::min<size_t>(size, 1024 * 1024)));
+        if (sent == 0) return false;
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+static void Serve(Net::Socket socket, const std::vector<char>& content) {
+    std::string input;
+    char buffer[4096];
+    while (true) {
+        size_t headEnd;
+        while ((headEnd = input.find("\r\n\r\n")) == std::string::npos) {
+            const uint received = socket.Receive(buffer, sizeof(buffer));
+            if (received == 0) return;
+            input.append(buffer, received);
+        }
+
+        const std::string head = input.substr(0, headEnd);
+        input.erase(0, headEnd + 4);
+
+        const bool isHead = head.compare(0, 5, "HEAD ") == 0;
+        const size_t targetBegin = head.find(' ') + 1;
+        const std::string target = head.substr(targetBegin, head.find(' ', targetBegin) - targetBegin);
+
+        if (target == "/bad-length") {
+            const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 1e3\r\nAccept-Ranges: bytes\r\n\r\n";
+            SendAll(socket, response.data(), response.size());
+            continue;
+        }
+        if (target != "/ranged" && target != "/plain" && target != "/changed") {
+            const std::string response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n";
+            SendAll(socket, response.data(), response.size());
+            continue;
+        }
+
+        // `/changed` has no entity tag and its ranges tell another total size, as if it changed after `HEAD`.
+        const bool isRanged = target == "/ranged" || target == "/changed";
+        const bool isChanged = target == "/changed";
+        size_t first = 0;
+        size_t last = content.size() - 1;
+        const size_t range = head.find("\r\nRange: bytes=");
+        if (isRanged && range != std::string::npos) {
+            first = std::stoull(head.substr(range + 15));
+            last = std::stoull(head.substr(head.find('-', range + 15) + 1));
+        }
+        const bool isPartial = first != 0 || last != content.size() - 1;
+
+        std::string response = isPartial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+        response += "Content-Length: " + std::to_string(last - first + 1) + "\r\n";
+        if (isRanged) response += "Accept-Ranges: bytes\r\n";
+        if (isRanged && isChanged == false) response += "ETag: \"v1\"\r\n";
+        if (isPartial) {
+            response += "Content-Range: bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" +
+                        std::to_string(content.size() + (isChanged ? 1 : 0)) + "\r\n";
+        }
+        response += "\r\n";
+        if (SendAll(socket, response.data(), response.size()) == false || isHead) continue;
+
+        const uint now = ++busy;
+        for (uint max = busyMax; now > max && busyMax.compare_exchange_weak(max, now) == false;) {
+        }
+
+        size_t size = last - first + 1;
+        const bool isCut = target == "/ranged" && ++responsesCount % CUT_EVERY == 0;
+        if (isCut) size /= 2;
+
+        const bool isSent = SendAll(socket, content.data() + first, size);
+        --busy;
+        if (isCut || isSent == false) return;
+    }
+}
+
+class RangeServer {
+private:
+    Net::Socket listener;
+    std::thread acceptor;
+    std::vector<std::thread> workers;
+
+public:
+    Net::Address::port_t port;
+
+    explicit RangeServer(const std::vector<char>& content) {
+        listener.Open(Net::Address::Family::IPv4, Net::Protocol::TCP);
+        port = listener.Listen(Net::Address::FromString("127.0.0.1", 0));
+        LIBPOG_ASSERT(port != Net::Address::INVALID_PORT, "Server must listen");
+
+        acceptor = std::thread([this, &content]() {
+            while (true) {
+                Net::Socket connection = listener.Accept();
+                if (connection.IsConnected() == false) break;
+                workers.emplace_back(Serve, std::move(connection), std::cref(content));
+            }
+        });
+    }
+
+    ~RangeServer() {
+        listener.Shutdown(Net::Socket::ShutdownMode::Both);
+        listener.Close();
+        acceptor.join();
+        for (std::thread& worker : workers) worker.join();
+    }
+};
+
+static bool IsFileEqual(const std::string& path, const std::vector<char>& content) {
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return data == content;
+}
+
+int main() {
+    std::vector<char> content(CONTENT_SIZE);
+    for (size_t i = 0; i < CONTENT_SIZE; ++i) content[i] = ContentAt(i);
+
+    RangeServer server(content);
+    const std::string path = "/tmp/libpog-download-test";
+
+    {
+        Net::HttpDownloader::Options options;
+        options.connections = 4;
+        options.segmentSize = 4 * 1024 * 1024;
+        options.retryDelayMs = 10;
+        options.progressIntervalMs = 20;
+        Net::HttpDownloader downloader(options);
+
+        uint64_t lastReceived = 0;
+        uint progressCalls = 0;
+        Net::HttpDownloader::Progress result;
+        downloader.SetProgressHandler([&](const Net::HttpDownloader::Progress& progress) {
+            LIBPOG_ASSERT(progress.total == CONTENT_SIZE && progress.received <= CONTENT_SIZE, "Total must be known");
+            lastReceived = progress.received;
+            result = progress;
+            ++progressCalls;
+        });
+
+        const auto begin = std::chrono::steady_clock::now();
+        const Net::Status status = downloader.Download("127.0.0.1", server.port, "/ranged", path);
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        LIBPOG_ASSERT(status == Net::Success, "Download must succeed");
+        LIBPOG_ASSERT(IsFileEqual(path, content), "Content must match");
+        LIBPOG_ASSERT(lastReceived == CONTENT_SIZE && result.segmentsDone == result.segmentsCount, "Progress must end");
+        LIBPOG_ASSERT(result.segmentsCount == 17 && result.retries > 0, "Cut segments must be retried");
+        LIBPOG_ASSERT(busyMax > 1, "Segments must be fetched concurrently");
+
+        std::cout << "Ranged: OK (" << result.segmentsCount << " segments, " << result.retries << " retries, "
+                  << busyMax << " at once, " << progressCalls << " progress calls, "
+                  << static_cast<uint64_t>(CONTENT_SIZE / elapsed / (1024 * 1024)) << "MB/s)." << std::endl;
+    }
+
+    {
+        Net::HttpDownloader downloader;
+        Net::HttpDownloader::Progress result;
+        downloader.SetProgressHandler([&result](const Net::HttpDownloader::Progress& progress) { result = progress; });
+
+        const Net::Status status = downloader.Download("127.0.0.1", server.port, "/plain", path);
+        LIBPOG_ASSERT(status == Net::Success, "Must succeed");
+        LIBPOG_ASSERT(IsFileEqual(path, content), "Content must match");
+        LIBPOG_ASSERT(result.segmentsCount == 1, "No ranges means a single request");
+        std::cout << "Plain: OK." << std::endl;
+    }
+
+    {
+        std::remove(path.c_str());
+        Net::HttpDownloader downloader;
+        const Net::Status status = downloader.Download("127.0.0.1", server.port, "/missing", path);
+        LIBPOG_ASSERT(status == Net::Failed, "Must fail");
+        LIBPOG_ASSERT(std::ifstream(path).good() == false, "Failed download must leave no file");
+        std::cout << "Missing: OK." << std::endl;
+    }
+
+    {
+        // Stop before the download is kept, the download after it works normally.
+        Net::HttpDownloader downloader;
+        downloader.Stop();
+        Net::Status status = downloader.Download("127.0.0.1", server.port, "/ranged", path);
+        LIBPOG_ASSERT(status == Net::Failed, "Stopped download must fail");
+        LIBPOG_ASSERT(std::ifstream(path).good() == false, "Stopped download must leave no file");
+
+        status = downloader.Download("127.0.0.1", server.port, "/plain", path);
+        LIBPOG_ASSERT(status == Net::Success && IsFileEqual(path, content), "Next download must succeed");
+        std::cout << "Stop before download: OK." << std::endl;
+    }
+
+    // Bogus length and a resource changing between ranges must fail instead of leaving a truncated or mixed file.
+    for (const char* uri : {"/bad-length", "/changed"}) {
+        std::remove(path.c_str());
+        Net::HttpDownloader::Options options;
+        options.segmentSize = 4 * 1024 * 1024;
+        options.maxRetries = 0;
+        Net::HttpDownloader downloader(options);
+
+        const Net::Status status = downloader.Download("127.0.0.1", server.port, uri, path);
+        LIBPOG_ASSERT(status == Net::Failed, "Download must fail");
+        LIBPOG_ASSERT(std::ifstream(path).good() == false, "Failed download must leave no file");
+    }
+    std::cout << "Inconsistent: OK." << std::endl;
+
+    std::remove(path.c_str());
+    std::cout << "Done." << std::endl;
+    return 0;
+}
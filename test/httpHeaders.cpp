@@ -0,0 +1,107 @@
+#include "../src/httpClient.h"
+#include "../src/httpHeaders.h"
+#include "../src/utils.h"
+
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Indexed header fields: perfect hash of the known names, case-insensitive lookups, repeated fields
+// and copies, then the cost of the lookups `HttpClient` does for every response.
+
+static_assert(Net::HttpHeaders::GetId("Content-Length") == Net::HttpHeaderId::ContentLength);
+static_assert(Net::HttpHeaders::GetId("etag") == Net::HttpHeaderId::ETag);
+static_assert(Net::HttpHeaders::GetId("Content-Lengths") == Net::HttpHeaderId::Unknown);
+static_assert(Net::HttpHeaders::GetName(Net::HttpHeaderId::CacheControl) == "Cache-Control");
+
+static constexpr std::string_view HEAD = "HTTP/1.1 200 OK\r\n"
+                                         "Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n"
+                                         "content-type: text/plain\r\n"
+                                         "Cache-Control: max-age=60\r\n"
+                                         "X-Request-Id:\t42 \r\n"
+                                         "CACHE-CONTROL: no-transform\r\n"
+                                         "Transfer-Encoding: chunked\r\n"
+                                         "Connection: close\r\n";
+
+static void CheckKnownNames() {
+    for (size_t i = 0; i < static_cast<size_t>(Net::HttpHeaderId::Count); ++i) {
+        const Net::HttpHeaderId id = static_cast<Net::HttpHeaderId>(i);
+        const std::string_view name = Net::HttpHeaders::GetName(id);
+
+        std::string upper(name);
+        for (char& c : upper) c = static_cast<char>(std::toupper(c));
+        LIBPOG_ASSERT(Net::HttpHeaders::GetId(name) == id && Net::HttpHeaders::GetId(upper) == id, "Name must resolve");
+        LIBPOG_ASSERT(Net::HttpHeaders::GetId(upper.substr(1)) == Net::HttpHeaderId::Unknown, "Prefix must not match");
+    }
+    std::cout << "Known names: OK." << std::endl;
+}
+
+static void CheckFields() {
+    Net::HttpResponse response;
+    const bool isParsed = response.ParseHead(HEAD);
+    LIBPOG_ASSERT(isParsed, "Head must parse");
+
+    const Net::HttpHeaders& headers = response.headers;
+    LIBPOG_ASSERT(headers.GetSize() == 7, "All fields must be kept");
+    LIBPOG_ASSERT(headers.Get(Net::HttpHeaderId::ContentType) == "text/plain", "Lowercase name must be indexed");
+    LIBPOG_ASSERT(headers.Get("CONTENT-TYPE") == "text/plain", "Lookup must ignore case");
+    LIBPOG_ASSERT(headers.Get("x-request-id") == "42", "Unknown name must be found and trimmed");
+    LIBPOG_ASSERT(headers.Get("x-missing").empty() && headers.Contains(Net::HttpHeaderId::Vary) == false, "No field");
+    LIBPOG_ASSERT(headers.Get(Net::HttpHeaderId::CacheControl) == "max-age=60", "First field must win");
+    LIBPOG_ASSERT(response.keepAlive == false, "Connection must be applied");
+
+    uint cacheControls = 0;
+    for (const Net::HttpHeaders::Field field : headers) {
+        if (field.id == Net::HttpHeaderId::CacheControl) ++cacheControls;
+    }
+    LIBPOG_ASSERT(cacheControls == 2, "Repeated fields must be iterated");
+
+    // Offsets survive copying and appending.
+    Net::HttpHeaders copy = headers;
+    copy.Add("Vary", "Accept-Encoding");
+    response.headers.Clear();
+    LIBPOG_ASSERT(copy.Get("date") == "Sun, 06 Nov 1994 08:49:37 GMT", "Copy must own its data");
+    LIBPOG_ASSERT(copy.Get(Net::HttpHeaderId::Vary) == "Accept-Encoding", "Added field must be indexed");
+
+    std::cout << "Fields: OK." << std::endl;
+}
+
+static void MeasureLookups() {
+    static constexpr uint ITERATIONS = 1000000;
+
+    Net::HttpResponse response;
+    response.ParseHead(HEAD);
+
+    size_t total = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (uint i = 0; i < ITERATIONS; ++i) {
+        total += response.GetHeader(Net::HttpHeaderId::ContentLength).size();
+        total += response.GetHeader(Net::HttpHeaderId::TransferEncoding).size();
+        total += response.GetHeader(Net::HttpHeaderId::Connection).size();
+    }
+    const auto indexed = std::chrono::steady_clock::now() - begin;
+
+    for (uint i = 0; i < ITERATIONS; ++i) {
+        total += response.GetHeader("content-length").size();
+        total += response.GetHeader("transfer-encoding").size();
+        total += response.GetHeader("connection").size();
+    }
+    const auto hashed = std::chrono::steady_clock::now() - begin - indexed;
+
+    const auto toNs = [](const auto duration) {
+        return std::chrono::duration<double, std::nano>(duration).count() / (3 * ITERATIONS);
+    };
+    // No `Content-Length`, `chunked` and `close`, twice.
+    LIBPOG_ASSERT(total == 2 * ITERATIONS * (7 + 5), "Lookups must find values");
+    std::cout << "Lookups: " << toNs(indexed) << "ns by id, " << toNs(hashed) << "ns by name." << std::endl;
+}
+
+int main() {
+    CheckKnownNames();
+    CheckFields();
+    MeasureLookups();
+
+    std::cout << "Done." << std::endl;
+    return 0;
+}
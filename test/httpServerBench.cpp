@@ -0,0 +1,110 @@
+#include "../src/httpServer.h"
+#include "../src/utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Measures requests/sec of `HttpServer` on loopback.
+// Usage: httpServerBench [connections] [server threads] [seconds] [pipeline depth]
+
+static std::atomic<bool> isRunning = true;
+static std::atomic<uint64_t> totalResponses = 0;
+
+// Counts complete responses in `data`, returns number of consumed bytes.
+static size_t CountResponses(const std::string_view data, uint& outCount) {
+    size_t offset = 0;
+    while (true) {
+        const size_t headersEnd = data.find("\r\n\r\n", offset);
+        if (headersEnd == std::string_view::npos) break;
+
+        const size_t lengthPos = data.find("Content-Length: ", offset);
+        const size_t bodyLength = std::strtoul(data.data() + lengthPos + 16, nullptr, 10);
+        const size_t responseEnd = headersEnd + 4 + bodyLength;
+        if (responseEnd > data.size()) break;
+
+        offset = responseEnd;
+        ++outCount;
+    }
+    return offset;
+}
+
+static void RunClient(const Net::Address& address, const uint pipelineDepth) {
+    Net::Socket socket(Net::Address::Family::IPv4, Net::Protocol::TCP);
+    if (socket.Connect(address) == false) {
+        std::cerr << "Failed to connect." << std::endl;
+        return;
+    }
+
+    std::string requests;
+    for (uint i = 0; i < pipelineDepth; ++i) {
+        requests += "GET /ping HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    }
+
+    DataBuffer buffer;
+    std::string received;
+
+    while (isRunning) {
+        socket.Send(requests.data(), requests.size());
+
+        uint responses = 0;
+        while (responses < pipelineDepth) {
+            buffer.size = socket.Receive(buffer, DataBuffer::MAX_SIZE);
+            if (buffer.size == 0) return;
+
+            received.append(buffer, buffer.size);
+            received.erase(0, CountResponses(received, responses));
+        }
+
+        totalResponses += responses;
+    }
+}
+
+int main(int argc, char** argv) {
+    const uint connections = argc > 1 ? std::atoi(argv[1]) : 64;
+    const uint serverThreads = argc > 2 ? std::atoi(argv[2]) : std::thread::hardware_concurrency();
+    const uint seconds = argc > 3 ? std::atoi(argv[3]) : 5;
+    const uint pipelineDepth = argc > 4 ? std::atoi(argv[4]) : 1;
+
+    Net::HttpServer server;
+    server.Route("GET", "/ping", [](const Net::HttpRequest&, Net::HttpResponseWriter& response) {
+        response.AddHeader("Content-Type", "text/plain");
+        response.SetBody(std::string_view("pong"));
+    });
+
+    const Net::Address::port_t port =
+        server.Listen(Net::Address::FromString("127.0.0.1", 0, Net::Address::Family::IPv4));
+    LIBPOG_ASSERT(port != Net::Address::INVALID_PORT, "Server must listen");
+
+    std::thread serverThread([&server, serverThreads]() { server.Run(serverThreads); });
+
+    const Net::Address address = Net::Address::FromString("127.0.0.1", port);
+    std::vector<std::thread> clients;
+    for (uint i = 0; i < connections; ++i) {
+        clients.emplace_back(RunClient, std::cref(address), pipelineDepth);
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    isRunning = false;
+
+    for (std::thread& client : clients) {
+        client.join();
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    server.Stop();
+    serverThread.join();
+
+    std::cout << "Connections: " << connections << ", server threads: " << serverThreads
+              << ", pipeline depth: " << pipelineDepth << std::endl;
+    std::cout << "Requests: " << totalResponses << " in " << elapsed << "s" << std::endl;
+    std::cout << "Requests/sec: " << static_cast<uint64_t>(totalResponses / elapsed) << std::endl;
+
+    LIBPOG_ASSERT(totalResponses > 0, "Server must respond");
+    return 0;
+}
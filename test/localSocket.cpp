@@ -0,0 +1,121 @@
+#include "../src/socket.h"
+#include "../src/utils.h"
+
+#include <unistd.h>
+
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Unix domain sockets: stream over filesystem path, datagrams over abstract names
+// and handing accepted TCP connections to a worker with `SCM_RIGHTS`.
+
+static void CheckStream() {
+    const char* path = "/tmp/libpog-local-test.sock";
+    unlink(path);
+
+    const Net::Address address = Net::Address::FromPath(path);
+    LIBPOG_ASSERT(address.IsValid() && address.IsLocal() && address.GetPath() == path, "Path address must be valid");
+
+    Net::Socket listener(Net::Address::Family::Local, Net::Protocol::TCP);
+    const bool isListening = listener.Bind(address) && listener.Listen();
+    LIBPOG_ASSERT(isListening, "Local socket must listen");
+
+    std::thread server([&listener]() {
+        Net::Socket connection = listener.Accept();
+        char buffer[64];
+        const uint received = connection.Receive(buffer, sizeof(buffer));
+        connection.Send(buffer, received);
+    });
+
+    Net::Socket client(Net::Address::Family::Local, Net::Protocol::TCP);
+    const bool isConnected = client.Connect(address);
+    LIBPOG_ASSERT(isConnected, "Local socket must connect");
+
+    const std::string_view message = "over unix socket";
+    client.Send(message.data(), message.size());
+
+    char buffer[64];
+    const uint received = client.Receive(buffer, sizeof(buffer));
+    LIBPOG_ASSERT(std::string_view(buffer, received) == message, "Message must be echoed");
+
+    server.join();
+    unlink(path);
+    std::cout << "Stream: OK." << std::endl;
+}
+
+static void CheckDatagram() {
+    const Net::Address serverAddress = Net::Address::FromPath("libpog-test-server", true);
+    const Net::Address clientAddress = Net::Address::FromPath("libpog-test-client", true);
+    LIBPOG_ASSERT(serverAddress.IsAbstract(), "Address must be abstract");
+
+    Net::Socket server(Net::Address::Family::Local, Net::Protocol::UDP);
+    Net::Socket client(Net::Address::Family::Local, Net::Protocol::UDP);
+    const bool isBound = server.Bind(serverAddress) && client.Bind(clientAddress);
+    LIBPOG_ASSERT(isBound, "Datagram sockets must bind");
+
+    client.SendTo(serverAddress, "ping", 4);
+
+    char buffer[16];
+    Net::Address sender;
+    const uint received = server.ReceiveFrom(buffer, sizeof(buffer), sender);
+    LIBPOG_ASSERT(std::string_view(buffer, received) == "ping", "Datagram must arrive");
+    LIBPOG_ASSERT(sender.GetPath() == clientAddress.GetPath(), "Sender must be known");
+
+    server.SendTo(sender, "pong", 4);
+    const uint replied = client.ReceiveFrom(buffer, sizeof(buffer), sender);
+    LIBPOG_ASSERT(replied == 4, "Reply must arrive");
+    LIBPOG_ASSERT(sender.ConvertToString() == "@libpog-test-server", "Abstract name must be prefixed");
+
+    std::cout << "Datagram: OK." << std::endl;
+}
+
+static void CheckDescriptorPassing(const Net::Protocol channelProtocol) {
+    Net::Socket front;
+    Net::Socket worker;
+    const bool isCreated = Net::Socket::CreatePair(channelProtocol, front, worker);
+    LIBPOG_ASSERT(isCreated, "Socket pair must be created");
+
+    Net::Socket listener(Net::Address::Family::IPv4, Net::Protocol::TCP);
+    const Net::Address::port_t port = listener.Listen(Net::Address::FromString("127.0.0.1", 0));
+    LIBPOG_ASSERT(port != Net::Address::INVALID_PORT, "Listener must listen");
+
+    // Worker serves connections it never accepted.
+    std::thread workerThread([&worker]() {
+        char tag;
+        Net::Socket::Handle handle;
+        uint count = 0;
+        worker.ReceiveDescriptors(&tag, 1, &handle, 1, count);
+        LIBPOG_ASSERT(count == 1, "Descriptor must be received");
+
+        Net::Socket connection = Net::Socket::FromHandle(handle);
+        connection.Send("served by worker", 16);
+    });
+
+    Net::Socket client(Net::Address::Family::IPv4, Net::Protocol::TCP);
+    client.Connect(Net::Address::FromString("127.0.0.1", port));
+
+    Net::Socket accepted = listener.Accept();
+    const Net::Socket::Handle handle = accepted.GetHandle();
+    const uint sent = front.SendDescriptors("c", 1, &handle, 1);
+    LIBPOG_ASSERT(sent == 1, "Descriptor must be sent");
+    // Worker has its own duplicate now.
+    accepted.Close();
+
+    char buffer[32];
+    const uint received = client.Receive(buffer, sizeof(buffer));
+    LIBPOG_ASSERT(std::string_view(buffer, received) == "served by worker", "Worker must respond");
+
+    workerThread.join();
+    std::cout << "Descriptor passing over " << Net::GetProtocolName(channelProtocol) << " pair: OK." << std::endl;
+}
+
+int main() {
+    CheckStream();
+    CheckDatagram();
+    CheckDescriptorPassing(Net::Protocol::TCP);
+    CheckDescriptorPassing(Net::Protocol::UDP);
+
+    std::cout << "Done." << std::endl;
+    return 0;
+}
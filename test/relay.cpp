@@ -0,0 +1,197 @@
+#include "../src/relay.h"
+#include "../src/utils.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <time.h>
+#endif
+
+// Client -> relay -> echo backend over loopback. The client half-closes after sending,
+// end of stream has to travel through the relay both ways for everyone to finish.
+
+static constexpr size_t TOTAL_SIZE = 256 * 1024 * 1024;
+static constexpr uint CHUNK_SIZE = 64 * 1024;
+
+static Net::Address::port_t Listen(Net::Socket& listener) {
+    listener.Open(Net::Address::Family::IPv4, Net::Protocol::TCP);
+    const Net::Address::port_t port = listener.Listen(Net::Address::FromString("127.0.0.1", 0));
+    LIBPOG_ASSERT(port != Net::Address::INVALID_PORT, "Listener must listen");
+    return port;
+}
+
+static void CheckEcho() {
+    Net::Socket backendListener;
+    const Net::Address::port_t backendPort = Listen(backendListener);
+    Net::Socket relayListener;
+    const Net::Address::port_t relayPort = Listen(relayListener);
+
+    // Echoes until end of stream, then half-closes its side too.
+    std::thread backend([&backendListener]() {
+        Net::Socket connection = backendListener.Accept();
+        std::vector<char> buffer(CHUNK_SIZE);
+        while (true) {
+            const uint received = connection.Receive(buffer.data(), CHUNK_SIZE);
+            if (received == 0) break;
+
+            for (uint sent = 0; sent < received;) {
+                const uint ret = connection.Send(buffer.data() + sent, received - sent);
+                LIBPOG_ASSERT(ret > 0, "Backend must send");
+                sent += ret;
+            }
+        }
+        connection.Shutdown(Net::Socket::ShutdownMode::Send);
+    });
+
+    Net::Relay::Stats stats;
+    std::thread relay([&]() {
+        Net::Socket front = relayListener.Accept();
+        Net::Socket back(Net::Address::Family::IPv4, Net::Protocol::TCP);
+        const bool isConnected = back.Connect(Net::Address::FromString("127.0.0.1", backendPort));
+        LIBPOG_ASSERT(isConnected, "Relay must connect");
+
+        Net::Relay forwarder(front, back);
+        stats = forwarder.Run();
+    });
+
+    Net::Socket client(Net::Address::Family::IPv4, Net::Protocol::TCP);
+    const bool isConnected = client.Connect(Net::Address::FromString("127.0.0.1", relayPort));
+    LIBPOG_ASSERT(isConnected, "Client must connect");
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    std::thread sender([&client]() {
+        const std::vector<char> chunk(CHUNK_SIZE, 'r');
+
+        for (size_t total = 0; total < TOTAL_SIZE; total += CHUNK_SIZE) {
+            for (uint sent = 0; sent < CHUNK_SIZE;) {
+                const uint ret = client.Send(chunk.data() + sent, CHUNK_SIZE - sent);
+                LIBPOG_ASSERT(ret > 0, "Client must send");
+                sent += ret;
+            }
+        }
+        client.Shutdown(Net::Socket::ShutdownMode::Send);
+    });
+
+    size_t received = 0;
+    std::vector<char> buffer(CHUNK_SIZE);
+    while (true) {
+        const uint ret = client.Receive(buffer.data(), CHUNK_SIZE);
+        if (ret == 0) break;
+        received += ret;
+    }
+
+    sender.join();
+    relay.join();
+    backend.join();
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    LIBPOG_ASSERT(stats.status == Net::Success, "Relay must finish cleanly");
+    LIBPOG_ASSERT(received == TOTAL_SIZE, "Everything must come back");
+    LIBPOG_ASSERT(stats.firstToSecond == TOTAL_SIZE && stats.secondToFirst == TOTAL_SIZE, "Counts must match");
+
+    std::cout << "Relayed " << (stats.firstToSecond + stats.secondToFirst) / (1024 * 1024) << "MB in " << elapsed
+              << "s, " << static_cast<uint64_t>(2 * TOTAL_SIZE / elapsed / (1024 * 1024)) << "MB/s." << std::endl;
+}
+
+#ifdef __linux__
+static double GetThreadCpuTime(std::thread& thread) {
+    clockid_t clock;
+    pthread_getcpuclockid(thread.native_handle(), &clock);
+
+    struct timespec time;
+    clock_gettime(clock, &time);
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) / 1e9;
+}
+
+// Backend never reads and the client sends tiny segments: the pipe runs out of slots long before it's full
+// by size, the relay must still wait for the destination instead of spinning on the readable source.
+static void CheckStalledDestination() {
+    static constexpr auto STALL_TIME = std::chrono::seconds(1);
+
+    Net::Socket backendListener;
+    const Net::Address::port_t backendPort = Listen(backendListener);
+    Net::Socket relayListener;
+    const Net::Address::port_t relayPort = Listen(relayListener);
+
+    std::atomic<Net::Relay*> forwarder = nullptr;
+    std::thread relay([&]() {
+        Net::Socket front = relayListener.Accept();
+        Net::Socket back(Net::Address::Family::IPv4, Net::Protocol::TCP);
+        const bool isConnected = back.Connect(Net::Address::FromString("127.0.0.1", backendPort));
+        LIBPOG_ASSERT(isConnected, "Relay must connect");
+
+        Net::Relay relayInstance(front, back);
+        forwarder = &relayInstance;
+        relayInstance.Run();
+    });
+
+    Net::Socket client(Net::Address::Family::IPv4, Net::Protocol::TCP);
+    const bool isConnected = client.Connect(Net::Address::FromString("127.0.0.1", relayPort));
+    LIBPOG_ASSERT(isConnected, "Client must connect");
+    Net::Socket backend = backendListener.Accept();
+    client.Set<Net::SocketOption::NoDelay>(true);
+    client.SetNonBlocking();
+
+    // Small writes until everything up to the client is full.
+    const auto begin = std::chrono::steady_clock::now();
+    size_t sent = 0;
+    while (std::chrono::steady_clock::now() - begin < STALL_TIME) {
+        const uint ret = client.Send("0123456789", 10);
+        if (ret == 0) {
+            LIBPOG_ASSERT(client.Fail() == Net::TryAgain, "Client must only be blocked");
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        sent += ret;
+    }
+
+    // Nothing can move now, the relay has nothing to do.
+    const double cpuBegin = GetThreadCpuTime(relay);
+    std::this_thread::sleep_for(STALL_TIME);
+    const double cpuTime = GetThreadCpuTime(relay) - cpuBegin;
+
+    forwarder.load()->Stop();
+    relay.join();
+
+    LIBPOG_ASSERT(cpuTime < 0.1, "Relay must not spin while the destination is stalled");
+    std::cout << "Stalled destination: OK (" << sent << " bytes sent, " << cpuTime << "s of CPU while stalled)."
+              << std::endl;
+}
+#endif
+
+#ifndef _WIN32
+// Idle sockets never finish, only the earlier `Stop()` lets `Run()` return.
+static void CheckStopBeforeRun() {
+    Net::Socket first, firstPeer, second, secondPeer;
+    const bool isCreated = Net::Socket::CreatePair(Net::Protocol::TCP, first, firstPeer) &&
+                           Net::Socket::CreatePair(Net::Protocol::TCP, second, secondPeer);
+    LIBPOG_ASSERT(isCreated, "Socket pairs must be created");
+
+    Net::Relay forwarder(first, second);
+    forwarder.Stop();
+    const Net::Relay::Stats stats = forwarder.Run();
+    LIBPOG_ASSERT(stats.firstToSecond == 0 && stats.secondToFirst == 0, "Stopped relay must not forward");
+
+    std::cout << "Stop before run: OK." << std::endl;
+}
+#endif
+
+int main() {
+    CheckEcho();
+#ifndef _WIN32
+    CheckStopBeforeRun();
+#endif
+#ifdef __linux__
+    CheckStalledDestination();
+#endif
+
+    std::cout << "Done." << std::endl;
+    return 0;
+}
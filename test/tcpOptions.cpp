@@ -0,0 +1,81 @@
+#include "../src/socket.h"
+#include "../src/utils.h"
+
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Typed socket options, tuning profiles and TCP Fast Open connect on loopback.
+
+int main() {
+    Net::Socket listener(Net::Address::Family::IPv4, Net::Protocol::TCP);
+
+    // Plain options go through the fixed `SetOption`/`GetOption` too.
+    listener.SetOption(Net::Socket::Option::ReuseAddress, 1);
+    int reuseAddress = 0;
+    const bool isRead = listener.GetOption(Net::Socket::Option::ReuseAddress, reuseAddress);
+    LIBPOG_ASSERT(isRead && reuseAddress != 0, "Option must be set");
+
+#ifdef TCP_FASTOPEN
+    const bool isFastOpen = listener.Set<Net::SocketOption::FastOpen>(16);
+    LIBPOG_ASSERT(isFastOpen, "Fast Open must be enabled on listener");
+#endif
+    const Net::Address::port_t port = listener.Listen(Net::Address::FromString("127.0.0.1", 0));
+    LIBPOG_ASSERT(port != Net::Address::INVALID_PORT, "Listener must listen");
+
+    const std::string request = "GET / HTTP/1.1\r\n\r\n";
+    std::thread server([&listener, &request]() {
+        // Second connection may carry the data in SYN, both must deliver it intact.
+        for (int i = 0; i < 2; ++i) {
+            Net::Socket connection = listener.Accept();
+            std::string received(request.size(), '\0');
+            size_t offset = 0;
+            while (offset < received.size()) {
+                const uint ret = connection.Receive(received.data() + offset, received.size() - offset);
+                if (ret == 0) break;
+                offset += ret;
+            }
+            LIBPOG_ASSERT(received == request, "Request must arrive");
+            connection.Send("ok", 2);
+        }
+    });
+
+    const Net::Address address = Net::Address::FromString("127.0.0.1", port);
+    for (int i = 0; i < 2; ++i) {
+        Net::Socket client(Net::Address::Family::IPv4, Net::Protocol::TCP);
+        const bool isApplied = client.ApplyProfile(Net::TcpProfile::LowLatency());
+        LIBPOG_ASSERT(isApplied, "Profile must apply");
+
+        bool noDelay = false;
+        const bool isRead = client.Get<Net::SocketOption::NoDelay>(noDelay);
+        LIBPOG_ASSERT(isRead && noDelay, "No delay must be set");
+
+        const uint sent = client.ConnectFastOpen(address, request.data(), request.size());
+        LIBPOG_ASSERT(sent == request.size() && client.IsConnected(), "Fast Open connect must send the request");
+
+        char reply[2];
+        const uint received = client.Receive(reply, sizeof(reply));
+        LIBPOG_ASSERT(received == 2, "Reply must arrive");
+    }
+    server.join();
+    std::cout << "Fast Open connect: OK." << std::endl;
+
+    Net::Socket bulk(Net::Address::Family::IPv4, Net::Protocol::TCP);
+    const bool isApplied = bulk.ApplyProfile(Net::TcpProfile::Throughput());
+    LIBPOG_ASSERT(isApplied, "Profile must apply");
+
+    int sendBuffer = 0;
+    bulk.Get<Net::SocketOption::SendBuffer>(sendBuffer);
+    std::cout << "Throughput profile send buffer: " << sendBuffer << " bytes." << std::endl;
+
+#ifdef TCP_CORK
+    const bool isCorked = bulk.Set<Net::SocketOption::Cork>(true);
+    LIBPOG_ASSERT(isCorked, "Cork must be set");
+    bool cork = false;
+    const bool isCorkRead = bulk.Get<Net::SocketOption::Cork>(cork);
+    LIBPOG_ASSERT(isCorkRead && cork, "Cork must be read back");
+#endif
+
+    std::cout << "Done." << std::endl;
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include "../src/socket.h"
+#include "../src/utils.h"
+
+#include <poll.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// Software `SO_TIMESTAMPING` on loopback: RX timestamps and dwell time of datagrams,
+// TX timestamps from the error queue and the kernel path latency between both.
+
+static constexpr uint DATAGRAMS_COUNT = 1000;
+
+// Waits for the error queue, TX timestamps are reported asynchronously.
+static bool WaitTxTimestamp(Net::Socket& socket, Net::TxTimestamp& outTimestamp) {
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        if (socket.ReceiveTxTimestamp(outTimestamp)) return true;
+        const Net::Status status = socket.Fail();
+        LIBPOG_ASSERT(status == Net::TryAgain, "Error queue must be readable");
+
+        struct pollfd pollFd = {socket.GetHandle(), 0, 0};
+        poll(&pollFd, 1, 10);
+    }
+    return false;
+}
+
+static void CheckDatagrams() {
+    Net::Socket receiver(Net::Address::Family::IPv4, Net::Protocol::UDP);
+    Net::Socket sender(Net::Address::Family::IPv4, Net::Protocol::UDP);
+    const bool isBound = receiver.Bind(Net::Address::FromString("127.0.0.1", 0));
+    LIBPOG_ASSERT(isBound, "Receiver must bind");
+
+    const bool isEnabled = receiver.EnableTimestamping(Net::Socket::RxSoftware) &&
+                           sender.EnableTimestamping(Net::Socket::TxSoftware);
+    LIBPOG_ASSERT(isEnabled, "Timestamping must be enabled");
+
+    sockaddr_in boundAddress;
+    socklen_t addressSize = sizeof(boundAddress);
+    getsockname(receiver.GetHandle(), reinterpret_cast<sockaddr*>(&boundAddress), &addressSize);
+    const Net::Address address = Net::Address::FromString("127.0.0.1", ntohs(boundAddress.sin_port));
+
+    // The kernel turns stack timestamps on asynchronously, the first datagrams may arrive without them.
+    // Probes come from another socket, so the TX ids of `sender` still start at zero.
+    Net::Socket probe(Net::Address::Family::IPv4, Net::Protocol::UDP);
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        probe.SendTo(address, "probe", 5);
+
+        char buffer[8];
+        Net::Address from;
+        Net::PacketTimestamps rx;
+        receiver.ReceiveFrom(buffer, sizeof(buffer), from, rx);
+        if (rx.software != 0) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::vector<uint64_t> pathLatencies;
+    std::vector<uint64_t> dwellTimes;
+    uint txCount = 0;
+
+    for (uint i = 0; i < DATAGRAMS_COUNT; ++i) {
+        const uint sent = sender.SendTo(address, reinterpret_cast<const char*>(&i), sizeof(i));
+        LIBPOG_ASSERT(sent == sizeof(i), "Must send");
+
+        // Driver hand-off of this datagram, the scheduler stage comes first.
+        uint64_t sentAt = 0;
+        Net::TxTimestamp tx;
+        while (sentAt == 0 && WaitTxTimestamp(sender, tx)) {
+            LIBPOG_ASSERT(tx.id == i && tx.timestamps.software != 0, "TX timestamp must belong to the datagram");
+            if (tx.stage == Net::TxTimestamp::Stage::Sent) sentAt = tx.timestamps.software;
+        }
+        LIBPOG_ASSERT(sentAt != 0, "TX timestamp must be reported");
+        ++txCount;
+
+        // Every 100th datagram is left waiting in the socket for a while.
+        if (i % 100 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+        uint value = 0;
+        Net::Address from;
+        Net::PacketTimestamps rx;
+        const uint received = receiver.ReceiveFrom(reinterpret_cast<char*>(&value), sizeof(value), from, rx);
+        LIBPOG_ASSERT(received == sizeof(value), "Datagram must arrive");
+        LIBPOG_ASSERT(value == i && rx.software != 0 && rx.hardware == 0, "RX timestamp must be reported");
+        LIBPOG_ASSERT(from.GetPort() != Net::Address::INVALID_PORT, "Sender must be known");
+
+        if (i % 100 == 0) {
+            LIBPOG_ASSERT(rx.GetDwellTime() >= 2000000, "Dwell time must include the wait");
+        } else {
+            dwellTimes.push_back(rx.GetDwellTime());
+        }
+        pathLatencies.push_back(rx.software - sentAt);
+    }
+
+    std::sort(pathLatencies.begin(), pathLatencies.end());
+    std::sort(dwellTimes.begin(), dwellTimes.end());
+    std::cout << "Datagrams: OK (" << txCount << " TX timestamps, TX->RX p50 "
+              << pathLatencies[pathLatencies.size() / 2] << "ns, dwell p50 " << dwellTimes[dwellTimes.size() / 2]
+              << "ns)." << std::endl;
+}
+
+static void CheckStream() {
+    Net::Socket listener(Net::Address::Family::IPv4, Net::Protocol::TCP);
+    const Net::Address::port_t port = listener.Listen(Net::Address::FromString("127.0.0.1", 0));
+
+    Net::Socket client(Net::Address::Family::IPv4, Net::Protocol::TCP);
+    const bool isConnected = client.Connect(Net::Address::FromString("127.0.0.1", port));
+    LIBPOG_ASSERT(isConnected, "Client must connect");
+    Net::Socket server = listener.Accept();
+
+    const uint8_t txFlags = Net::Socket::TxSoftware | Net::Socket::TxAcknowledged;
+    const bool isEnabled =
+        server.EnableTimestamping(Net::Socket::RxSoftware) && client.EnableTimestamping(txFlags);
+    LIBPOG_ASSERT(isEnabled, "Timestamping must be enabled");
+
+    const char message[] = "timestamped";
+    client.Send(message, sizeof(message));
+
+    char buffer[32];
+    Net::PacketTimestamps rx;
+    const uint received = server.Receive(buffer, sizeof(buffer), rx);
+    LIBPOG_ASSERT(received == sizeof(message) && rx.software != 0, "RX must work");
+
+    // Stream ids are the offset of the last byte of the send call.
+    bool isAcknowledged = false;
+    Net::TxTimestamp tx;
+    while (isAcknowledged == false && WaitTxTimestamp(client, tx)) {
+        LIBPOG_ASSERT(tx.id == sizeof(message) - 1, "TX id must be the byte offset");
+        isAcknowledged = tx.stage == Net::TxTimestamp::Stage::Acknowledged;
+    }
+    LIBPOG_ASSERT(isAcknowledged, "ACK timestamp must be reported");
+
+    std::cout << "Stream: OK." << std::endl;
+}
+
+int main() {
+    CheckDatagrams();
+    CheckStream();
+
+    std::cout << "Done." << std::endl;
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "../src/typedSocket.h"
+#include "../src/utils.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Typed sockets: invalid operations must not compile, I/O must work for both families.
+
+typedef Net::Endpoint<Net::Address::Family::IPv4> Endpoint4;
+
+// Detects whether the call compiles.
+template<typename S>
+constexpr auto CanSendTo(int) -> decltype(std::declval<S&>().SendTo(std::declval<Endpoint4&>(), "", 0), true) {
+    return true;
+}
+template<typename S>
+constexpr bool CanSendTo(...) {
+    return false;
+}
+
+template<typename S>
+constexpr auto CanSend(int) -> decltype(std::declval<S&>().Send("", 0), true) {
+    return true;
+}
+template<typename S>
+constexpr bool CanSend(...) {
+    return false;
+}
+
+static_assert(CanSend<Net::TcpStream4>(0) && !CanSendTo<Net::TcpStream4>(0), "Streams have no `SendTo`");
+static_assert(CanSendTo<Net::UdpSocket4>(0) && !CanSend<Net::UdpSocket4>(0), "UDP sockets are addressed per call");
+static_assert(!CanSend<Net::TcpListener4>(0), "Listeners don't send");
+static_assert(Net::Endpoint<Net::Address::Family::IPv6>::SIZE == sizeof(sockaddr_in6), "Size must be constant");
+
+template<Net::Address::Family F>
+static void CheckTcp(const char* loopback) {
+    Net::TcpListener<F> listener = Net::TcpListener<F>::Listen(Net::Endpoint<F>::FromString(loopback, 0));
+    if (listener.IsValid() == false) {
+        std::cout << "TCP " << Net::Address::GetFamilyName(F) << ": skipped, no loopback." << std::endl;
+        return;
+    }
+    const Net::Address::port_t port = listener.GetLocalEndpoint().GetPort();
+
+    constexpr uint ROUND_TRIPS = 20000;
+    std::thread server([&listener]() {
+        Net::TcpStream<F> connection = listener.Accept();
+        connection.template Set<Net::SocketOption::NoDelay>(true);
+
+        uint64_t value;
+        while (connection.ReceiveValue(value).size == sizeof(value)) {
+            ++value;
+            connection.SendValue(value);
+        }
+    });
+
+    Net::TcpStream<F> stream = Net::TcpStream<F>::Connect(Net::Endpoint<F>::FromString(loopback, port));
+    LIBPOG_ASSERT(stream.IsValid(), "Stream must connect");
+    stream.template Set<Net::SocketOption::NoDelay>(true);
+
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t value = 0;
+    for (uint i = 0; i < ROUND_TRIPS; ++i) {
+        stream.SendValue(value);
+        const Net::IoResult result = stream.ReceiveValue(value);
+        LIBPOG_ASSERT(result && result.size == sizeof(value), "Value must be received");
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    LIBPOG_ASSERT(value == ROUND_TRIPS, "Every round trip must increment");
+
+    stream.Close();
+    server.join();
+
+    std::cout << "TCP " << Net::Address::GetFamilyName(F) << ": " << ROUND_TRIPS / elapsed.count()
+              << " round trips/s." << std::endl;
+}
+
+static void CheckUdp() {
+    Net::UdpSocket4 server = Net::UdpSocket4::Bind(Endpoint4::FromString("127.0.0.1", 0));
+    Net::UdpSocket4 client = Net::UdpSocket4::Open();
+    LIBPOG_ASSERT(server.IsValid() && client.IsValid(), "UDP sockets must open");
+
+    const Endpoint4 serverEndpoint = Endpoint4::FromString("127.0.0.1", server.GetLocalEndpoint().GetPort());
+    client.SendTo(serverEndpoint, "ping");
+
+    char buffer[16];
+    Endpoint4 sender;
+    const Net::IoResult received = server.ReceiveFrom(buffer, sizeof(buffer), sender);
+    LIBPOG_ASSERT(received && std::string_view(buffer, received.size) == "ping", "Datagram must arrive");
+
+    server.SendTo(sender, "pong");
+    const Net::IoResult replied = client.ReceiveFrom(buffer, sizeof(buffer), sender);
+    LIBPOG_ASSERT(replied.size == 4, "Reply must arrive");
+    LIBPOG_ASSERT(sender.ToAddress().ConvertToString() == serverEndpoint.ToAddress().ConvertToString(), "Sender");
+
+    std::cout << "UDP: OK." << std::endl;
+}
+
+int main() {
+    CheckTcp<Net::Address::Family::IPv4>("127.0.0.1");
+    CheckTcp<Net::Address::Family::IPv6>("::1");
+    CheckUdp();
+
+    std::cout << "Done." << std::endl;
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "../src/udpDemux.h"
+#include "../src/utils.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Many UDP peers served through one socket: every flow keeps its own counter,
+// replies go back through the shared socket, idle flows expire.
+
+int main() {
+    constexpr uint PEERS_COUNT = 300;
+    constexpr uint DATAGRAMS_PER_PEER = 20;
+    constexpr uint IDLE_TIMEOUT_MS = 300;
+    constexpr uint WAVE_SIZE = 30;
+
+    Net::UdpDemux demux;
+    const Net::Address::port_t port = demux.Bind(Net::Address::FromString("127.0.0.1", 0));
+    LIBPOG_ASSERT(port != Net::Address::INVALID_PORT, "Demux must bind");
+
+    uint accepted = 0;
+    uint expired = 0;
+    demux.SetIdleTimeout(IDLE_TIMEOUT_MS);
+    demux.SetExpireHandler([&expired](Net::UdpDemux::Peer&) { ++expired; });
+    demux.SetAcceptor([&accepted](Net::UdpDemux::Peer&) -> Net::UdpDemux::Handler {
+        ++accepted;
+
+        // Per-flow state lives in the handler.
+        return [count = 0u](Net::UdpDemux::Peer& peer, const std::string_view datagram) mutable {
+            ++count;
+            if (datagram == "bye") {
+                peer.Close();
+                return;
+            }
+            const std::string reply = std::to_string(count);
+            peer.Send(reply);
+        };
+    });
+
+    std::thread serverThread([&demux]() { demux.Run(); });
+
+    const Net::Address serverAddress = Net::Address::FromString("127.0.0.1", port);
+    std::vector<Net::Socket> clients(PEERS_COUNT);
+    for (Net::Socket& client : clients) {
+        client.Open(Net::Address::Family::IPv4, Net::Protocol::UDP);
+        client.Connect(serverAddress);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    char buffer[32];
+    for (uint round = 1; round <= DATAGRAMS_PER_PEER; ++round) {
+        // Waves are small enough to fit into the socket receive buffer, UDP drops the rest.
+        for (uint wave = 0; wave < PEERS_COUNT; wave += WAVE_SIZE) {
+            for (uint i = wave; i < wave + WAVE_SIZE; ++i) {
+                clients[i].Send("ping", 4);
+            }
+            for (uint i = wave; i < wave + WAVE_SIZE; ++i) {
+                const uint received = clients[i].Receive(buffer, sizeof(buffer));
+                LIBPOG_ASSERT(std::string_view(buffer, received) == std::to_string(round), "Flow must keep its state");
+            }
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "Round trips: " << PEERS_COUNT * DATAGRAMS_PER_PEER / elapsed.count() << "/s over "
+              << PEERS_COUNT << " peers." << std::endl;
+
+    // Closed flow starts from scratch.
+    clients[0].Send("bye", 3);
+    clients[0].Send("ping", 4);
+    const uint received = clients[0].Receive(buffer, sizeof(buffer));
+    LIBPOG_ASSERT(std::string_view(buffer, received) == "1", "Closed flow must be recreated");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_TIMEOUT_MS * 2));
+    demux.Stop();
+    serverThread.join();
+
+    LIBPOG_ASSERT(accepted == PEERS_COUNT + 1, "Every peer must be accepted once");
+    LIBPOG_ASSERT(expired == accepted && demux.GetPeersCount() == 0, "Idle flows must expire");
+    std::cout << "Flows accepted: " << accepted << ", expired: " << expired << std::endl;
+
+    std::cout << "Done." << std::endl;
+    return 0;
+}
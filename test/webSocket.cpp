@@ -0,0 +1,216 @@
+#include "../src/httpClient.h"
+#include "../src/httpServer.h"
+#include "../src/utils.h"
+#include "../src/webSocket.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef Net::WebSocket WebSocket;
+
+static void ApplyMaskScalar(uint8_t* data, const size_t size, const uint8_t mask[4], const size_t offset) {
+    for (size_t i = 0; i < size; ++i) {
+        data[i] ^= mask[(offset + i) & 3];
+    }
+}
+
+static void CheckMask() {
+    std::mt19937 random(42);
+    const uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+
+    // Sizes around SIMD widths and all key rotations.
+    for (size_t size = 0; size < 200; ++size) {
+        for (size_t offset = 0; offset < 4; ++offset) {
+            std::vector<uint8_t> expected(size + 1);
+            for (uint8_t& byte : expected) byte = static_cast<uint8_t>(random());
+            std::vector<uint8_t> actual = expected;
+
+            // Unaligned start on purpose.
+            ApplyMaskScalar(expected.data() + 1, size, mask, offset);
+            WebSocket::ApplyMask(actual.data() + 1, size, mask, offset);
+            LIBPOG_ASSERT(expected == actual, "Vectorized mask must match scalar one");
+        }
+    }
+
+    std::vector<uint8_t> data(16 * 1024 * 1024, 0xaa);
+    constexpr uint ROUNDS = 16;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (uint i = 0; i < ROUNDS; ++i) {
+        WebSocket::ApplyMask(data.data(), data.size(), mask, i);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "Masking: " << (data.size() * ROUNDS / elapsed.count() / 1e9) << " GB/s." << std::endl;
+}
+
+static void CheckEcho(const Net::Address::port_t port, const bool useDeflate) {
+    Net::HttpClient client;
+    if (client.Connect("127.0.0.1", port) != Net::Success) {
+        std::cerr << "Failed to connect." << std::endl;
+        std::exit(-1);
+    }
+
+    WebSocket::Options options;
+    options.usePerMessageDeflate = useDeflate;
+
+    WebSocket webSocket;
+    const Net::Status status = client.UpgradeToWebSocket("/echo", webSocket, options);
+    LIBPOG_ASSERT(status == Net::Success && webSocket.IsOpen(), "Handshake must succeed");
+    LIBPOG_ASSERT(webSocket.IsCompressed() == (useDeflate && WebSocket::IsDeflateSupported()), "Deflate mismatch");
+
+    WebSocket::Message message;
+
+    webSocket.SendText("hello");
+    bool isReceived = webSocket.Receive(message);
+    LIBPOG_ASSERT(isReceived && message.IsText() && message.data == "hello", "Text must echo");
+
+    // Pong is consumed inside `Receive()`.
+    webSocket.Ping("ping");
+
+    std::string binary(1024 * 1024 + 7, '\0');
+    for (size_t i = 0; i < binary.size(); ++i) binary[i] = static_cast<char>(i * 31);
+    webSocket.SendBinary(binary);
+    isReceived = webSocket.Receive(message);
+    LIBPOG_ASSERT(isReceived && message.IsBinary() && message.data == binary, "Binary must echo");
+
+    const std::string text(300000, 'x');
+    for (uint i = 0; i < 3; ++i) {
+        webSocket.SendText(text);
+        isReceived = webSocket.Receive(message);
+        LIBPOG_ASSERT(isReceived && message.data == text, "Repeated message must echo");
+    }
+
+    webSocket.Close();
+    LIBPOG_ASSERT(webSocket.GetCloseCode() == WebSocket::CloseCode::Normal, "Close handshake must complete");
+
+    std::cout << "Echo" << (webSocket.IsCompressed() ? " (permessage-deflate)" : "") << ": OK." << std::endl;
+}
+
+// Continuation frame declaring 64-bit length with the top bit set must fail the connection, not grow the message.
+static void CheckHugeLength(const Net::Address::port_t port) {
+    Net::Socket socket(Net::Address::Family::IPv4, Net::Protocol::TCP);
+    const bool isConnected = socket.Connect(Net::Address::FromString("127.0.0.1", port));
+    LIBPOG_ASSERT(isConnected, "Must connect");
+
+    const std::string request = "GET /echo HTTP/1.1\r\nHost: 127.0.0.1\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                                "Sec-WebSocket-Key: " + WebSocket::MakeKey() + "\r\nSec-WebSocket-Version: 13\r\n\r\n";
+    socket.Send(request.data(), static_cast<uint>(request.size()));
+
+    std::string input;
+    char buffer[1024];
+    while (input.find("\r\n\r\n") == std::string::npos) {
+        const uint received = socket.Receive(buffer, sizeof(buffer));
+        LIBPOG_ASSERT(received > 0, "Handshake response must arrive");
+        input.append(buffer, received);
+    }
+    LIBPOG_ASSERT(input.compare(0, 12, "HTTP/1.1 101") == 0, "Handshake must succeed");
+    input.erase(0, input.find("\r\n\r\n") + 4);
+
+    // Unfinished text fragment "a", then continuation with length 0xffffffffffffffff, both masked with zeros.
+    const char frames[] = "\x01\x81\0\0\0\0a"
+                          "\x80\xff\xff\xff\xff\xff\xff\xff\xff\xff\0\0\0\0";
+    socket.Send(frames, sizeof(frames) - 1);
+
+    while (input.size() < 4) {
+        const uint received = socket.Receive(buffer, sizeof(buffer));
+        LIBPOG_ASSERT(received > 0, "Close frame must arrive");
+        input.append(buffer, received);
+    }
+    LIBPOG_ASSERT(input.compare(0, 4, "\x88\x02\x03\xea") == 0, "Connection must close with protocol error");
+
+    std::cout << "Huge length: OK." << std::endl;
+}
+
+// Peer that never answers the close frame must not hang `Close()`.
+static void CheckCloseTimeout(const Net::Address::port_t port) {
+    Net::HttpClient client;
+    const Net::Status connectStatus = client.Connect("127.0.0.1", port);
+    LIBPOG_ASSERT(connectStatus == Net::Success, "Must connect");
+
+    WebSocket::Options options;
+    options.closeTimeoutMs = 200;
+
+    WebSocket webSocket;
+    const Net::Status status = client.UpgradeToWebSocket("/silent", webSocket, options);
+    LIBPOG_ASSERT(status == Net::Success, "Handshake must succeed");
+
+    const auto begin = std::chrono::steady_clock::now();
+    webSocket.Close();
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+
+    const bool isTimedOut = elapsed >= std::chrono::milliseconds(150) && elapsed < std::chrono::seconds(2);
+    LIBPOG_ASSERT(isTimedOut, "Close must time out");
+    LIBPOG_ASSERT(webSocket.IsOpen() == false, "Socket must be closed");
+
+    std::cout << "Close timeout: OK." << std::endl;
+}
+
+int main() {
+    CheckMask();
+
+    Net::HttpServer server;
+    server.Route("GET", "/echo", [](const Net::HttpRequest& request, Net::HttpResponseWriter& writer) {
+        WebSocket::Options options;
+        options.usePerMessageDeflate = true;
+
+        writer.AcceptWebSocket(
+            request,
+            [](WebSocket& webSocket) {
+                WebSocket::Message message;
+                while (webSocket.Receive(message)) {
+                    webSocket.Send(message.data, message.opcode);
+                }
+            },
+            options
+        );
+    });
+
+    std::atomic<bool> isSilentDone = false;
+    server.Route("GET", "/silent", [&isSilentDone](const Net::HttpRequest& request, Net::HttpResponseWriter& writer) {
+        writer.AcceptWebSocket(request, [&isSilentDone](WebSocket&) {
+            while (isSilentDone == false) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        });
+    });
+
+    // Waits for messages that never come, stopping the server must end it.
+    std::atomic<bool> isHeldDone = false;
+    server.Route("GET", "/held", [&isHeldDone](const Net::HttpRequest& request, Net::HttpResponseWriter& writer) {
+        writer.AcceptWebSocket(request, [&isHeldDone](WebSocket& webSocket) {
+            WebSocket::Message message;
+            while (webSocket.Receive(message)) {}
+            isHeldDone = true;
+        });
+    });
+
+    const Net::Address::port_t port = server.Listen(Net::Address::FromString("127.0.0.1", 0));
+    LIBPOG_ASSERT(port != Net::Address::INVALID_PORT, "Server must listen");
+
+    std::thread serverThread([&server]() { server.Run(); });
+
+    CheckEcho(port, false);
+    CheckEcho(port, true);
+    CheckHugeLength(port);
+    CheckCloseTimeout(port);
+    isSilentDone = true;
+
+    Net::HttpClient heldClient;
+    const Net::Status connectStatus = heldClient.Connect("127.0.0.1", port);
+    LIBPOG_ASSERT(connectStatus == Net::Success, "Must connect");
+    WebSocket heldWebSocket;
+    const Net::Status status = heldClient.UpgradeToWebSocket("/held", heldWebSocket);
+    LIBPOG_ASSERT(status == Net::Success, "Handshake must succeed");
+
+    server.Stop();
+    serverThread.join();
+    LIBPOG_ASSERT(isHeldDone, "Handlers must be finished once the server has stopped");
+    std::cout << "Stop with open connection: OK." << std::endl;
+
+    std::cout << "Done." << std::endl;
+    return 0;
+}
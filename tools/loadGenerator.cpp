@@ -0,0 +1,448 @@
+#include "../src/httpBatchFetcher.h"
+#include "../src/httpClient.h"
+#include "../src/httpServer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// wrk-style HTTP load generator on top of `HttpClient`.
+//
+// With `-R` requests are issued on an open-loop schedule: every connection has its own timeline
+// of intended send times and latency is measured from the intended time, not from the moment
+// the request was actually written. A stalled server then shows up in the percentiles instead of
+// silently lowering the request rate (coordinated omission). Without `-R` connections run closed-loop.
+//
+// `HttpClient` is blocking, so every connection runs on its own thread and `-c` is the real concurrency.
+// Without the URL a local echo server is started, so the tool runs fully offline.
+
+using Clock = std::chrono::steady_clock;
+
+static void PrintUsage() {
+    std::cout << "Usage: loadGenerator [options] [http://host[:port]/path]\n"
+                 "  -c <N>       connections to keep open, each on its own thread (default 10)\n"
+                 "  -t <N>       echo server threads for --echo-server (default 2)\n"
+                 "  -d <sec>     test duration (default 10)\n"
+                 "  -R <N>       total requests/sec, open-loop with coordinated omission correction\n"
+                 "               (default 0: closed-loop, as fast as responses arrive)\n"
+                 "  -m <METHOD>  request method (default GET)\n"
+                 "  -b <BODY>    request body\n"
+                 "  -H <HEADER>  additional header, `Name: value`, can be repeated\n"
+                 "  --echo-server <PORT>  only run the echo server until killed\n"
+                 "Without the URL the load is applied to the bundled echo server on loopback."
+              << std::endl;
+}
+
+/// Log-linear histogram of microseconds: values below 64 are exact, above that every power of two
+/// is split into 32 sub-buckets, so the relative error stays under ~3% on any scale.
+class Histogram {
+private:
+    static constexpr uint SUB_BUCKETS = 32;
+    static constexpr uint MAX_SHIFT = 40;
+    static constexpr size_t BUCKETS_COUNT = 2 * SUB_BUCKETS + MAX_SHIFT * SUB_BUCKETS;
+
+    std::vector<uint64_t> counts = std::vector<uint64_t>(BUCKETS_COUNT);
+    uint64_t totalCount = 0;
+    uint64_t minValue = UINT64_MAX;
+    uint64_t maxValue = 0;
+    double sum = 0;
+    double sumOfSquares = 0;
+
+    static size_t GetIndex(uint64_t value) {
+        if (value < 2 * SUB_BUCKETS) {
+            return value;
+        }
+
+        value = std::min<uint64_t>(value, (1ull << (MAX_SHIFT + 5)) - 1);
+        const uint shift = (63 - __builtin_clzll(value)) - 5;
+        return 2 * SUB_BUCKETS + (shift - 1) * SUB_BUCKETS + ((value >> shift) - SUB_BUCKETS);
+    }
+
+    /// Highest value that falls into the bucket.
+    static uint64_t GetUpperValue(const size_t index) {
+        if (index < 2 * SUB_BUCKETS) {
+            return index;
+        }
+
+        const size_t offset = index - 2 * SUB_BUCKETS;
+        const uint shift = static_cast<uint>(offset / SUB_BUCKETS) + 1;
+        const uint64_t mantissa = SUB_BUCKETS + offset % SUB_BUCKETS;
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+public:
+    void Record(const uint64_t valueUs) {
+        ++counts[GetIndex(valueUs)];
+        ++totalCount;
+        minValue = std::min(minValue, valueUs);
+        maxValue = std::max(maxValue, valueUs);
+        sum += static_cast<double>(valueUs);
+        sumOfSquares += static_cast<double>(valueUs) * static_cast<double>(valueUs);
+    }
+
+    void Merge(const Histogram& other) {
+        for (size_t i = 0; i < BUCKETS_COUNT; ++i) {
+            counts[i] += other.counts[i];
+        }
+        totalCount += other.totalCount;
+        minValue = std::min(minValue, other.minValue);
+        maxValue = std::max(maxValue, other.maxValue);
+        sum += other.sum;
+        sumOfSquares += other.sumOfSquares;
+    }
+
+    uint64_t GetPercentile(const double percentile) const {
+        if (totalCount == 0) {
+            return 0;
+        }
+
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(percentile / 100 * totalCount)));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS_COUNT; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return std::min(GetUpperValue(i), maxValue);
+            }
+        }
+        return maxValue;
+    }
+
+    inline uint64_t GetCount() const { return totalCount; }
+    inline uint64_t GetMin() const { return totalCount ? minValue : 0; }
+    inline uint64_t GetMax() const { return maxValue; }
+    inline double GetMean() const { return totalCount ? sum / totalCount : 0; }
+    inline double GetStdDev() const {
+        if (totalCount == 0) return 0;
+        const double mean = GetMean();
+        return std::sqrt(std::max(0.0, sumOfSquares / totalCount - mean * mean));
+    }
+
+    /// Counts of values in `[lower, upper)` for the ASCII distribution.
+    uint64_t CountRange(const uint64_t lower, const uint64_t upper) const {
+        uint64_t count = 0;
+        for (size_t i = GetIndex(lower); i < BUCKETS_COUNT && GetUpperValue(i) < upper; ++i) {
+            count += counts[i];
+        }
+        return count;
+    }
+};
+
+struct Options {
+    uint connections = 10;
+    uint threads = 2;
+    double seconds = 10;
+    double rate = 0;
+
+    std::string host = "127.0.0.1";
+    Net::Address::port_t port = 0;
+    std::string path = "/";
+    std::string method = "GET";
+    std::string body;
+    std::vector<std::string> headers;
+};
+
+struct ConnectionResult {
+    Histogram corrected;
+    Histogram service;
+    uint64_t responses = 0;
+    uint64_t bytes = 0;
+    uint64_t connectErrors = 0;
+    uint64_t requestErrors = 0;
+    uint64_t statusErrors = 0;
+    Clock::time_point lastFinish;
+};
+
+static std::string FormatDuration(const double valueUs) {
+    char text[32];
+    if (valueUs < 1000) {
+        std::snprintf(text, sizeof(text), "%.0fus", valueUs);
+    } else if (valueUs < 1000000) {
+        std::snprintf(text, sizeof(text), "%.2fms", valueUs / 1000);
+    } else {
+        std::snprintf(text, sizeof(text), "%.2fs", valueUs / 1000000);
+    }
+    return text;
+}
+
+static std::string FormatBytes(const double bytes) {
+    static constexpr const char* UNITS[] = {"B", "KB", "MB", "GB"};
+
+    double value = bytes;
+    size_t unit = 0;
+    while (value >= 1024 && unit + 1 < std::size(UNITS)) {
+        value /= 1024;
+        ++unit;
+    }
+
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.2f%s", value, UNITS[unit]);
+    return text;
+}
+
+static bool ParseUrl(const std::string_view url, Options& options) {
+    Net::HttpBatchFetcher::Request request;
+    if (Net::HttpBatchFetcher::ParseUrl(url, request) == false) {
+        std::cerr << "Only http://host[:port]/path URLs are supported." << std::endl;
+        return false;
+    }
+
+    options.host = std::move(request.host);
+    options.port = request.port;
+    options.path = std::move(request.uri);
+    return true;
+}
+
+static void SetupEchoServer(Net::HttpServer& server) {
+    // Echoes the body, or the request target if there is no body.
+    server.SetFallback([](const Net::HttpRequest& request, Net::HttpResponseWriter& response) {
+        response.AddHeader("Content-Type", "text/plain");
+        response.SetBody(request.body.empty() ? request.target : request.body);
+    });
+}
+
+static void RunConnection(const Options& options, const std::vector<Net::HttpClient::Header>& headers,
+                          const uint index, const Clock::time_point begin, const Clock::time_point end,
+                          ConnectionResult& result) {
+    // Every connection sends at `rate / connections`, start times are staggered over one interval.
+    const bool isOpenLoop = options.rate > 0;
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(isOpenLoop ? options.connections / options.rate : 0)
+    );
+
+    Net::HttpClient client;
+    if (client.Connect(options.host.c_str(), options.port) != Net::Success) {
+        ++result.connectErrors;
+    }
+
+    Net::HttpResponse response;
+    for (Clock::time_point due = begin + interval * index / options.connections; due < end;) {
+        if (isOpenLoop) {
+            std::this_thread::sleep_until(due);
+        }
+
+        const Clock::time_point start = Clock::now();
+        const Net::Status status = client.Request(options.method, options.path, response, options.body, headers);
+        const Clock::time_point finish = Clock::now();
+        result.lastFinish = finish;
+
+        if (status != Net::Success) {
+            ++result.requestErrors;
+            // Don't spin on a dead server, the schedule keeps running and the delay is counted.
+            if (isOpenLoop == false) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        } else {
+            // Open-loop latency starts at the intended send time: waiting for the previous response
+            // of the same connection is the part coordinated omission would hide.
+            const Clock::time_point from = isOpenLoop ? due : start;
+            result.corrected.Record(std::chrono::duration_cast<std::chrono::microseconds>(finish - from).count());
+            result.service.Record(std::chrono::duration_cast<std::chrono::microseconds>(finish - start).count());
+
+            ++result.responses;
+            result.bytes += response.body.size();
+            if (response.status < 200 || response.status > 399) ++result.statusErrors;
+        }
+
+        due = isOpenLoop ? due + interval : finish;
+    }
+}
+
+static void PrintDistribution(const Histogram& histogram) {
+    static constexpr uint BAR_WIDTH = 50;
+
+    // Power of two ranges between min and max.
+    uint64_t lower = 1;
+    while (lower * 2 <= histogram.GetMin()) lower *= 2;
+
+    std::vector<std::pair<uint64_t, uint64_t>> rows;
+    uint64_t maxCount = 0;
+    for (; lower <= histogram.GetMax(); lower *= 2) {
+        const uint64_t count = histogram.CountRange(lower == 1 ? 0 : lower, lower * 2);
+        rows.emplace_back(lower, count);
+        maxCount = std::max(maxCount, count);
+    }
+
+    for (const auto& [rowLower, count] : rows) {
+        const uint width = maxCount ? static_cast<uint>(count * BAR_WIDTH / maxCount) : 0;
+        char label[64];
+        std::snprintf(label, sizeof(label), "  %9s - %-9s %10llu  ", FormatDuration(rowLower).c_str(),
+                      FormatDuration(rowLower * 2).c_str(), static_cast<unsigned long long>(count));
+        std::cout << label << std::string(width, '#') << '\n';
+    }
+}
+
+static void PrintReport(const Options& options, const ConnectionResult& total, const double elapsed) {
+    const bool isOpenLoop = options.rate > 0;
+
+    std::printf("  Thread Stats   %10s %10s %10s\n", "Avg", "Stdev", "Max");
+    std::printf("    Latency      %10s %10s %10s\n", FormatDuration(total.corrected.GetMean()).c_str(),
+                FormatDuration(total.corrected.GetStdDev()).c_str(),
+                FormatDuration(static_cast<double>(total.corrected.GetMax())).c_str());
+
+    std::printf("\n  Latency Distribution%s\n", isOpenLoop ? " (corrected for coordinated omission)" : "");
+    std::printf("  %10s %12s %12s\n", "Percentile", "Latency", "Service");
+    for (const double percentile : {50.0, 75.0, 90.0, 99.0, 99.9, 99.99, 99.999, 100.0}) {
+        std::printf("  %9.3f%% %12s %12s\n", percentile,
+                    FormatDuration(static_cast<double>(total.corrected.GetPercentile(percentile))).c_str(),
+                    FormatDuration(static_cast<double>(total.service.GetPercentile(percentile))).c_str());
+    }
+
+    std::printf("\n  Latency Histogram\n");
+    PrintDistribution(total.corrected);
+    std::cout.flush();
+
+    std::printf("\n  %llu requests in %.2fs, %s read\n", static_cast<unsigned long long>(total.responses), elapsed,
+                FormatBytes(static_cast<double>(total.bytes)).c_str());
+    if (total.connectErrors || total.requestErrors) {
+        std::printf("  Socket errors: connect %llu, request %llu\n",
+                    static_cast<unsigned long long>(total.connectErrors),
+                    static_cast<unsigned long long>(total.requestErrors));
+    }
+    if (total.statusErrors) {
+        std::printf("  Non-2xx or 3xx responses: %llu\n", static_cast<unsigned long long>(total.statusErrors));
+    }
+    std::printf("Requests/sec: %10.2f\n", total.responses / elapsed);
+    std::printf("Transfer/sec: %10s\n", FormatBytes(total.bytes / elapsed).c_str());
+
+    if (isOpenLoop && total.responses / elapsed < options.rate * 0.95) {
+        std::printf("Target rate %.0f req/s was not reached, try more connections.\n", options.rate);
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    std::string url;
+    int echoServerPort = -1;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+
+        if (arg == "-h" || arg == "--help") {
+            PrintUsage();
+            return 0;
+        } else if (arg == "-c" && hasValue) {
+            options.connections = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "-t" && hasValue) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "-d" && hasValue) {
+            options.seconds = std::atof(argv[++i]);
+        } else if (arg == "-R" && hasValue) {
+            options.rate = std::atof(argv[++i]);
+        } else if (arg == "-m" && hasValue) {
+            options.method = argv[++i];
+        } else if (arg == "-b" && hasValue) {
+            options.body = argv[++i];
+        } else if (arg == "-H" && hasValue) {
+            options.headers.emplace_back(argv[++i]);
+        } else if (arg == "--echo-server" && hasValue) {
+            echoServerPort = std::atoi(argv[++i]);
+        } else if (arg.substr(0, 1) != "-" && url.empty()) {
+            url = arg;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    Net::HttpServer server;
+    SetupEchoServer(server);
+
+    if (echoServerPort >= 0) {
+        const Net::Address::port_t port =
+            server.Listen(Net::Address::FromString("0.0.0.0", static_cast<Net::Address::port_t>(echoServerPort)));
+        if (port == Net::Address::INVALID_PORT) {
+            std::cerr << "Failed to listen." << std::endl;
+            return 1;
+        }
+
+        std::cout << "Echo server listening on port " << port << std::endl;
+        server.Run(options.threads);
+        return 0;
+    }
+
+    // Keeps the local server busy on its own threads, the load threads are separate.
+    std::thread serverThread;
+    if (url.empty()) {
+        options.port = server.Listen(Net::Address::FromString("127.0.0.1", 0, Net::Address::Family::IPv4));
+        if (options.port == Net::Address::INVALID_PORT) {
+            std::cerr << "Failed to start the echo server." << std::endl;
+            return 1;
+        }
+        options.path = "/echo";
+        url = "http://127.0.0.1:" + std::to_string(options.port) + options.path;
+
+        const uint serverThreads = std::max(1u, std::thread::hardware_concurrency() / 2);
+        serverThread = std::thread([&server, serverThreads]() { server.Run(serverThreads); });
+    } else if (ParseUrl(url, options) == false) {
+        PrintUsage();
+        return 1;
+    }
+
+    {
+        Net::HttpClient probe;
+        const Net::Status status = probe.Connect(options.host.c_str(), options.port);
+        if (status != Net::Success) {
+            std::cerr << "Can't connect to " << url << ": " << Net::GetStatusName(status) << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "Running " << options.seconds << "s test @ " << url << '\n'
+              << "  " << options.connections << " connections";
+    if (options.rate > 0) {
+        std::cout << ", target " << options.rate << " requests/sec";
+    }
+    std::cout << std::endl;
+
+    const Clock::time_point begin = Clock::now();
+    const Clock::time_point end =
+        begin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.seconds));
+
+    std::vector<Net::HttpClient::Header> headers;
+    for (const std::string& header : options.headers) {
+        const size_t colon = header.find(':');
+        const size_t valueBegin = header.find_first_not_of(' ', colon + 1);
+        const std::string_view value =
+            (valueBegin == std::string::npos) ? std::string_view() : std::string_view(header).substr(valueBegin);
+        headers.push_back({std::string_view(header).substr(0, colon), value});
+    }
+
+    std::vector<ConnectionResult> results(options.connections);
+    std::vector<std::thread> threads;
+    for (uint i = 0; i < options.connections; ++i) {
+        threads.emplace_back(
+            RunConnection, std::cref(options), std::cref(headers), i, begin, end, std::ref(results[i])
+        );
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    ConnectionResult total;
+    total.lastFinish = begin;
+    for (const ConnectionResult& result : results) {
+        total.corrected.Merge(result.corrected);
+        total.service.Merge(result.service);
+        total.responses += result.responses;
+        total.bytes += result.bytes;
+        total.connectErrors += result.connectErrors;
+        total.requestErrors += result.requestErrors;
+        total.statusErrors += result.statusErrors;
+        total.lastFinish = std::max(total.lastFinish, result.lastFinish);
+    }
+
+    if (serverThread.joinable()) {
+        server.Stop();
+        serverThread.join();
+    }
+
+    const double elapsed = std::max(1e-6, std::chrono::duration<double>(total.lastFinish - begin).count());
+    PrintReport(options, total, elapsed);
+
+    return total.responses > 0 ? 0 : 1;
+}